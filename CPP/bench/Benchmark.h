@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace Benchmark {
+
+	/** Prevent the compiler from optimizing away the computation of value */
+	template<typename T>
+	inline void doNotOptimize(const T& value) {
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	struct Result {
+		double seconds;
+		size_t items;
+		size_t bytes;
+	};
+
+	/** Run fn() once and measure its wall time. fn returns the amount of processed items and bytes. */
+	template<typename TFn>
+	Result measure(TFn fn) {
+		auto start = std::chrono::steady_clock::now();
+		auto [items, bytes] = fn();
+		auto end = std::chrono::steady_clock::now();
+		return Result { std::chrono::duration<double>(end - start).count(), items, bytes };
+	}
+
+	inline void report(const std::string& name, const Result& result) {
+		std::printf("%-48s %10.3f ms %12.2f Mitems/s %10.2f MB/s\n", name.c_str(), result.seconds * 1000.0,
+				(result.items / result.seconds) / 1e6, (result.bytes / result.seconds) / (1024.0 * 1024.0));
+	}
+
+	inline void report(const std::string& name, const Result& result, const Result& baseline) {
+		report(name, result);
+		std::printf("%-48s %10.2fx\n", "  speedup vs. baseline", baseline.seconds / result.seconds);
+	}
+
+}
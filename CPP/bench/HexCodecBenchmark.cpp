@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sensorreadout/HexCodec.h>
+#include <sensorreadout/SensorReadoutParser.h>
+
+#include "Benchmark.h"
+
+using namespace SensorReadoutParser;
+
+// ###########
+// # Baseline (the previous sscanf / strtol / sprintf based implementation)
+// ######################
+namespace Legacy {
+
+	static MacAddress macFromString(const std::string_view& macStr) {
+		MacAddress res;
+		exceptAssert(
+				sscanf(macStr.data(), "%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx", &res[0], &res[1], &res[2], &res[3], &res[4], &res[5]) == 6,
+				"Parsing undelimited MAC-Address failed");
+		return res;
+	}
+
+	static std::string macToString(const MacAddress& mac) {
+		std::string macString;
+		macString.resize(MacAddress::STRING_LENGTH_SHORT);
+		for(size_t i = 0; i < MacAddress::MAC_LENGTH; ++i) {
+			sprintf(&macString[i * 2], "%02X", mac[i]);
+		}
+		return macString;
+	}
+
+	static std::vector<uint8_t> hexDecode(const std::string_view& str) {
+		std::vector<uint8_t> result;
+		for (size_t i = 0; i < str.length(); i += 2) {
+			std::string byteString = std::string(str.substr(i, 2));
+			char byte = std::strtol(byteString.c_str(), NULL, 16);
+			result.push_back(byte);
+		}
+		return result;
+	}
+
+}
+
+static std::vector<std::string> randomHexStrings(size_t cnt, size_t byteLen, std::mt19937& rng) {
+	std::vector<std::string> result;
+	std::vector<uint8_t> bytes(byteLen);
+	for(size_t i = 0; i < cnt; ++i) {
+		for(auto& b : bytes) { b = static_cast<uint8_t>(rng()); }
+		result.push_back(HexCodec::encode(bytes.data(), bytes.size(), (i % 2) == 0));
+	}
+	return result;
+}
+
+int main(int argc, char** argv) {
+	size_t iterations = (argc > 1) ? std::stoul(argv[1]) : 1000000;
+	std::mt19937 rng(1337);
+
+	{ // MacAddress parsing
+		auto macStrings = randomHexStrings(iterations, MacAddress::MAC_LENGTH, rng);
+		auto run = [&](auto parseFn) {
+			return Benchmark::measure([&]() {
+				for(const auto& macString : macStrings) { Benchmark::doNotOptimize(parseFn(macString)); }
+				return std::make_pair(macStrings.size(), macStrings.size() * MacAddress::STRING_LENGTH_SHORT);
+			});
+		};
+		auto baseline = run(&Legacy::macFromString);
+		Benchmark::report("MacAddress::fromString (sscanf)", baseline);
+		Benchmark::report("MacAddress::fromString (HexCodec)", run(&MacAddress::fromString), baseline);
+	}
+	{ // MacAddress formatting
+		std::vector<MacAddress> macs;
+		for(const auto& macString : randomHexStrings(iterations, MacAddress::MAC_LENGTH, rng)) { macs.push_back(MacAddress::fromString(macString)); }
+		auto run = [&](auto formatFn) {
+			return Benchmark::measure([&]() {
+				for(const auto& mac : macs) { Benchmark::doNotOptimize(formatFn(mac)); }
+				return std::make_pair(macs.size(), macs.size() * MacAddress::STRING_LENGTH_SHORT);
+			});
+		};
+		auto baseline = run(&Legacy::macToString);
+		Benchmark::report("MacAddress::toString (sprintf)", baseline);
+		Benchmark::report("MacAddress::toString (HexCodec)", run([](const MacAddress& mac) { return mac.toString(); }), baseline);
+	}
+	{ // BLE rawData payloads
+		auto payloads = randomHexStrings(iterations / 10, 62, rng);
+		auto run = [&](auto decodeFn) {
+			return Benchmark::measure([&]() {
+				size_t bytes = 0;
+				for(const auto& payload : payloads) { Benchmark::doNotOptimize(decodeFn(payload)); bytes += payload.size(); }
+				return std::make_pair(payloads.size(), bytes);
+			});
+		};
+		auto baseline = run(&Legacy::hexDecode);
+		Benchmark::report("HexString decode 62B (strtol)", baseline);
+		Benchmark::report("HexString decode 62B (HexCodec)", run([](const std::string& payload) { return HexCodec::decode(payload); }), baseline);
+	}
+	return 0;
+}
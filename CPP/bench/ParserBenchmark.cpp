@@ -0,0 +1,196 @@
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sensorreadout/SensorReadoutParser.h>
+#include <sensorreadout/MappedVisitingParser.h>
+#include <sensorreadout/FingerprintParser.h>
+#include <sensorreadout/FingerprintMatcher.h>
+#include <sensorreadout/GzipInputStream.h>
+#include <sensorreadout/TimeSeriesCodec.h>
+#include <sensorreadout/Pipeline.h>
+
+#ifdef SENSORREADOUT_WITH_ZLIB
+	#include <zlib.h>
+#endif
+
+#include "Benchmark.h"
+#include "RecordingGenerator.h"
+
+using namespace SensorReadoutParser;
+
+// Usage: ParserBenchmark [sizeMiB = 64] [mix = all|imu|radio]
+int main(int argc, char** argv) {
+	RecordingGeneratorOptions options;
+	options.targetBytes = ((argc > 1) ? std::stoul(argv[1]) : 64) * 1024 * 1024;
+	std::string mix = (argc > 2) ? argv[2] : "all";
+	if(mix == "imu") { options.eventRatesHz = RecordingGenerator::imuEventRates(); }
+	else if(mix == "radio") { options.eventRatesHz = RecordingGenerator::radioEventRates(); }
+	else { options.eventRatesHz = RecordingGenerator::allEventRates(); }
+
+	const std::string recording = RecordingGenerator(options).generate();
+	std::istringstream recordingInput(recording);
+	std::vector<RawSensorEvent> rawEvents = AggregatingParser(recordingInput).parseRaw();
+	std::printf("Generated recording: %.2f MiB, %zu events, mix: %s\n\n", recording.size() / (1024.0 * 1024.0), rawEvents.size(), mix.c_str());
+
+	{ // VisitingParser
+		std::istringstream input(recording);
+		Benchmark::report("VisitingParser::nextLine", Benchmark::measure([&]() {
+			VisitingParser parser(input);
+			RawSensorEvent rawEvent;
+			size_t eventCnt = 0;
+			while(parser.nextLine(rawEvent)) { ++eventCnt; }
+			return std::make_pair(eventCnt, recording.size());
+		}));
+	}
+	{ // MappedVisitingParser
+		Benchmark::report("MappedVisitingParser::nextLine", Benchmark::measure([&]() {
+			MappedVisitingParser parser = MappedVisitingParser::fromBuffer(recording);
+			RawSensorEventView rawEvent;
+			size_t eventCnt = 0;
+			while(parser.nextLine(rawEvent)) { ++eventCnt; }
+			return std::make_pair(eventCnt, recording.size());
+		}));
+	}
+#ifdef SENSORREADOUT_WITH_ZLIB
+	{ // VisitingParser on a gzip compressed recording
+		z_stream zStream = {};
+		deflateInit2(&zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+		std::string compressed(deflateBound(&zStream, recording.size()), '\0');
+		zStream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(recording.data()));
+		zStream.avail_in = recording.size();
+		zStream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+		zStream.avail_out = compressed.size();
+		deflate(&zStream, Z_FINISH);
+		compressed.resize(zStream.total_out);
+		deflateEnd(&zStream);
+
+		std::istringstream compressedInput(compressed);
+		Benchmark::report("VisitingParser::nextLine (gzip)", Benchmark::measure([&]() {
+			GzipInputStream input(compressedInput);
+			VisitingParser parser(input);
+			RawSensorEvent rawEvent;
+			size_t eventCnt = 0;
+			while(parser.nextLine(rawEvent)) { ++eventCnt; }
+			return std::make_pair(eventCnt, recording.size());
+		}));
+	}
+#endif
+	{ // AggregatingParser
+		std::istringstream input(recording);
+		Benchmark::report("AggregatingParser::parse", Benchmark::measure([&]() {
+			auto result = AggregatingParser(input).parse();
+			return std::make_pair(result.size(), recording.size());
+		}));
+		input.clear();
+		input.seekg(0);
+		Benchmark::report("AggregatingParser::parseParallel", Benchmark::measure([&]() {
+			auto result = AggregatingParser(input).parseParallel();
+			return std::make_pair(result.size(), recording.size());
+		}));
+	}
+	{ // ParsePipeline
+		std::istringstream input(recording);
+		Benchmark::report("ParsePipeline::run", Benchmark::measure([&]() {
+			input.clear();
+			input.seekg(0);
+			VisitingParser parser(input);
+			size_t timestampSum = 0;
+			size_t eventCnt = ParsePipeline(parser).run([&](const SensorEvent& evt) { timestampSum += evt.timestamp; });
+			Benchmark::doNotOptimize(timestampSum);
+			return std::make_pair(eventCnt, recording.size());
+		}));
+	}
+	{ // SensorEvent::parse per EventType
+		std::map<EventId, std::vector<RawSensorEvent>> eventsByType;
+		for(const auto& rawEvent : rawEvents) { eventsByType[rawEvent.eventId].push_back(rawEvent); }
+		std::printf("\n");
+		for(const auto& [eventId, events] : eventsByType) {
+			size_t bytes = 0;
+			for(const auto& rawEvent : events) { bytes += rawEvent.parameterString.size(); }
+			Benchmark::report("SensorEvent::parse [eventId " + std::to_string(eventId) + "]", Benchmark::measure([&]() {
+				for(const auto& rawEvent : events) { Benchmark::doNotOptimize(SensorEvent::parse(rawEvent)); }
+				return std::make_pair(events.size(), bytes);
+			}));
+		}
+		std::printf("\n");
+	}
+	{ // Serializer
+		std::vector<SensorEvent> events;
+		for(const auto& rawEvent : rawEvents) { events.push_back(SensorEvent::parse(rawEvent)); }
+		std::ostringstream output;
+		Benchmark::report("Serializer::write(SensorEvent)", Benchmark::measure([&]() {
+			Serializer serializer(output);
+			for(const auto& evt : events) { serializer.write(evt); }
+			serializer.flush();
+			return std::make_pair(events.size(), static_cast<size_t>(output.tellp()));
+		}));
+		output.str("");
+		Benchmark::report("Serializer::write(RawSensorEvent)", Benchmark::measure([&]() {
+			Serializer serializer(output);
+			for(const auto& rawEvent : rawEvents) { serializer.write(rawEvent); }
+			serializer.flush();
+			return std::make_pair(rawEvents.size(), static_cast<size_t>(output.tellp()));
+		}));
+	}
+	{ // TimeSeriesCodec, compared to columnar parsing of the text recording
+		MappedVisitingParser textParser = MappedVisitingParser::fromBuffer(recording);
+		ColumnarRecording columnar = ColumnarRecording::parse(textParser);
+		size_t numericCnt = 0;
+		columnar.forEachNumericChannel([&](EventType, const auto& channel) { numericCnt += channel.size(); });
+		std::stringstream compressed;
+		Benchmark::report("TimeSeriesWriter::write", Benchmark::measure([&]() {
+			compressed.str("");
+			TimeSeriesWriter(compressed).write(columnar);
+			return std::make_pair(numericCnt, static_cast<size_t>(compressed.tellp()));
+		}));
+		const size_t compressedSize = compressed.str().size();
+		Benchmark::report("TimeSeriesReader::readAll", Benchmark::measure([&]() {
+			compressed.clear();
+			compressed.seekg(0);
+			Benchmark::doNotOptimize(TimeSeriesReader(compressed).readAll());
+			return std::make_pair(numericCnt, compressedSize);
+		}));
+		Benchmark::report("ColumnarRecording::parse (text)", Benchmark::measure([&]() {
+			MappedVisitingParser parser = MappedVisitingParser::fromBuffer(recording);
+			return std::make_pair(ColumnarRecording::parse(parser).size(), recording.size());
+		}));
+		std::printf("Time series: %zu numeric samples in %.2f MiB\n\n", numericCnt, compressedSize / (1024.0 * 1024.0));
+	}
+	{ // FingerprintParser
+		RecordingGeneratorOptions fingerprintOptions = options;
+		fingerprintOptions.seed += 1;
+		const size_t eventsPerFingerprint = 2000;
+		const size_t fingerprintCnt = std::max<size_t>(1, rawEvents.size() / eventsPerFingerprint);
+		std::istringstream input(RecordingGenerator(fingerprintOptions).generateFingerprints(fingerprintCnt, eventsPerFingerprint));
+		const size_t inputSize = input.str().size();
+		Benchmark::report("FingerprintParser::parse", Benchmark::measure([&]() {
+			Fingerprints fingerprints = FingerprintParser(input).parse();
+			return std::make_pair(fingerprints.size() * eventsPerFingerprint, inputSize);
+		}));
+	}
+	{ // FingerprintMatcher, queries are Wifi scans against a database of Wifi fingerprints
+		RecordingGeneratorOptions matcherOptions = options;
+		matcherOptions.seed += 2;
+		matcherOptions.eventRatesHz = { {EventType::Wifi, 1} };
+		RecordingGenerator generator(matcherOptions);
+		std::istringstream input(generator.generateFingerprints(2000, 3));
+		const Fingerprints fingerprints = FingerprintParser(input).parse();
+		const FingerprintMatcher matcher(fingerprints);
+		std::vector<WifiEvent> queries;
+		for(size_t i = 0; i < 5000; ++i) { queries.push_back(std::get<WifiEvent>(generator.nextEvent().data)); }
+		std::printf("FingerprintMatcher: %zu fingerprints x %zu MACs\n", matcher.fingerprintCnt(), matcher.macCnt());
+
+		Benchmark::report("FingerprintMatcher::match (top 10)", Benchmark::measure([&]() {
+			for(const WifiEvent& query : queries) { Benchmark::doNotOptimize(matcher.match(query, 10).front()); }
+			return std::make_pair(queries.size(), size_t(0));
+		}));
+		Benchmark::report("FingerprintMatcher::matchAll (top 10)", Benchmark::measure([&]() {
+			return std::make_pair(matcher.matchAll(queries, 10).size(), size_t(0));
+		}));
+	}
+	return 0;
+}
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sensorreadout/SensorReadoutParser.h>
+#include <sensorreadout/FingerprintParser.h>
+
+using namespace SensorReadoutParser;
+
+// ###########
+// # RecordingGenerator
+// ######################
+
+struct RecordingGeneratorOptions {
+	/** Approximate size of the generated recording in bytes */
+	size_t targetBytes = 64 * 1024 * 1024;
+	uint32_t seed = 1337;
+	/** Rate of each EventType in Hz. A rate of 0 emits the type exactly once, at the start of the recording. */
+	std::map<EventType, double> eventRatesHz;
+	/** Range of the amount of access points per Wifi scan */
+	size_t wifiMinAps = 15;
+	size_t wifiMaxAps = 60;
+	/** Range of the length of raw BLE advertisements in bytes */
+	size_t bleMinPayload = 20;
+	size_t bleMaxPayload = 62;
+	/** Amount of distinct transmitters, from which the MACs of radio events are drawn */
+	size_t transmitterCnt = 400;
+};
+
+/**
+ * @brief Generator for synthetic, but realistic recordings.
+ * @details Every EventType is emitted at its configured rate with randomized parameters. Events are created
+ * as SensorEvents and serialized, such that the result is guaranteed to be parseable.
+ */
+class RecordingGenerator {
+private:
+	struct Schedule {
+		Timestamp nextTimestamp;
+		Timestamp interval;
+		EventType eventType;
+	};
+
+	RecordingGeneratorOptions options;
+	std::mt19937 rng;
+	std::vector<Schedule> schedules;
+	std::vector<MacAddress> transmitters;
+	size_t groundTruthCnt = 0;
+
+public:
+	/** Typical rates of a smartphone recording with additional radio and reference systems */
+	static std::map<EventType, double> allEventRates() {
+		return {
+			{EventType::Accelerometer, 200}, {EventType::Gravity, 100}, {EventType::LinearAcceleration, 100},
+			{EventType::Gyroscope, 200}, {EventType::MagneticField, 100}, {EventType::Pressure, 10},
+			{EventType::Orientation, 50}, {EventType::RotationMatrix, 50}, {EventType::Wifi, 0.5},
+			{EventType::BLE, 20}, {EventType::RelativeHumidity, 1}, {EventType::OrientationOld, 50},
+			{EventType::RotationVector, 50}, {EventType::Light, 5}, {EventType::AmbientTemperature, 1},
+			{EventType::HeartRate, 1}, {EventType::GPS, 1}, {EventType::WifiRTT, 5},
+			{EventType::GameRotationVector, 50}, {EventType::EddystoneUID, 2}, {EventType::DecawaveUWB, 10},
+			{EventType::StepDetector, 2}, {EventType::HeadingChange, 2}, {EventType::FutureShapeSensFloor, 5},
+			{EventType::MicrophoneMetadata, 0}, {EventType::StepProbability, 2}, {EventType::CIR5G, 1},
+			{EventType::PedestrianActivity, 0.05}, {EventType::GroundTruth, 0.1}, {EventType::GroundTruthPos, 0.1},
+			{EventType::PredictedPos, 1}, {EventType::GroundTruthPath, 0}, {EventType::FileMetadata, 0},
+			{EventType::RecordingId, 0}
+		};
+	}
+	static std::map<EventType, double> imuEventRates() {
+		return {
+			{EventType::Accelerometer, 200}, {EventType::Gyroscope, 200}, {EventType::MagneticField, 100},
+			{EventType::GameRotationVector, 50}, {EventType::Pressure, 10}
+		};
+	}
+	static std::map<EventType, double> radioEventRates() {
+		return {
+			{EventType::Wifi, 0.5}, {EventType::BLE, 20}, {EventType::WifiRTT, 5},
+			{EventType::EddystoneUID, 2}, {EventType::DecawaveUWB, 10}
+		};
+	}
+
+	RecordingGenerator(RecordingGeneratorOptions options) : options(options), rng(options.seed) {
+		if(this->options.eventRatesHz.empty()) { this->options.eventRatesHz = allEventRates(); }
+		for(const auto& [eventType, rateHz] : this->options.eventRatesHz) {
+			Timestamp interval = (rateHz > 0) ? static_cast<Timestamp>(1e9 / rateHz) : 0;
+			schedules.push_back(Schedule { 0, interval, eventType });
+		}
+		for(size_t i = 0; i < options.transmitterCnt; ++i) { transmitters.push_back(randomMac()); }
+	}
+
+	/** Create the next event in timestamp order */
+	SensorEvent nextEvent() {
+		auto schedule = std::min_element(schedules.begin(), schedules.end(),
+				[](const Schedule& a, const Schedule& b) { return a.nextTimestamp < b.nextTimestamp; });
+		SensorEvent result = createEvent(schedule->eventType, schedule->nextTimestamp);
+		if(schedule->interval == 0) {
+			schedules.erase(schedule);
+		} else {
+			schedule->nextTimestamp += schedule->interval;
+		}
+		return result;
+	}
+
+	/** Generate a textual recording of roughly options.targetBytes bytes */
+	std::string generate() {
+		std::ostringstream result;
+		{
+			Serializer serializer(result);
+			RawSensorEvent rawEvent;
+			size_t approxBytes = 0;
+			while(approxBytes < options.targetBytes && !schedules.empty()) {
+				nextEvent().serializeInto(rawEvent);
+				serializer.write(rawEvent);
+				approxBytes += rawEvent.parameterString.size() + 16;
+			}
+		}
+		return result.str();
+	}
+
+	/** Generate a fingerprint file of point fingerprints, each with eventsPerFingerprint events */
+	std::string generateFingerprints(size_t fingerprintCnt, size_t eventsPerFingerprint) {
+		Fingerprints fingerprints;
+		std::uniform_real_distribution<double> positionDist(0, 100);
+		for(size_t i = 0; i < fingerprintCnt; ++i) {
+			Fingerprint fp;
+			fp.fpType = FingerprintType::Point;
+			fp.name = "FP " + std::to_string(i);
+			fp.setParameters({
+				{"name", fp.name},
+				{"floorIdx", std::to_string(i % 4)},
+				{"floorName", "floor" + std::to_string(i % 4)}
+			});
+			fp.setPosition({positionDist(rng), positionDist(rng), 1.3});
+			for(size_t e = 0; e < eventsPerFingerprint; ++e) { fp.evts.push_back(nextEvent()); }
+			fingerprints.add(std::move(fp));
+		}
+		std::ostringstream result;
+		FingerprintSerializer(result).serialize(fingerprints);
+		return result.str();
+	}
+
+private:
+	float randomFloat(float min, float max) { return std::uniform_real_distribution<float>(min, max)(rng); }
+	template<typename T> T randomInt(T min, T max) { return std::uniform_int_distribution<T>(min, max)(rng); }
+	MacAddress randomMac() {
+		MacAddress mac;
+		for(size_t i = 0; i < MacAddress::MAC_LENGTH; ++i) { mac[i] = static_cast<uint8_t>(rng()); }
+		return mac;
+	}
+	const MacAddress& randomTransmitter() { return transmitters[randomInt<size_t>(0, transmitters.size() - 1)]; }
+
+	template<typename TEvent>
+	TEvent randomNumericEvent() {
+		TEvent evt;
+		using NumericValue = typename TEvent::NumericValue;
+		NumericValue* values = &evt.template getValue<0>();
+		for(size_t i = 0; i < TEvent::VALUE_CNT; ++i) {
+			if constexpr(std::is_floating_point_v<NumericValue>) {
+				values[i] = static_cast<NumericValue>(randomFloat(-10, 10));
+			} else {
+				values[i] = randomInt<NumericValue>(0, 1000);
+			}
+		}
+		return evt;
+	}
+
+	SensorEvent createEvent(EventType eventType, Timestamp timestamp) {
+		#define RECORDING_GENERATOR_NUMERIC_CASE(EvtType, EvtStruct) \
+			case EvtType: result.data = randomNumericEvent<EvtStruct>(); break;
+
+		SensorEvent result;
+		result.timestamp = timestamp;
+		result.eventType = eventType;
+		switch(eventType) {
+			SENSORREADOUT_NUMERIC_EVENTS(RECORDING_GENERATOR_NUMERIC_CASE)
+			case EventType::Wifi: {
+				WifiEvent evt;
+				size_t apCnt = randomInt<size_t>(options.wifiMinAps, options.wifiMaxAps);
+				for(size_t i = 0; i < apCnt; ++i) {
+					WifiFrequency channelFreq = (i % 3 == 0) ? (2412 + 5 * randomInt<WifiFrequency>(0, 12)) : (5180 + 20 * randomInt<WifiFrequency>(0, 32));
+					evt.advertisements.push_back(WifiAdvertisement { randomTransmitter(), randomInt<Rssi>(-95, -30), channelFreq });
+				}
+				result.data = evt;
+				break;
+			}
+			case EventType::BLE: {
+				BLEEvent evt;
+				evt.mac = randomTransmitter();
+				evt.rssi = randomInt<Rssi>(-100, -40);
+				evt.txPower = (rng() % 2 == 0) ? std::numeric_limits<BluetoothTxPower>::min() : randomInt<BluetoothTxPower>(-20, 4);
+				evt.rawData.resize(randomInt<size_t>(options.bleMinPayload, options.bleMaxPayload));
+				for(auto& byte : evt.rawData) { byte = static_cast<uint8_t>(rng()); }
+				result.data = evt;
+				break;
+			}
+			case EventType::WifiRTT: {
+				WifiRTTEvent evt;
+				evt.success = (rng() % 10 != 0);
+				evt.mac = randomTransmitter();
+				evt.distanceMM = randomInt<int64_t>(0, 50000);
+				evt.distanceStdDevMM = randomInt<int64_t>(0, 2000);
+				evt.rssi = randomInt<Rssi>(-90, -40);
+				evt.numAttempted = 8;
+				evt.numSuccessfull = randomInt<size_t>(0, 8);
+				result.data = evt;
+				break;
+			}
+			case EventType::EddystoneUID: {
+				EddystoneUIDEvent evt;
+				evt.mac = randomTransmitter();
+				evt.rssi = randomInt<Rssi>(-100, -40);
+				evt.txPower = randomInt<BluetoothTxPower>(-20, 4);
+				for(auto& byte : evt.uid.data) { byte = static_cast<uint8_t>(rng()); }
+				result.data = evt;
+				break;
+			}
+			case EventType::DecawaveUWB: {
+				DecawaveUWBEvent evt;
+				evt.x = randomInt<int>(0, 50000) / 1000.0f;
+				evt.y = randomInt<int>(0, 50000) / 1000.0f;
+				evt.z = randomInt<int>(0, 3000) / 1000.0f;
+				evt.qualityFactor = randomInt<uint16_t>(0, 100);
+				for(uint16_t anchor = 0; anchor < 4; ++anchor) {
+					evt.anchorMeasurements.push_back(DecawaveUWBMeasurement {
+						static_cast<uint16_t>(1000 + anchor), randomInt<int>(0, 50000) / 1000.0f, static_cast<uint8_t>(randomInt<uint16_t>(0, 100)) });
+				}
+				result.data = evt;
+				break;
+			}
+			case EventType::StepDetector: result.data = StepDetectorEvent { timestamp, timestamp + 500000000, randomFloat(0, 1) }; break;
+			case EventType::FutureShapeSensFloor: {
+				FutureShapeSensFloorEvent evt;
+				evt.roomId = randomInt<uint16_t>(0, 2000);
+				evt.x = static_cast<uint8_t>(rng());
+				evt.y = static_cast<uint8_t>(rng());
+				for(auto& capacity : evt.fieldCapacities) { capacity = static_cast<uint8_t>(rng()); }
+				result.data = evt;
+				break;
+			}
+			case EventType::MicrophoneMetadata: result.data = MicrophoneMetadataEvent { 2, 48000, "PCM_16BIT" }; break;
+			case EventType::StepProbability: result.data = StepProbabilityEvent { timestamp, groundTruthCnt, randomFloat(0, 1) }; break;
+			case EventType::CIR5G: {
+				CIR5GEvent evt;
+				evt.baseStationId = "gNB" + std::to_string(randomInt<int>(0, 16));
+				for(size_t i = 0; i < 64; ++i) {
+					evt.real.push_back(randomFloat(-1, 1));
+					evt.imag.push_back(randomFloat(-1, 1));
+				}
+				result.data = evt;
+				break;
+			}
+			case EventType::PedestrianActivity:
+				result.data = PedestrianActivityEvent::from(static_cast<PedestrianActivity>(randomInt<PedestrianActivityId>(0, 6)));
+				break;
+			case EventType::GroundTruthPos:
+			case EventType::PredictedPos:
+				result.data = PosEvent { randomFloat(0, 100), randomFloat(0, 100), 1.3f, randomInt<size_t>(0, 3) };
+				break;
+			case EventType::GroundTruthPath: result.data = GroundTruthPathEvent { "path_1", 32 }; break;
+			case EventType::FileMetadata: result.data = FileMetadataEvent { "2023-05-09T14:59:46.382Z", "Synthetic", "RecordingGenerator" }; break;
+			case EventType::RecordingId: {
+				RecordingIdEvent evt;
+				for(auto& byte : evt.recordingId.data) { byte = static_cast<uint8_t>(rng()); }
+				result.data = evt;
+				break;
+			}
+		}
+		if(eventType == EventType::GroundTruth) {
+			std::get<GroundTruthEvent>(result.data).groundTruthId = groundTruthCnt++;
+		}
+		return result;
+	}
+};
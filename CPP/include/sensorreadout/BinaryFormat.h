@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstring>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "SensorReadoutParser.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # Binary Format
+	// ######################
+	//
+	// A binary recording starts with a FILE_HEADER_SIZE byte header:
+	//   char[4] magic ("SRBF") | uint16 formatVersion | uint16 byteOrderMark (0x0102)
+	// followed by one record per event:
+	//   uint64 timestamp (nanoseconds) | int32 eventId | uint32 payloadSize | payload
+	// For the types listed in SENSORREADOUT_NUMERIC_EVENTS, the payload is the fixed-size array of
+	// their VALUE_CNT values. The types listed in SENSORREADOUT_VARIABLE_EVENTS store their fields packed
+	// in declaration order, where MacAddresses take 6 bytes, size_t fields are widened to uint64 and
+	// variable-length fields (vectors, strings) are prefixed with their uint32 element count. A Wifi payload is:
+	//   uint32 advertisementCnt | advertisementCnt * (uint8[6] mac | int32 rssi | uint32 channelFreq)
+	// Events of unknown types keep their textual parameterString as payload.
+	// All values are stored in the byte order of the writing machine, which is verified when reading.
+
+	/**
+	 * @brief Non-owning view on a single record of a binary recording.
+	 * @details The payload points into the reader's buffer and is only valid until the next call to the reader.
+	 */
+	struct BinaryRecordView {
+		Timestamp timestamp = 0;
+		EventId eventId = 0;
+		std::string_view payload;
+	};
+
+	namespace _internal {
+		constexpr std::string_view BINARY_MAGIC = "SRBF";
+		constexpr uint16_t BINARY_FORMAT_VERSION = 2;
+		constexpr uint16_t BINARY_BYTE_ORDER_MARK = 0x0102;
+		constexpr size_t BINARY_FILE_HEADER_SIZE = 8;
+		constexpr size_t BINARY_RECORD_HEADER_SIZE = sizeof(Timestamp) + sizeof(EventId) + sizeof(uint32_t);
+
+		/** Decode the fixed-layout payload of a NumericSensorEventBase-derived event */
+		template<typename TEvent>
+		TEvent decodeNumericPayload(const std::string_view& payload) {
+			constexpr size_t PAYLOAD_SIZE = TEvent::VALUE_CNT * sizeof(typename TEvent::NumericValue);
+			exceptAssert(payload.size() == PAYLOAD_SIZE, "Invalid payload size for numeric event");
+			TEvent evt;
+			std::memcpy(&evt.template getValue<0>(), payload.data(), PAYLOAD_SIZE);
+			return evt;
+		}
+
+		/** Decode the payload of a record into the matching event type, without going through the text parser */
+		void decodeBinaryPayload(const BinaryRecordView& record, SensorEvent& sensorEvent);
+	}
+
+
+	// ###########
+	// # BinaryReader
+	// ######################
+
+	/**
+	 * @brief Reader for binary recordings, the binary counterpart of the VisitingParser.
+	 * @details The stream is read in blocks of READ_BLOCK_SIZE bytes. Numeric events are decoded with a
+	 * single memcpy, all other events field by field from their packed payload. Throws std::runtime_error on invalid headers and truncated records.
+	 */
+	class BinaryReader {
+
+	public: // Associated Types & Constants
+		static constexpr size_t READ_BLOCK_SIZE = 1024 * 1024;
+
+	private: // Reader state
+		std::istream& stream;
+		std::string buffer;
+		size_t ptr = 0;
+		size_t bufferEnd = 0;
+		std::optional<EventTypeFilter> eventFilter;
+		_internal::ParameterAssembler parameterAssembler;
+		SensorEvent decodedEvent;
+
+		bool ensureAvailable(size_t byteCnt);
+		bool nextAnyRecord(BinaryRecordView& record);
+
+	public: // API-Surface
+		/** Construct a reader on the given stream and validate its file header */
+		BinaryReader(std::istream& stream);
+
+		/** Only return events whose type is accepted by the given filter. Rejected records are skipped without decoding. */
+		void setEventFilter(std::optional<EventTypeFilter> eventFilter) { this->eventFilter = eventFilter; }
+		const std::optional<EventTypeFilter>& getEventFilter() const { return eventFilter; }
+
+		/** Zero-copy access to the next record. The view is only valid until the next call to this reader. */
+		bool nextRecord(BinaryRecordView& record);
+		/** Read the next event with its parameters formatted as text, as the VisitingParser would have returned it */
+		bool nextLine(RawSensorEvent& sensorEvent);
+		/** Read and decode the next event */
+		bool nextEvent(SensorEvent& sensorEvent);
+	};
+
+
+	// ###########
+	// # BinaryWriter
+	// ######################
+
+	/**
+	 * @brief Writer for binary recordings, the binary counterpart of the Serializer.
+	 * @details Output is collected in an internal buffer and written to the stream in large blocks.
+	 * The file header is written on construction. Like for the Serializer, call flush() explicitly before
+	 * destruction to get I/O errors reported, the destructor ignores them.
+	 */
+	class BinaryWriter {
+
+	public: // Associated Types & Constants
+		/** Size of the internal buffer at which it is written to the stream */
+		static constexpr size_t FLUSH_THRESHOLD = 1024 * 1024;
+
+	private: // Writer state
+		std::ostream& stream;
+		std::string buffer;
+		std::string payloadBuffer;
+
+		void writeRecord(Timestamp timestamp, EventId eventId, const void* payload, size_t payloadSize);
+		void writeBuffer();
+
+	public:
+		BinaryWriter(std::ostream& stream);
+		~BinaryWriter();
+
+		/** Write the given raw event. Its parameters are parsed once and stored in their binary representation. */
+		void write(const RawSensorEventView& sensorEvent);
+		void write(const SensorEvent& sensorEvent);
+
+		void flush();
+	};
+
+
+	// ###########
+	// # Conversion
+	// ######################
+
+	/** Convert all (remaining) events of the given text recording to the binary format. Returns the amount of converted events. */
+	size_t convertToBinary(VisitingParser& parser, BinaryWriter& writer);
+	/** Convert all (remaining) events of the given binary recording to the text format. Returns the amount of converted events. */
+	size_t convertToText(BinaryReader& reader, Serializer& serializer);
+
+}
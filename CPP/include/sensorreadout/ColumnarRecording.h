@@ -0,0 +1,217 @@
+#pragma once
+
+#include <tuple>
+#include <vector>
+
+#include "SensorReadoutParser.h"
+#include "MappedVisitingParser.h"
+#include "BinaryFormat.h"
+#include "MacDictionary.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # Columnar Stores
+	// ######################
+
+	/**
+	 * @brief Struct-of-arrays storage for all events of one NumericSensorEventBase-derived type.
+	 * @details The VALUE_CNT values of each sample are stored interleaved in one contiguous array,
+	 * such that the values of sample i start at values[i * VALUE_CNT].
+	 */
+	template<typename TEvent>
+	struct NumericChannel {
+		using Event = TEvent;
+		using NumericValue = typename TEvent::NumericValue;
+		static constexpr size_t VALUE_CNT = TEvent::VALUE_CNT;
+
+		std::vector<Timestamp> timestamps;
+		std::vector<NumericValue> values;
+
+		size_t size() const { return timestamps.size(); }
+		bool empty() const { return timestamps.empty(); }
+
+		const NumericValue* sample(size_t idx) const { return &values[idx * VALUE_CNT]; }
+		NumericValue value(size_t idx, size_t component) const { return values[idx * VALUE_CNT + component]; }
+
+		TEvent at(size_t idx) const {
+			TEvent evt;
+			std::copy_n(sample(idx), VALUE_CNT, &evt.template getValue<0>());
+			return evt;
+		}
+
+		void push(Timestamp timestamp, const TEvent& evt) {
+			const NumericValue* evtValues = &evt.template getValue<0>();
+			values.insert(values.end(), evtValues, evtValues + VALUE_CNT);
+			timestamps.push_back(timestamp);
+		}
+
+		/** Decode the parameterString directly into the value array */
+		void parse(Timestamp timestamp, const std::string_view& parameterString) {
+			size_t prevSize = values.size();
+			values.resize(prevSize + VALUE_CNT);
+			try {
+				TEvent::parseInto(parameterString, &values[prevSize]);
+			} catch (...) {
+				values.resize(prevSize);
+				throw;
+			}
+			timestamps.push_back(timestamp);
+		}
+
+		/** Copy the fixed-layout payload of a binary record directly into the value array */
+		void pushBinary(Timestamp timestamp, const std::string_view& payload) {
+			exceptAssert(payload.size() == VALUE_CNT * sizeof(NumericValue), "Invalid payload size for numeric event");
+			size_t prevSize = values.size();
+			values.resize(prevSize + VALUE_CNT);
+			std::memcpy(&values[prevSize], payload.data(), payload.size());
+			timestamps.push_back(timestamp);
+		}
+
+		void clear() { timestamps.clear(); values.clear(); }
+	};
+
+	/**
+	 * @brief Columnar storage for WifiEvents.
+	 * @details The advertisements of all scans are stored in one flat array. The advertisements
+	 * of scan i are in [advertisementOffsets[i], advertisementOffsets[i + 1]).
+	 */
+	struct WifiEventStore {
+		std::vector<Timestamp> timestamps;
+		std::vector<size_t> advertisementOffsets = {0};
+		std::vector<WifiAdvertisement> advertisements;
+
+		size_t size() const { return timestamps.size(); }
+		bool empty() const { return timestamps.empty(); }
+		size_t advertisementCnt(size_t idx) const { return advertisementOffsets[idx + 1] - advertisementOffsets[idx]; }
+		const WifiAdvertisement* advertisementsOf(size_t idx) const { return advertisements.data() + advertisementOffsets[idx]; }
+
+		WifiEvent at(size_t idx) const;
+		void push(Timestamp timestamp, const WifiEvent& evt);
+		void parse(Timestamp timestamp, const std::string_view& parameterString);
+		void clear();
+	};
+
+	/**
+	 * @brief Columnar storage for BLEEvents.
+	 * @details The raw advertisement data of event i is stored in rawData[rawDataOffsets[i], rawDataOffsets[i + 1]).
+	 */
+	struct BLEEventStore {
+		std::vector<Timestamp> timestamps;
+		std::vector<MacAddress> macs;
+		/** See BLEEvent::macId */
+		std::vector<MacId> macIds;
+		std::vector<Rssi> rssis;
+		std::vector<BluetoothTxPower> txPowers;
+		std::vector<size_t> rawDataOffsets = {0};
+		std::vector<uint8_t> rawData;
+
+		size_t size() const { return timestamps.size(); }
+		bool empty() const { return timestamps.empty(); }
+
+		BLEEvent at(size_t idx) const;
+		void push(Timestamp timestamp, const BLEEvent& evt);
+		void parse(Timestamp timestamp, const std::string_view& parameterString);
+		void clear();
+	};
+
+	/**
+	 * @brief Columnar storage for DecawaveUWBEvents.
+	 * @details The anchor measurements of event i are stored in anchorMeasurements[measurementOffsets[i], measurementOffsets[i + 1]).
+	 */
+	struct DecawaveUWBEventStore {
+		std::vector<Timestamp> timestamps;
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<uint8_t> qualityFactors;
+		std::vector<size_t> measurementOffsets = {0};
+		std::vector<DecawaveUWBMeasurement> anchorMeasurements;
+
+		size_t size() const { return timestamps.size(); }
+		bool empty() const { return timestamps.empty(); }
+
+		DecawaveUWBEvent at(size_t idx) const;
+		void push(Timestamp timestamp, const DecawaveUWBEvent& evt);
+		void parse(Timestamp timestamp, const std::string_view& parameterString);
+		void clear();
+	};
+
+
+	// ###########
+	// # ColumnarRecording
+	// ######################
+
+	/**
+	 * @brief Recording container that stores events by type in contiguous arrays.
+	 * @details Every NumericSensorEventBase-derived type has its own NumericChannel, Wifi, BLE and DecawaveUWB
+	 * events have their own flattened stores. All remaining event types are kept as SensorEvents in others().
+	 * The order of events within each store is the order in which they were added.
+	 * With a MacDictionary, the macIds of the Wifi advertisements and BLE events are assigned while they are added.
+	 */
+	class ColumnarRecording {
+	public: // Associated types
+		#define SENSORREADOUT_NUMERIC_CHANNEL_TYPE(EvtType, EvtStruct) std::tuple<NumericChannel<EvtStruct>>(),
+		using NumericChannels = decltype(std::tuple_cat(SENSORREADOUT_NUMERIC_EVENTS(SENSORREADOUT_NUMERIC_CHANNEL_TYPE) std::tuple<>()));
+		#undef SENSORREADOUT_NUMERIC_CHANNEL_TYPE
+
+	private:
+		NumericChannels numericChannels;
+		WifiEventStore wifiStore;
+		BLEEventStore bleStore;
+		DecawaveUWBEventStore decawaveUWBStore;
+		std::vector<SensorEvent> otherEvents;
+		MacDictionary* macDictionary = nullptr;
+
+	public:
+		/**
+		 * @brief Intern the MACs of all Wifi and BLE events added from now on into the given dictionary, and set their macId.
+		 * @details The dictionary has to outlive all further add() calls. Pass nullptr to disable.
+		 */
+		void setMacDictionary(MacDictionary* macDictionary) { this->macDictionary = macDictionary; }
+
+		/** Decode the given raw event directly into the store of its type */
+		void add(const RawSensorEventView& rawEvent);
+		void add(const SensorEvent& evt);
+
+		/**
+		 * @brief Parse all (remaining) events of the given parser into a new ColumnarRecording.
+		 * @details If a macDictionary is given, the macIds are assigned while parsing (see setMacDictionary()).
+		 * The returned recording does not keep the dictionary.
+		 */
+		static ColumnarRecording parse(VisitingParser& parser, MacDictionary* macDictionary = nullptr);
+		static ColumnarRecording parse(MappedVisitingParser& parser, MacDictionary* macDictionary = nullptr);
+		/** Read all (remaining) events of the given binary recording. Numeric events are copied without decoding. */
+		static ColumnarRecording parse(BinaryReader& reader, MacDictionary* macDictionary = nullptr);
+
+		template<typename TEvent> NumericChannel<TEvent>& channel() { return std::get<NumericChannel<TEvent>>(numericChannels); }
+		template<typename TEvent> const NumericChannel<TEvent>& channel() const { return std::get<NumericChannel<TEvent>>(numericChannels); }
+
+		/** Call fn(EventType, channel) for every numeric channel */
+		template<typename TFn> void forEachNumericChannel(TFn fn) const {
+			#define SENSORREADOUT_NUMERIC_CHANNEL_VISIT(EvtType, EvtStruct) fn(EvtType, channel<EvtStruct>());
+			SENSORREADOUT_NUMERIC_EVENTS(SENSORREADOUT_NUMERIC_CHANNEL_VISIT)
+			#undef SENSORREADOUT_NUMERIC_CHANNEL_VISIT
+		}
+
+		WifiEventStore& wifi() { return wifiStore; }
+		const WifiEventStore& wifi() const { return wifiStore; }
+		BLEEventStore& ble() { return bleStore; }
+		const BLEEventStore& ble() const { return bleStore; }
+		DecawaveUWBEventStore& decawaveUWB() { return decawaveUWBStore; }
+		const DecawaveUWBEventStore& decawaveUWB() const { return decawaveUWBStore; }
+		std::vector<SensorEvent>& others() { return otherEvents; }
+		const std::vector<SensorEvent>& others() const { return otherEvents; }
+
+		/** Total amount of events in all stores */
+		size_t size() const;
+		void clear();
+
+	private:
+		/** Assign the macIds of the Wifi advertisements from firstAdvertisementIdx onwards */
+		void assignWifiMacIds(size_t firstAdvertisementIdx);
+		/** Assign the macId of the last BLE event */
+		void assignBLEMacId();
+	};
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "SensorReadoutParser.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # ExternalSort
+	// ######################
+
+	struct ExternalSortOptions {
+		/** Approximate amount of memory used for buffering events during the run phase */
+		size_t memoryBudget = 256 * 1024 * 1024;
+		/** Amount of threads sorting and writing runs (0 = use hardware concurrency) */
+		size_t threadCnt = 0;
+		/** Directory for the temporary run files (empty = std::filesystem::temp_directory_path()) */
+		std::filesystem::path tempDirectory;
+		/** Maximum amount of runs merged at once, bounds the amount of simultaneously open files per merging thread */
+		size_t maxMergeFanIn = 64;
+	};
+
+	/**
+	 * @brief Sort all (remaining) events of the parser stably by timestamp, and write them to the serializer.
+	 * @details Events are read into runs of memoryBudget / (threadCnt + 1) bytes, such that one run can be filled
+	 * while a pool of threadCnt workers sorts and writes runs to temporary files. The sorted runs are then merged
+	 * with a k-way merge. If there are more than maxMergeFanIn runs, groups of maxMergeFanIn runs are first merged
+	 * into intermediate runs (in parallel), until a single pass can merge the rest into the serializer.
+	 * Events with equal timestamps keep their original order. If the whole input fits into a
+	 * single run, it is sorted in memory without temporary files. Temporary files are removed in any case.
+	 * Returns the amount of written events.
+	 */
+	size_t sortRecording(VisitingParser& parser, Serializer& serializer, const ExternalSortOptions& options = {});
+
+}
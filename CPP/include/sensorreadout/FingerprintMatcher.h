@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "SensorReadoutParser.h"
+#include "FingerprintParser.h"
+#include "MacDictionary.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # FingerprintMatcher
+	// ######################
+
+	/** One received signal strength of a query scan */
+	struct RssiMeasurement {
+		MacAddress mac;
+		Rssi rssi;
+	};
+
+	/** One fingerprint returned by FingerprintMatcher, see FingerprintMatcher::match() */
+	struct FingerprintMatch {
+		/** Index of the fingerprint in the Fingerprints container the matcher was built from */
+		size_t fpIdx;
+		/** Distance between the query and the fingerprint's RSSI vector, in dB */
+		float distance;
+	};
+
+	enum class RssiDistanceMetric {
+		/** sqrt(sum((fp - query)^2)) */
+		Euclidean,
+		/** sum(|fp - query|) */
+		Manhattan
+	};
+
+	struct FingerprintMatcherOptions {
+		/** Event types that contribute RSSI values (supported: Wifi, BLE, WifiRTT, EddystoneUID) */
+		EventTypeFilter sources = {EventType::Wifi, EventType::BLE};
+		/** RSSI assumed for MACs that were not seen (by the fingerprint, or by the query). Measured values are clamped to it. */
+		float missingRssi = -100;
+		RssiDistanceMetric metric = RssiDistanceMetric::Euclidean;
+	};
+
+	/**
+	 * @brief Radio fingerprint localization: find the fingerprints whose RSSI vectors are closest to a query scan.
+	 * @details Construction collects the mean RSSI of every MAC in every fingerprint into a dense MAC x fingerprint
+	 * matrix (one row per MAC, padded to a multiple of the SIMD width). Fingerprints without any RSSI values of the
+	 * configured sources are not part of the matrix.
+	 * Every MAC that is not part of the query contributes the same distance as if the query had measured missingRssi
+	 * there. The distance of a query that measured nothing is therefore precomputed once per fingerprint, and a query
+	 * only has to correct the rows of the MACs it contains (one fused pass over the row per MAC). This makes the cost
+	 * of a query O(queryMacs * fingerprints), independent of the amount of MACs in the database.
+	 * The matcher is a snapshot: it does not change when fingerprints are added to the Fingerprints afterwards.
+	 */
+	class FingerprintMatcher {
+	private:
+		FingerprintMatcherOptions options;
+		/** MacId = matrix row */
+		MacDictionary macRows;
+		/** matrix column -> index of the fingerprint in the Fingerprints container */
+		std::vector<size_t> columnFpIdcs;
+		/** Amount of floats per matrix row (column count rounded up to the SIMD width) */
+		size_t stride = 0;
+		/** macRows.size() x stride matrix of mean RSSIs, missingRssi where a fingerprint did not see a MAC */
+		std::vector<float> matrix;
+		/** Per column: distance to a query that only consists of missingRssi */
+		std::vector<float> missingDistance;
+
+	public:
+		/** Build the matrix from all fingerprints. Events that were not decoded yet (see FingerprintParser::index()) are decoded temporarily. */
+		FingerprintMatcher(const Fingerprints& fingerprints, const FingerprintMatcherOptions& options = {});
+
+		/** The (up to) k fingerprints closest to the query scan, sorted by ascending distance */
+		std::vector<FingerprintMatch> match(std::span<const RssiMeasurement> query, size_t k) const;
+		std::vector<FingerprintMatch> match(const WifiEvent& query, size_t k) const;
+		/** Match many queries, in parallel on threadCnt (0 = hardware concurrency) threads */
+		std::vector<std::vector<FingerprintMatch>> matchAll(std::span<const WifiEvent> queries, size_t k, size_t threadCnt = 0) const;
+
+		/** Amount of distinct MACs in the matrix */
+		size_t macCnt() const { return macRows.size(); }
+		/** Amount of fingerprints in the matrix */
+		size_t fingerprintCnt() const { return columnFpIdcs.size(); }
+		const FingerprintMatcherOptions& getOptions() const { return options; }
+
+	private:
+		/** Compute the distance of the query to every column into distances (size stride) */
+		void computeDistances(std::span<const RssiMeasurement> query, std::vector<float>& distances) const;
+	};
+
+} // namespace SensorReadoutParser
@@ -2,10 +2,14 @@
 
 #include <fstream>
 #include <map>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <unordered_set>
 
 #include "SensorReadoutParser.h"
+#include "FingerprintSpatialIndex.h"
 
 namespace SensorReadoutParser {
 
@@ -54,60 +58,151 @@ namespace SensorReadoutParser {
 		}
 	};
 
+	/**
+	 * @brief Event lines of a Fingerprint that were not decoded yet.
+	 * @details The lines point into the file buffer, which is shared by all fingerprints of one FingerprintParser::index() call.
+	 */
+	struct PendingFingerprintEvents {
+		std::shared_ptr<const std::string> buffer;
+		std::string_view lines;
+		FileVersion fileVersion;
+		std::optional<EventTypeFilter> typeFilter;
+
+		/** Decode all lines accepted by the typeFilter, and append them to evts */
+		void decodeInto(std::vector<SensorEvent>& evts) const;
+	};
+
+	/**
+	 * @brief One fingerprint of a fingerprint database.
+	 * @details The parameters are only modified through setters, which also decode the well-known parameters (position,
+	 * floor and point arrays) into typed members. The typed getters thus never parse strings, and always agree with
+	 * getParameters().
+	 */
 	struct Fingerprint {
 		FingerprintType fpType;
 		std::string name;
-		FingerprintParameters parameters;
 		std::vector<SensorEvent> evts;
+		/** Set while evts were not decoded yet (see FingerprintParser::index()) */
+		std::optional<PendingFingerprintEvents> pendingEvts;
+
+		bool hasPendingEvents() const { return pendingEvts.has_value(); }
+		/** Decode the pending events into evts. Does nothing if they were already decoded. */
+		void loadEvents() {
+			if(!pendingEvts) { return; }
+			pendingEvts->decodeInto(evts);
+			pendingEvts.reset();
+		}
 
-		// #### GETTERS ####
+		// #### PARAMETERS ####
 
-		// point
-		std::array<double, 3> getPosition() const {
-			return ParameterParseHelper::parseVec3(parameters.at("position"));
+		const FingerprintParameters& getParameters() const { return parameters; }
+		void setParameters(FingerprintParameters parameters) {
+			this->parameters = std::move(parameters);
+			decodeParameters();
+		}
+		void setParameter(const std::string& key, std::string value) {
+			parameters[key] = std::move(value);
+			decodeParameters();
 		}
-		size_t getFloorIdx() const { return std::stoul(parameters.at("floorIdx")); }
-		std::string getFloorName() const { return parameters.at("floorName"); }
-
 
-		// path
-		std::vector<std::string> getPointNames() const {
-			return ParameterParseHelper::parseArray<std::string>(parameters, "points", [](const auto& str) { return str; });
+	private:
+		/** Decode the well-known parameters into their typed members */
+		void decodeParameters() {
+			auto decodeOptional = [&](const char* key, auto& target, auto parseFn) {
+				auto it = parameters.find(key);
+				if(it != parameters.end()) { target = parseFn(it->second); } else { target.reset(); }
+			};
+			auto decodeArray = [&](const char* arrayName, auto& target, auto parseFn) {
+				using TItem = typename std::remove_reference_t<decltype(target)>::value_type;
+				if(parameters.contains(std::string(arrayName) + "[]")) {
+					target = ParameterParseHelper::parseArray<TItem>(parameters, arrayName, parseFn);
+				} else {
+					target.clear();
+				}
+			};
+			auto identity = [](const std::string& str) { return str; };
+			auto parseIdx = [](const std::string& str) { return static_cast<size_t>(std::stoull(str)); };
+			decodeOptional("position", position, &ParameterParseHelper::parseVec3);
+			decodeOptional("floorIdx", floorIdx, parseIdx);
+			decodeOptional("floorName", floorName, identity);
+			decodeArray("points", pointNames, identity);
+			decodeArray("positions", positions, &ParameterParseHelper::parseVec3);
+			decodeArray("floorIdxs", floorIdcs, parseIdx);
+			decodeArray("floorNames", floorNames, identity);
 		}
-		std::vector<std::array<double, 3>> getPositions() const {
-			return ParameterParseHelper::parseArray<std::array<double, 3>>(parameters, "positions", &ParameterParseHelper::parseVec3);
+
+	public:
+		// #### GETTERS ####
+
+		// point
+		bool hasPosition() const { return position.has_value(); }
+		bool hasFloorIdx() const { return floorIdx.has_value(); }
+		const std::array<double, 3>& getPosition() const {
+			exceptAssert(position.has_value(), "Fingerprint has no position");
+			return *position;
 		}
-		std::vector<size_t> getFloorIdcs() const {
-			return ParameterParseHelper::parseArray<size_t>(parameters, "floorIdxs", [](const auto& str) { return std::stoull(str); });
+		size_t getFloorIdx() const {
+			exceptAssert(floorIdx.has_value(), "Fingerprint has no floorIdx");
+			return *floorIdx;
 		}
-		std::vector<std::string> getFloorNames() const {
-			return ParameterParseHelper::parseArray<std::string>(parameters, "floorNames", [](const auto& str) { return str; });
+		const std::string& getFloorName() const {
+			exceptAssert(floorName.has_value(), "Fingerprint has no floorName");
+			return *floorName;
 		}
 
 
+		// path (empty if the fingerprint has no such array)
+		std::span<const std::string> getPointNames() const { return pointNames; }
+		std::span<const std::array<double, 3>> getPositions() const { return positions; }
+		std::span<const size_t> getFloorIdcs() const { return floorIdcs; }
+		std::span<const std::string> getFloorNames() const { return floorNames; }
+
+
 		// #### SETTERS ####
 
 		// point
-		void setPosition(const std::array<double, 3>& pos) { parameters["position"] = ParameterSerializeHelper::serializeVec3(pos); }
+		void setPosition(const std::array<double, 3>& pos) {
+			parameters["position"] = ParameterSerializeHelper::serializeVec3(pos);
+			position = pos;
+		}
 
 		// path
 		void setPositions(const std::vector<std::array<double, 3>>& positions) {
 			ParameterSerializeHelper::serializeArray(parameters, "positions", positions, &ParameterSerializeHelper::serializeVec3);
+			this->positions = positions;
 		}
+
+	private:
+		FingerprintParameters parameters;
+		// typed parameters, see decodeParameters()
+		std::optional<std::array<double, 3>> position;
+		std::optional<size_t> floorIdx;
+		std::optional<std::string> floorName;
+		std::vector<std::string> pointNames;
+		std::vector<std::array<double, 3>> positions;
+		std::vector<size_t> floorIdcs;
+		std::vector<std::string> floorNames;
 	};
 
 	class Fingerprints {
 	private:
 		std::vector<Fingerprint> fingerprints;
 		std::multimap<std::string, size_t> nameMappings;
+		FingerprintSpatialIndex spatialIndex;
 
 	public:
+		Fingerprints(double spatialCellSize = FingerprintSpatialIndex::DEFAULT_CELL_SIZE) : spatialIndex(spatialCellSize) {}
+
 		void add(Fingerprint&& fp) {
 			size_t fpIdx = fingerprints.size();
 			nameMappings.insert({fp.name, fpIdx});
+			addToSpatialIndex(fp, fpIdx);
 			fingerprints.push_back(std::forward<Fingerprint>(fp));
 		}
 
+		const Fingerprint& at(size_t fpIdx) const { return fingerprints.at(fpIdx); }
+		Fingerprint& at(size_t fpIdx) { return fingerprints.at(fpIdx); }
+
 		std::optional<std::reference_wrapper<const Fingerprint>> getFirstByName(const std::string& name) const {
 			auto it = nameMappings.find(name);
 			if(it != nameMappings.end()) {
@@ -125,11 +220,35 @@ namespace SensorReadoutParser {
 			return {};
 		}
 
+		// #### SPATIAL QUERIES ####
+		// Positions are indexed when a fingerprint is added. Fingerprints without floorIdx / floorIdxs are not indexed.
+		// Use the fpIdx of the results with at().
+
+		/** All fingerprints with a position within radius around position on the given floor, sorted by distance */
+		std::vector<SpatialQueryResult> findWithinRadius(size_t floorIdx, const std::array<double, 3>& position, double radius) const {
+			return spatialIndex.findWithinRadius(floorIdx, position, radius);
+		}
+		/** The (up to) k fingerprints closest to position on the given floor, sorted by distance */
+		std::vector<SpatialQueryResult> findNearest(size_t floorIdx, const std::array<double, 3>& position, size_t k) const {
+			return spatialIndex.findNearest(floorIdx, position, k);
+		}
+		/** Rebuild the spatial index, required after changing the position of already added fingerprints */
+		void rebuildSpatialIndex() {
+			spatialIndex.clear();
+			for(size_t fpIdx = 0; fpIdx < fingerprints.size(); ++fpIdx) { addToSpatialIndex(fingerprints[fpIdx], fpIdx); }
+		}
+
+		/** Decode the pending events of all fingerprints, in parallel on threadCnt (0 = hardware concurrency) threads */
+		void loadEvents(size_t threadCnt = 0);
+
 		auto begin() { return fingerprints.begin(); }
 		auto end() { return fingerprints.end(); }
 		auto begin() const { return fingerprints.begin(); }
 		auto end() const { return fingerprints.end(); }
-		size_t size() { return fingerprints.size(); }
+		size_t size() const { return fingerprints.size(); }
+
+	private:
+		void addToSpatialIndex(const Fingerprint& fp, size_t fpIdx);
 	};
 
 
@@ -154,6 +273,8 @@ namespace SensorReadoutParser {
 
 		Fingerprints parse(std::optional<EventFilter> eventFilter = {}) {
 			stream.seekg(0, std::ifstream::beg);
+			std::optional<EventTypeFilter> typeFilter;
+			if(eventFilter) { typeFilter = EventTypeFilter(eventFilter->begin(), eventFilter->end()); }
 			Fingerprints result;
 			std::string line;
 
@@ -173,24 +294,26 @@ namespace SensorReadoutParser {
 				else if(line == "[fingerprint:path]") { currentFp.fpType = FingerprintType::Path; }
 				else { throw std::runtime_error("Encountered unsupported fingerprint type"); }
 
+				FingerprintParameters parameters;
 				while(true) {
 					if(!nextLine(line)) { throw std::runtime_error("Unexpected end of file"); }
 					if(line.empty()) { break; }
 					auto [propKey, propValue] = parseParameterLine(line);
-					currentFp.parameters.insert({propKey, propValue});
+					parameters.insert({propKey, propValue});
 				}
 				// require "name" property to be present
-				exceptAssert(currentFp.parameters.find("name") != currentFp.parameters.end(), "Fingerprint missing required 'name' property");
-				currentFp.name = currentFp.parameters.at("name");
+				exceptAssert(parameters.find("name") != parameters.end(), "Fingerprint missing required 'name' property");
+				currentFp.name = parameters.at("name");
+				currentFp.setParameters(std::move(parameters));
 				// parse events
 
+				// the filter has to be checked here instead of inside the VisitingParser, because it would otherwise
+				// consume the empty line that terminates this fingerprint's events
 				VisitingParser parser(stream, fileVersion);
 				RawSensorEvent rawEvt;
-				SensorEvent parsedEvt;
 				while(stream.peek() != '\n' && parser.nextLine(rawEvt)) {
-					parsedEvt = SensorEvent::parse(rawEvt);
-					if(eventFilter.has_value() && eventFilter->find(parsedEvt.eventType) == eventFilter->end()) { continue; }
-					currentFp.evts.push_back(std::move(parsedEvt));
+					if(typeFilter && !typeFilter->accepts(rawEvt.eventId)) { continue; }
+					currentFp.evts.push_back(SensorEvent::parse(rawEvt));
 				}
 				result.add(std::move(currentFp));
 			}
@@ -198,13 +321,27 @@ namespace SensorReadoutParser {
 			return result;
 		}
 
+		/**
+		 * @brief Split the stream into its fingerprint sections, and only parse their properties.
+		 * @details The stream is read into memory at once, and the events of each fingerprint are kept as raw lines
+		 * that are only decoded by Fingerprint::loadEvents() or Fingerprints::loadEvents(). Opening a large database
+		 * is thus cheap when the events of only a few fingerprints are needed.
+		 */
+		Fingerprints index(std::optional<EventFilter> eventFilter = {});
+		/** Same result as parse(), but the events of all fingerprints are decoded in parallel on threadCnt (0 = hardware concurrency) threads */
+		Fingerprints parseParallel(std::optional<EventFilter> eventFilter = {}, size_t threadCnt = 0) {
+			Fingerprints result = index(eventFilter);
+			result.loadEvents(threadCnt);
+			return result;
+		}
+
 	private:
-		std::pair<std::string, std::string> parseParameterLine(const std::string& line) {
+		std::pair<std::string, std::string> parseParameterLine(const std::string_view& line) {
 			auto propSepIdx = line.find('=');
 			if(propSepIdx == std::string::npos) { throw std::runtime_error("Invalid property line, missing key,value separator '='"); }
 			return {
-				line.substr(0, propSepIdx),
-				line.substr(propSepIdx + 1)
+				std::string(line.substr(0, propSepIdx)),
+				std::string(line.substr(propSepIdx + 1))
 			};
 		}
 		bool nextLine(std::string& line) {
@@ -239,7 +376,7 @@ namespace SensorReadoutParser {
 				}
 
 				// properties
-				for (const std::pair<std::string, std::string>& param : fp.parameters) {
+				for (const std::pair<std::string, std::string>& param : fp.getParameters()) {
 					stream << param.first << "=" << param.second << "\n";
 				}
 				stream << "\n";
@@ -249,6 +386,13 @@ namespace SensorReadoutParser {
 					for (const auto& evt : fp.evts) {
 						evtSerialzer.write(evt);
 					}
+					if (fp.pendingEvts) { // not yet decoded events of an indexed fingerprint
+						std::vector<SensorEvent> pendingEvts;
+						fp.pendingEvts->decodeInto(pendingEvts);
+						for (const auto& evt : pendingEvts) {
+							evtSerialzer.write(evt);
+						}
+					}
 					evtSerialzer.flush();
 				}
 				stream << "\n";
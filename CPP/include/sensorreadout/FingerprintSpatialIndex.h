@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "Assert.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # FingerprintSpatialIndex
+	// ######################
+
+	/** One fingerprint found by a spatial query */
+	struct SpatialQueryResult {
+		/** Index of the fingerprint in its Fingerprints container */
+		size_t fpIdx;
+		/** Index of the closest position within the fingerprint (always 0 for point fingerprints) */
+		size_t positionIdx;
+		/** Euclidean distance between the query position and the closest position of the fingerprint */
+		double distance;
+	};
+
+	/**
+	 * @brief Uniform grid over the (x,y) plane of each floor, mapping positions to the fingerprints recorded there.
+	 * @details A fingerprint with multiple positions (path) is inserted once per position, but reported at most once
+	 * per query (with its closest position). Distances are euclidean in all three dimensions. Inserting is O(1), so
+	 * the index can be updated while fingerprints are added. The cellSize should be in the order of the typical query
+	 * radius / distance between neighboring fingerprints.
+	 */
+	class FingerprintSpatialIndex {
+	public:
+		static constexpr double DEFAULT_CELL_SIZE = 2.0;
+
+	private:
+		struct Entry {
+			std::array<double, 3> position;
+			size_t fpIdx;
+			size_t positionIdx;
+		};
+		struct CellCoord {
+			int32_t x, y;
+		};
+		struct Floor {
+			std::unordered_map<uint64_t, std::vector<Entry>> cells;
+			/** Bounding box of all occupied cells */
+			CellCoord minCell = {INT32_MAX, INT32_MAX};
+			CellCoord maxCell = {INT32_MIN, INT32_MIN};
+		};
+
+		double cellSize;
+		std::unordered_map<size_t, Floor> floors;
+		size_t entryCnt = 0;
+
+	public:
+		FingerprintSpatialIndex(double cellSize = DEFAULT_CELL_SIZE) : cellSize(cellSize) {
+			exceptAssert(cellSize > 0, "Spatial index cell size has to be larger than 0");
+		}
+
+		/** Register position number positionIdx of the fingerprint with index fpIdx on the given floor */
+		void insert(size_t floorIdx, const std::array<double, 3>& position, size_t fpIdx, size_t positionIdx = 0);
+		void clear() { floors.clear(); entryCnt = 0; }
+
+		/** All fingerprints with a position within radius around position on the given floor, sorted by distance */
+		std::vector<SpatialQueryResult> findWithinRadius(size_t floorIdx, const std::array<double, 3>& position, double radius) const;
+		/** The (up to) k fingerprints closest to position on the given floor, sorted by distance */
+		std::vector<SpatialQueryResult> findNearest(size_t floorIdx, const std::array<double, 3>& position, size_t k) const;
+
+		/** Amount of inserted positions */
+		size_t size() const { return entryCnt; }
+		double getCellSize() const { return cellSize; }
+
+	private:
+		CellCoord cellOf(const std::array<double, 3>& position) const;
+		static uint64_t cellKey(CellCoord cell) {
+			return (static_cast<uint64_t>(static_cast<uint32_t>(cell.x)) << 32) | static_cast<uint32_t>(cell.y);
+		}
+	};
+
+} // namespace SensorReadoutParser
@@ -0,0 +1,94 @@
+#pragma once
+
+#ifdef SENSORREADOUT_WITH_ZLIB
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # GzipStreamBuffer
+	// ######################
+
+	/**
+	 * @brief Input streambuffer that decompresses a gzip (or zlib) compressed source stream on a background thread.
+	 * @details The decompression thread fills blocks of blockSize bytes ahead of the consumer, of which at most
+	 * QUEUE_DEPTH are in flight. Decompression thereby overlaps with parsing the previous block.
+	 * Concatenated gzip members are decompressed one after another, like gunzip does.
+	 * Decompression errors are rethrown as std::runtime_error from the reading thread.
+	 */
+	class GzipStreamBuffer : public std::streambuf {
+
+	public: // Associated Types & Constants
+		static constexpr size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+		static constexpr size_t QUEUE_DEPTH = 4;
+
+	private:
+		std::istream& source;
+		size_t blockSize;
+
+		// blocks are passed between the threads, such that no buffer is ever copied
+		std::mutex mutex;
+		std::condition_variable blockAvailable;
+		std::condition_variable slotAvailable;
+		std::deque<std::string> filledBlocks;
+		std::vector<std::string> freeBlocks;
+		bool finished = false;
+		bool stopRequested = false;
+		std::exception_ptr error;
+
+		std::string currentBlock;
+		std::thread decompressThread;
+
+		void decompress();
+		bool pushBlock(std::string&& block);
+
+	protected:
+		int_type underflow() override;
+
+	public:
+		GzipStreamBuffer(std::istream& source, size_t blockSize = DEFAULT_BLOCK_SIZE);
+		GzipStreamBuffer(const GzipStreamBuffer&) = delete;
+		~GzipStreamBuffer();
+
+		GzipStreamBuffer& operator=(const GzipStreamBuffer&) = delete;
+	};
+
+
+	// ###########
+	// # GzipInputStream
+	// ######################
+
+	/**
+	 * @brief std::istream reading a gzip compressed recording, that can be passed to all stream based parsers.
+	 * @details Seeking is not supported.
+	 */
+	class GzipInputStream : public std::istream {
+	private:
+		// declared in this order, such that decompression is stopped before the file is closed
+		std::unique_ptr<std::ifstream> file;
+		std::unique_ptr<GzipStreamBuffer> buffer;
+
+	public:
+		/** Read from the compressed file at the given path */
+		explicit GzipInputStream(const std::string& filePath, size_t blockSize = GzipStreamBuffer::DEFAULT_BLOCK_SIZE);
+		/** Read from the given compressed stream, which has to outlive this stream */
+		explicit GzipInputStream(std::istream& source, size_t blockSize = GzipStreamBuffer::DEFAULT_BLOCK_SIZE);
+
+		/** Check whether the given stream starts with the gzip magic bytes, without consuming them */
+		static bool isGzip(std::istream& stream);
+	};
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+#endif
+
+#include "Assert.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # HexCodec
+	// ######################
+
+	/**
+	 * @brief Table-driven encoding and decoding of hex strings.
+	 * @details Decoding accepts upper- and lowercase digits and throws std::runtime_error on invalid characters.
+	 */
+	struct HexCodec {
+		static constexpr int8_t INVALID_NIBBLE = -1;
+		static constexpr const char* UPPER_DIGITS = "0123456789ABCDEF";
+		static constexpr const char* LOWER_DIGITS = "0123456789abcdef";
+
+		static constexpr std::array<int8_t, 256> DECODE_TABLE = []() {
+			std::array<int8_t, 256> table = {};
+			for(auto& entry : table) { entry = INVALID_NIBBLE; }
+			for(int i = 0; i < 10; ++i) { table['0' + i] = static_cast<int8_t>(i); }
+			for(int i = 0; i < 6; ++i) {
+				table['a' + i] = static_cast<int8_t>(10 + i);
+				table['A' + i] = static_cast<int8_t>(10 + i);
+			}
+			return table;
+		}();
+
+		static uint8_t decodeNibble(char hex) {
+			int8_t nibble = DECODE_TABLE[static_cast<uint8_t>(hex)];
+			exceptWhen(nibble == INVALID_NIBBLE, "Invalid hex encountered");
+			return static_cast<uint8_t>(nibble);
+		}
+
+		/** Decode the two hex characters at hex[0] and hex[1] into one byte */
+		static uint8_t decodeByte(const char* hex) {
+			int8_t hi = DECODE_TABLE[static_cast<uint8_t>(hex[0])];
+			int8_t lo = DECODE_TABLE[static_cast<uint8_t>(hex[1])];
+			exceptWhen((hi | lo) < 0, "Invalid hex encountered");
+			return static_cast<uint8_t>((hi << 4) | lo);
+		}
+
+		/**
+		 * @brief Decode the hex string into hex.size() / 2 bytes at result.
+		 * @details Long inputs are decoded 32 characters at a time with SSE2 where available.
+		 */
+		static void decode(const std::string_view& hex, uint8_t* result) {
+			exceptAssert(hex.size() % 2 == 0, "Invalid HexString!");
+			size_t cPtr = 0;
+		#if defined(__SSE2__) || defined(_M_X64)
+			for(; cPtr + 32 <= hex.size(); cPtr += 32, result += 16) {
+				__m128i nibblesA = decodeNibbles16(hex.data() + cPtr);
+				__m128i nibblesB = decodeNibbles16(hex.data() + cPtr + 16);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(result), _mm_packus_epi16(combineNibbles(nibblesA), combineNibbles(nibblesB)));
+			}
+		#endif
+			for(; cPtr < hex.size(); cPtr += 2) {
+				*result++ = decodeByte(hex.data() + cPtr);
+			}
+		}
+		static std::vector<uint8_t> decode(const std::string_view& hex) {
+			std::vector<uint8_t> result(hex.size() / 2);
+			decode(hex, result.data());
+			return result;
+		}
+
+		/** Encode len bytes of data into 2 * len hex characters at result */
+		static void encode(const uint8_t* data, size_t len, char* result, bool uppercase = true) {
+			const char* digits = uppercase ? UPPER_DIGITS : LOWER_DIGITS;
+			for(size_t i = 0; i < len; ++i) {
+				*result++ = digits[data[i] >> 4];
+				*result++ = digits[data[i] & 0xF];
+			}
+		}
+		static std::string encode(const uint8_t* data, size_t len, bool uppercase = true) {
+			std::string result(len * 2, '\0');
+			encode(data, len, result.data(), uppercase);
+			return result;
+		}
+
+	private:
+	#if defined(__SSE2__) || defined(_M_X64)
+		/** Convert 16 hex characters into 16 bytes each holding the value of one nibble */
+		static __m128i decodeNibbles16(const char* hex) {
+			const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex));
+			const __m128i lowerChars = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+			const __m128i isDigit = _mm_and_si128(
+					_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+			const __m128i isLetter = _mm_and_si128(
+					_mm_cmpgt_epi8(lowerChars, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lowerChars, _mm_set1_epi8('f' + 1)));
+			exceptWhen(_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xFFFF, "Invalid hex encountered");
+			const __m128i digitValues = _mm_and_si128(isDigit, _mm_sub_epi8(chars, _mm_set1_epi8('0')));
+			const __m128i letterValues = _mm_andnot_si128(isDigit, _mm_sub_epi8(lowerChars, _mm_set1_epi8('a' - 10)));
+			return _mm_or_si128(digitValues, letterValues);
+		}
+		/** Combine each pair of nibble-bytes (high nibble first) into one byte, stored in the low half of a 16bit lane */
+		static __m128i combineNibbles(__m128i nibbles) {
+			const __m128i hi = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4);
+			const __m128i lo = _mm_srli_epi16(nibbles, 8);
+			return _mm_or_si128(hi, lo);
+		}
+	#endif
+	};
+
+}
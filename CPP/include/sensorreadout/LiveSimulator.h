@@ -1,35 +1,174 @@
 #pragma once
 
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 #include "SensorReadoutParser.h"
 
 namespace SensorReadoutParser {
 
+	// ###########
+	// # MergedEventSource
+	// ######################
+	/**
+	 * @brief k-way merge of multiple event sources, each sorted by timestamp, into one sorted stream.
+	 * @details Every source has an offset in nanoseconds, which is added to the timestamps of its events,
+	 * to align recordings that were started at different times. Events with equal (shifted) timestamps
+	 * are returned in the order of their sources. Only one event per source is buffered at a time.
+	 */
+	class MergedEventSource {
+	public: // Associated types
+		/** Source of events in timestamp order. Writes the next event into the argument, and returns false at the end. */
+		using EventSource = std::function<bool(SensorEvent&)>;
+
+	private:
+		struct Entry {
+			size_t sourceIdx;
+			SensorEvent evt;
+		};
+
+		std::vector<EventSource> sources;
+		std::vector<int64_t> offsetsNs;
+		// min-heap of the next event of every source that did not end yet
+		std::vector<Entry> heap;
+		bool primed = false;
+
+		static bool laterThan(const Entry& a, const Entry& b) {
+			return (a.evt.timestamp != b.evt.timestamp) ? (a.evt.timestamp > b.evt.timestamp) : (a.sourceIdx > b.sourceIdx);
+		}
+
+		/** Pull the next event of the given source into the heap */
+		void pull(size_t sourceIdx, SensorEvent&& storage) {
+			Entry entry { sourceIdx, std::move(storage) };
+			if(!sources[sourceIdx](entry.evt)) { return; }
+			int64_t shiftedTimestamp = static_cast<int64_t>(entry.evt.timestamp) + offsetsNs[sourceIdx];
+			entry.evt.timestamp = static_cast<Timestamp>(std::max<int64_t>(0, shiftedTimestamp));
+			heap.push_back(std::move(entry));
+			std::push_heap(heap.begin(), heap.end(), &MergedEventSource::laterThan);
+		}
+
+	public:
+		/**
+		 * @param sources Event sources, each sorted by timestamp.
+		 * @param offsetsNs Per-source offsets added to the timestamps (empty = no offsets). Shifted timestamps are clamped to 0.
+		 */
+		MergedEventSource(std::vector<EventSource> sources, std::vector<int64_t> offsetsNs = {})
+				: sources(std::move(sources)), offsetsNs(std::move(offsetsNs)) {
+			if(this->offsetsNs.empty()) { this->offsetsNs.resize(this->sources.size(), 0); }
+			exceptWhen(this->offsetsNs.size() != this->sources.size(), "Amount of offsets does not match the amount of sources");
+			heap.reserve(this->sources.size());
+		}
+
+		/** Write the next event of all sources into evt, and the index of its source into sourceIdx */
+		bool next(SensorEvent& evt, size_t& sourceIdx) {
+			if(!primed) {
+				for(size_t i = 0; i < sources.size(); ++i) { pull(i, SensorEvent()); }
+				primed = true;
+			}
+			if(heap.empty()) { return false; }
+			std::pop_heap(heap.begin(), heap.end(), &MergedEventSource::laterThan);
+			sourceIdx = heap.back().sourceIdx;
+			std::swap(evt, heap.back().evt);
+			// the previous content of evt is recycled as storage for the source's next event
+			SensorEvent storage = std::move(heap.back().evt);
+			heap.pop_back();
+			pull(sourceIdx, std::move(storage));
+			return true;
+		}
+	};
+
+
 	// ###########
 	// # LiveSimulator
 	// ######################
+	/**
+	 * @brief Replays a recording in (scaled) real time.
+	 * @details Events are either replayed from a vector set with setEvents(), or pulled lazily from an
+	 * EventSource set with setEventSource(). In the latter case, a read-ahead thread keeps at most
+	 * readAheadCnt events buffered, such that memory is constant regardless of the recording's length,
+	 * and replay starts as soon as the first event was read. Multiple recordings are replayed synchronously
+	 * with setEventSources(), which merges them into one stream. The MergedSensorEventCallback additionally
+	 * receives the index of the source each event originates from.
+	 */
 	class LiveSimulator {
 	public: // Associated types
 		using SensorEventCallback = std::function<void(const SensorEvent&)>;
+		using MergedSensorEventCallback = std::function<void(size_t sourceIdx, const SensorEvent&)>;
 		using RecordingEndedCallback = std::function<void()>;
+		using EventSource = MergedEventSource::EventSource;
+		static constexpr size_t DEFAULT_READ_AHEAD_CNT = 1024;
+		using Clock = std::chrono::steady_clock;
+
+		struct ScheduleOptions {
+			/** Events due within quantum after the first event of a wakeup are dispatched in the same wakeup */
+			std::chrono::nanoseconds quantum = std::chrono::microseconds(500);
+			/** Sleep until spinThreshold before a deadline, and busy-wait for the remainder (0 = never busy-wait) */
+			std::chrono::nanoseconds spinThreshold = std::chrono::nanoseconds(0);
+			/**
+			 * If the replay falls behind by more than resyncThreshold (e.g. while paused in a debugger), the schedule
+			 * is re-anchored at the late event, instead of racing to catch up (0 = always catch up)
+			 */
+			std::chrono::nanoseconds resyncThreshold = std::chrono::seconds(1);
+		};
+
+		struct ReplayMetrics {
+			size_t eventCnt = 0;
+			size_t wakeupCnt = 0;
+			/** Difference between dispatch time and deadline of the last event in ns (negative if dispatched early) */
+			int64_t lagNs = 0;
+			/** Maximum difference between dispatch time and deadline of all events in ns */
+			int64_t maxLatenessNs = 0;
+
+			double eventsPerWakeup() const { return (wakeupCnt > 0) ? static_cast<double>(eventCnt) / wakeupCnt : 0.0; }
+		};
 
 	private:
 		std::vector<SensorEvent> evts;
 		std::thread simulationThread;
+
+		// streaming mode
+		struct TaggedEvent {
+			size_t sourceIdx;
+			SensorEvent evt;
+		};
+		std::function<bool(SensorEvent&, size_t&)> eventSource;
+		size_t readAheadCnt = DEFAULT_READ_AHEAD_CNT;
+		std::thread readAheadThread;
+		std::mutex readAheadMutex;
+		std::condition_variable readAheadFilled;
+		std::condition_variable readAheadDrained;
+		std::deque<TaggedEvent> readAheadBuffer;
+		bool sourceEnded = false;
+		std::exception_ptr sourceError;
+
 		std::atomic<bool> shouldExit = false;
-		double playbackSpeed;
+		double playbackSpeed = 1.0;
 		SensorEventCallback sensorEventCallback;
+		MergedSensorEventCallback mergedSensorEventCallback;
 		RecordingEndedCallback recordingEndedCallback;
 
 		// simulation state
-		// the advantage of not using absolute timestamps is that pausing the debugger
-		// will not make the application race on to catch up afterwards, and that it's
-		// easier to change the playback speed
+		// deadlines are absolute, relative to the anchor, such that sleep overshoots do not accumulate into drift
 		std::atomic<Timestamp> runningTime = 0;
+		ScheduleOptions scheduleOptions;
+		Clock::time_point anchorTime;
+		Timestamp anchorTimestamp = 0;
+		Clock::time_point batchEnd;
+		std::mutex sleepMutex;
+		std::condition_variable sleepInterrupted;
+
+		std::atomic<size_t> eventCnt = 0;
+		std::atomic<size_t> wakeupCnt = 0;
+		std::atomic<int64_t> lagNs = 0;
+		std::atomic<int64_t> maxLatenessNs = 0;
 
 	public:
 		/**
@@ -42,42 +181,196 @@ namespace SensorReadoutParser {
 			setSensorEventCallback(callback);
 		}
 
+		~LiveSimulator() {
+			try { stop(); } catch (...) {}
+		}
+
 		void setEvents(const std::vector<SensorEvent>& evts) {
 			this->evts = evts;
+			this->eventSource = nullptr;
+		}
+		void setEvents(std::vector<SensorEvent>&& evts) {
+			this->evts = std::move(evts);
+			this->eventSource = nullptr;
+		}
+		/** Pull events lazily from the given source, keeping at most readAheadCnt events buffered */
+		void setEventSource(EventSource eventSource, size_t readAheadCnt = DEFAULT_READ_AHEAD_CNT) {
+			exceptWhen(readAheadCnt == 0, "Read-ahead count has to be larger than 0");
+			this->evts.clear();
+			this->eventSource = [eventSource](SensorEvent& evt, size_t& sourceIdx) {
+				sourceIdx = 0;
+				return eventSource(evt);
+			};
+			this->readAheadCnt = readAheadCnt;
 		}
+		/**
+		 * @brief Replay multiple sources synchronously, merged by timestamp.
+		 * @details offsetsNs are added to the timestamps of the respective source (empty = no offsets).
+		 */
+		void setEventSources(std::vector<EventSource> eventSources, std::vector<int64_t> offsetsNs = {}, size_t readAheadCnt = DEFAULT_READ_AHEAD_CNT) {
+			exceptWhen(readAheadCnt == 0, "Read-ahead count has to be larger than 0");
+			auto mergedSource = std::make_shared<MergedEventSource>(std::move(eventSources), std::move(offsetsNs));
+			this->evts.clear();
+			this->eventSource = [mergedSource](SensorEvent& evt, size_t& sourceIdx) { return mergedSource->next(evt, sourceIdx); };
+			this->readAheadCnt = readAheadCnt;
+		}
+		/** Pull events lazily from the given parser, which has to outlive the simulation */
+		void setEventSource(VisitingParser& parser, size_t readAheadCnt = DEFAULT_READ_AHEAD_CNT) {
+			setEventSource([&parser, rawEvent = RawSensorEvent()](SensorEvent& evt) mutable {
+				if(!parser.nextLine(rawEvent)) { return false; }
+				evt = SensorEvent::parse(rawEvent);
+				return true;
+			}, readAheadCnt);
+		}
+		void setScheduleOptions(const ScheduleOptions& scheduleOptions) { this->scheduleOptions = scheduleOptions; }
 		void setSensorEventCallback(SensorEventCallback callback) { this->sensorEventCallback = callback; }
+		void setMergedSensorEventCallback(MergedSensorEventCallback callback) { this->mergedSensorEventCallback = callback; }
 		void setRecordingEndedCallback(RecordingEndedCallback callback) { this->recordingEndedCallback = callback; }
 
 		void start() {
 			shouldExit.store(false);
+			anchorTime = Clock::now();
+			anchorTimestamp = runningTime;
+			batchEnd = Clock::time_point::min();
+			eventCnt = 0;
+			wakeupCnt = 0;
+			lagNs = 0;
+			maxLatenessNs = 0;
+			if(eventSource) {
+				readAheadBuffer.clear();
+				sourceEnded = false;
+				sourceError = nullptr;
+				readAheadThread = std::thread(&LiveSimulator::readAhead, this);
+			}
 			simulationThread = std::thread([&]() {
-				for(size_t i = 0; i < evts.size(); ++i) {
-					if(shouldExit) { return; }
-					const auto& nextEvt = evts[i];
-					if (runningTime < nextEvt.timestamp && playbackSpeed > 0) {
-						double sleepTimeNs = static_cast<double>(nextEvt.timestamp - runningTime) / playbackSpeed;
-						std::this_thread::sleep_for(std::chrono::nanoseconds(static_cast<int64_t>(sleepTimeNs)));
+				if(eventSource) {
+					TaggedEvent nextEvt;
+					bool sourceReplayed = false;
+					while(nextBufferedEvent(nextEvt, sourceReplayed)) {
+						if(!replay(nextEvt.evt, nextEvt.sourceIdx)) { return; }
+					}
+					if(!sourceReplayed) { return; }
+				} else {
+					for(size_t i = 0; i < evts.size(); ++i) {
+						if(!replay(evts[i], 0)) { return; }
 					}
-					runningTime = nextEvt.timestamp;
-					if (sensorEventCallback) { this->sensorEventCallback(nextEvt); }
 				}
 				if (this->recordingEndedCallback) { this->recordingEndedCallback(); }
 			});
 		}
 
+		/** Wait for the replay to end. Errors of the event source are rethrown here. */
 		void wait() {
 			if(simulationThread.joinable()) {
 				simulationThread.join();
 			}
+			if(readAheadThread.joinable()) {
+				readAheadThread.join();
+			}
+			if(sourceError) {
+				std::exception_ptr error = sourceError;
+				sourceError = nullptr;
+				std::rethrow_exception(error);
+			}
 		}
 
 		void stop() {
 			shouldExit.store(true);
+			{ // wake up the read-ahead thread, if it is waiting for space in the buffer
+				std::lock_guard<std::mutex> lock(readAheadMutex);
+				readAheadDrained.notify_all();
+				readAheadFilled.notify_all();
+			}
+			{ // interrupt the simulation thread, if it is waiting for the next deadline
+				std::lock_guard<std::mutex> lock(sleepMutex);
+				sleepInterrupted.notify_all();
+			}
 			wait();
 		}
 
 		/** amount of nanoseconds that passed since the recording simulation started */
 		Timestamp runningTimeNs() const { return runningTime; }
+
+		/** Timing metrics of the current (or last) replay, can be queried while the replay is running */
+		ReplayMetrics getMetrics() const {
+			return ReplayMetrics { eventCnt, wakeupCnt, lagNs, maxLatenessNs };
+		}
+
+	private:
+		/** Wait until the given event is due, and dispatch it. Returns false if the simulation was stopped. */
+		bool replay(const SensorEvent& nextEvt, size_t sourceIdx) {
+			if(shouldExit) { return false; }
+			if (playbackSpeed > 0) {
+				int64_t offsetNs = static_cast<int64_t>(nextEvt.timestamp - anchorTimestamp);
+				Clock::time_point deadline = anchorTime + std::chrono::nanoseconds(static_cast<int64_t>(offsetNs / playbackSpeed));
+				if(deadline > batchEnd) { // not part of the current wakeup's quantum
+					if(!sleepUntil(deadline)) { return false; }
+					batchEnd = deadline + scheduleOptions.quantum;
+					++wakeupCnt;
+				}
+				Clock::time_point now = Clock::now();
+				int64_t latenessNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline).count();
+				lagNs = latenessNs;
+				if(latenessNs > maxLatenessNs) { maxLatenessNs = latenessNs; }
+				if(scheduleOptions.resyncThreshold.count() > 0 && latenessNs > scheduleOptions.resyncThreshold.count()) {
+					anchorTime = now;
+					anchorTimestamp = nextEvt.timestamp;
+					batchEnd = now + scheduleOptions.quantum;
+				}
+			}
+			runningTime = nextEvt.timestamp;
+			++eventCnt;
+			if (sensorEventCallback) { this->sensorEventCallback(nextEvt); }
+			if (mergedSensorEventCallback) { this->mergedSensorEventCallback(sourceIdx, nextEvt); }
+			return true;
+		}
+
+		/** Sleep until shortly before the deadline, and busy-wait the rest. Returns false if the simulation was stopped. */
+		bool sleepUntil(Clock::time_point deadline) {
+			Clock::time_point sleepDeadline = deadline - scheduleOptions.spinThreshold;
+			if(Clock::now() < sleepDeadline) {
+				std::unique_lock<std::mutex> lock(sleepMutex);
+				sleepInterrupted.wait_until(lock, sleepDeadline, [&]() { return shouldExit.load(); });
+			}
+			while(!shouldExit && Clock::now() < deadline) {}
+			return !shouldExit;
+		}
+
+		void readAhead() {
+			try {
+				TaggedEvent evt;
+				while(!shouldExit && eventSource(evt.evt, evt.sourceIdx)) {
+					std::unique_lock<std::mutex> lock(readAheadMutex);
+					readAheadDrained.wait(lock, [&]() { return readAheadBuffer.size() < readAheadCnt || shouldExit; });
+					readAheadBuffer.push_back(std::move(evt));
+					readAheadFilled.notify_one();
+				}
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(readAheadMutex);
+				sourceError = std::current_exception();
+			}
+			std::lock_guard<std::mutex> lock(readAheadMutex);
+			sourceEnded = true;
+			readAheadFilled.notify_one();
+		}
+
+		/**
+		 * @brief Pop the next buffered event, waiting for the read-ahead thread if necessary.
+		 * @details Returns false once there are no further events to replay. sourceReplayed is then only set, if the source
+		 * ended regularly, i.e. the replay was neither stopped nor ended by an error of the source.
+		 */
+		bool nextBufferedEvent(TaggedEvent& evt, bool& sourceReplayed) {
+			std::unique_lock<std::mutex> lock(readAheadMutex);
+			readAheadFilled.wait(lock, [&]() { return !readAheadBuffer.empty() || sourceEnded || shouldExit; });
+			if(readAheadBuffer.empty() || shouldExit) {
+				sourceReplayed = !shouldExit && !sourceError;
+				return false;
+			}
+			evt = std::move(readAheadBuffer.front());
+			readAheadBuffer.pop_front();
+			readAheadDrained.notify_one();
+			return true;
+		}
 	};
 
 }
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "SensorReadoutParser.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # MacDictionary
+	// ######################
+
+	/**
+	 * @brief Interning dictionary that maps every distinct MacAddress to a dense MacId in [0, size()).
+	 * @details Radio recordings contain few distinct MACs, that repeat in every scan. With ids, per access point
+	 * aggregations become plain array indexing. Lookup is an open addressing hash table with linear probing over the
+	 * 48 bit integer representation of the MACs, which never reaches the EMPTY_KEY sentinel.
+	 */
+	class MacDictionary {
+	private:
+		static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+		static constexpr size_t MIN_CAPACITY = 64;
+
+		struct Slot {
+			uint64_t key = EMPTY_KEY;
+			MacId id = INVALID_MAC_ID;
+		};
+
+		/** Power of two sized, at most half full */
+		std::vector<Slot> slots;
+		/** Amount of bits of the slot index, capacity = 2^slotBits */
+		unsigned slotBits = 0;
+		/** MacId -> MacAddress */
+		std::vector<MacAddress> macs;
+
+	public:
+		MacDictionary(size_t expectedMacCnt = 0);
+
+		/** Id of the given MAC, assigns the next free id if it was not seen before */
+		MacId intern(const MacAddress& mac) {
+			const uint64_t key = mac.toUInt64();
+			for(size_t slotIdx = slotOf(key);; slotIdx = (slotIdx + 1) & (slots.size() - 1)) {
+				Slot& slot = slots[slotIdx];
+				if(slot.key == key) { return slot.id; }
+				if(slot.key == EMPTY_KEY) {
+					const MacId id = static_cast<MacId>(macs.size());
+					slot = { key, id };
+					macs.push_back(mac);
+					if(macs.size() * 2 > slots.size()) { rehash(slots.size() * 2); }
+					return id;
+				}
+			}
+		}
+		/** Id of the given MAC, or INVALID_MAC_ID if it was not interned */
+		MacId find(const MacAddress& mac) const {
+			const uint64_t key = mac.toUInt64();
+			for(size_t slotIdx = slotOf(key);; slotIdx = (slotIdx + 1) & (slots.size() - 1)) {
+				const Slot& slot = slots[slotIdx];
+				if(slot.key == key) { return slot.id; }
+				if(slot.key == EMPTY_KEY) { return INVALID_MAC_ID; }
+			}
+		}
+		const MacAddress& mac(MacId id) const { return macs.at(id); }
+		const std::vector<MacAddress>& getMacs() const { return macs; }
+		size_t size() const { return macs.size(); }
+		bool empty() const { return macs.empty(); }
+		void clear();
+
+		/** Intern the MACs of evt (Wifi, BLE, WifiRTT and EddystoneUID events) and set their macId */
+		void assignIds(SensorEvent& evt);
+
+	private:
+		size_t slotOf(uint64_t key) const { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - slotBits)); }
+		void rehash(size_t capacity);
+	};
+
+} // namespace SensorReadoutParser
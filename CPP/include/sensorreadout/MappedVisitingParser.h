@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "SensorReadoutParser.h"
+#include "SeparatorIndex.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # MappedFile
+	// ######################
+
+	/**
+	 * @brief RAII wrapper around a read-only memory mapping of an entire file.
+	 */
+	class MappedFile {
+	private:
+		const char* data = nullptr;
+		size_t size = 0;
+
+	public:
+		explicit MappedFile(const std::string& filePath);
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&& o) noexcept;
+		~MappedFile();
+
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&& o) noexcept;
+
+		std::string_view view() const { return std::string_view(data, size); }
+	};
+
+
+	// ###########
+	// # MappedVisitingParser
+	// ######################
+
+	/**
+	 * @brief Zero-copy variant of the VisitingParser.
+	 * @details Instead of copying every line out of a stream, this parser operates on a contiguous
+	 * buffer (typically a memory mapped recording) and yields RawSensorEventView instances whose
+	 * parameterString points directly into that buffer. The views are valid for as long as the parser lives.
+	 */
+	class MappedVisitingParser {
+
+	public: // Associated Types & Constants
+		/** Size of the window of the buffer for which separators are indexed at once */
+		static constexpr size_t INDEX_WINDOW_SIZE = 256 * 1024;
+
+	private: // Parser state
+		std::optional<MappedFile> mapping;
+		std::string_view buffer;
+		size_t ptr = 0;
+		FileVersion fileVersion;
+		// separator index over the window of buffer starting at indexBase
+		SeparatorIndex separatorIndex;
+		size_t indexBase = 0;
+		std::optional<EventTypeFilter> eventFilter;
+
+		void indexWindow(size_t windowBase, size_t windowSize);
+		bool nextAnyLine(RawSensorEventView& sensorEvent);
+
+		MappedVisitingParser(std::string_view buffer, FileVersion fileVersion) : buffer(buffer), fileVersion(fileVersion) {}
+
+	public: // API-Surface
+		/** Memory-map the recording at the given path and parse from it */
+		MappedVisitingParser(const std::string& filePath, FileVersion fileVersion = FileVersion::V1);
+		/** Parse from the given buffer. The buffer has to outlive the parser and all views it returned. */
+		static MappedVisitingParser fromBuffer(std::string_view buffer, FileVersion fileVersion = FileVersion::V1) {
+			return MappedVisitingParser(buffer, fileVersion);
+		}
+
+		/** Only return events whose type is accepted by the given filter. */
+		void setEventFilter(std::optional<EventTypeFilter> eventFilter) { this->eventFilter = eventFilter; }
+
+		bool nextLine(RawSensorEventView& sensorEvent);
+
+		/** Offset of the next line within the buffer */
+		size_t position() const { return ptr; }
+		/** The entire buffer this parser operates on */
+		std::string_view data() const { return buffer; }
+	};
+
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace SensorReadoutParser {
+
+	namespace _internal {
+		/**
+		 * @brief Call task(i) for all i in [0, taskCnt) on a pool of threadCnt (0 = hardware concurrency) threads.
+		 * @details The first exception thrown by a task cancels the remaining tasks, and is rethrown on the calling thread.
+		 */
+		void parallelFor(size_t taskCnt, size_t threadCnt, const std::function<void(size_t)>& task);
+	}
+
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SensorReadoutParser.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # SPSCQueue
+	// ######################
+
+	/**
+	 * @brief Bounded lock-free queue for exactly one producer and one consumer thread.
+	 * @details Slots are preallocated in a ring buffer with a power of two capacity. Values are moved in and out,
+	 * such that buffers passed through the queue are never copied. Once the producer called close(), the consumer
+	 * can drain the remaining values, after which isDrained() is true.
+	 * Threads that have to wait for the other side use waitFor(), which spins shortly and then sleeps until the
+	 * next push, pop, close() or notify().
+	 */
+	template<typename T>
+	class SPSCQueue {
+	private:
+		/** Amount of polls in waitFor(), before the thread is put to sleep */
+		static constexpr size_t SPIN_CNT = 64;
+
+		std::vector<T> slots;
+		size_t mask;
+		// consumer and producer index on separate cache lines, to prevent false sharing between the threads
+		alignas(64) std::atomic<size_t> head = 0;
+		alignas(64) std::atomic<size_t> tail = 0;
+		alignas(64) std::atomic<bool> closed = false;
+		/** Incremented on every state change, sleeping threads wait for it to change */
+		alignas(64) std::atomic<uint32_t> signal = 0;
+
+	public:
+		SPSCQueue(size_t capacity) : slots(std::bit_ceil(std::max<size_t>(capacity, 1))), mask(slots.size() - 1) {}
+		SPSCQueue(const SPSCQueue&) = delete;
+		SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+		/** Producer: move value into the queue. Returns false (and leaves value untouched) if the queue is full. */
+		bool tryPush(T& value) {
+			size_t curTail = tail.load(std::memory_order_relaxed);
+			if(curTail - head.load(std::memory_order_acquire) == slots.size()) { return false; }
+			slots[curTail & mask] = std::move(value);
+			tail.store(curTail + 1, std::memory_order_release);
+			notify();
+			return true;
+		}
+		/** Consumer: move the oldest value out of the queue. Returns false if the queue is empty. */
+		bool tryPop(T& value) {
+			size_t curHead = head.load(std::memory_order_relaxed);
+			if(curHead == tail.load(std::memory_order_acquire)) { return false; }
+			value = std::move(slots[curHead & mask]);
+			head.store(curHead + 1, std::memory_order_release);
+			notify();
+			return true;
+		}
+
+		/** Producer: signal that no more values will be pushed */
+		void close() { closed.store(true, std::memory_order_release); notify(); }
+		/** Consumer: true if the producer closed the queue, and all values were popped */
+		bool isDrained() const {
+			// closed has to be read first, values pushed before close() are then guaranteed to be visible
+			return closed.load(std::memory_order_acquire) && head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+		}
+		size_t capacity() const { return slots.size(); }
+
+		/** Wake the threads blocked in waitFor(), e.g. after an external condition checked by their ready() changed */
+		void notify() {
+			signal.fetch_add(1, std::memory_order_release);
+			signal.notify_all();
+		}
+		/**
+		 * @brief Block until ready() returns true.
+		 * @details ready() is polled SPIN_CNT times, afterwards the thread sleeps until the next state change of the queue.
+		 * The signal is read before ready() is checked, so a change in between makes the wait return immediately.
+		 */
+		template<typename TReady>
+		void waitFor(TReady ready) {
+			for(size_t spinCnt = 0; spinCnt < SPIN_CNT; ++spinCnt) {
+				if(ready()) { return; }
+			}
+			while(true) {
+				uint32_t observedSignal = signal.load(std::memory_order_acquire);
+				if(ready()) { return; }
+				signal.wait(observedSignal, std::memory_order_acquire);
+			}
+		}
+	};
+
+
+	// ###########
+	// # ParsePipeline
+	// ######################
+
+	struct PipelineOptions {
+		/** Amount of parse stages (0 = hardware concurrency - 1) */
+		size_t parserCnt = 0;
+		/** Approximate amount of bytes per chunk. Chunks are always extended to the next line break. */
+		size_t chunkSize = 1024 * 1024;
+		/** Capacity of the queues between the stages, in chunks per parse stage */
+		size_t queueDepth = 4;
+	};
+
+	/**
+	 * @brief Pipelined execution of reading, parsing and consuming a recording on separate threads.
+	 * @details An I/O thread reads line-aligned chunks from the parser's stream and hands them to the
+	 * parse stages in round-robin order. Each parse stage has its own pair of bounded SPSC queues, and
+	 * the consumer collects the parsed batches in the same round-robin order, such that events are
+	 * delivered in file order. Full queues block their producer (backpressure), so memory is bounded by
+	 * parserCnt * queueDepth chunks. Chunks and event batches are recycled through return queues.
+	 * Exceptions of any stage, including the consumer, stop all stages and are rethrown by run().
+	 */
+	class ParsePipeline {
+	public: // Associated Types
+		using Consumer = std::function<void(const SensorEvent&)>;
+
+	private:
+		using EventBatch = std::vector<SensorEvent>;
+		struct Lane {
+			SPSCQueue<std::string> chunks;
+			SPSCQueue<std::string> freeChunks;
+			SPSCQueue<EventBatch> batches;
+			SPSCQueue<EventBatch> freeBatches;
+			Lane(size_t queueDepth) : chunks(queueDepth), freeChunks(queueDepth + 2), batches(queueDepth), freeBatches(queueDepth + 2) {}
+		};
+
+		VisitingParser& parser;
+		PipelineOptions options;
+		std::vector<std::unique_ptr<Lane>> lanes;
+		std::atomic<bool> aborted = false;
+		std::mutex errorMutex;
+		std::exception_ptr error;
+
+		void abort(std::exception_ptr exception);
+		/** Set aborted, and wake all stages blocked on one of the queues */
+		void stop();
+		void readStage();
+		void parseStage(Lane& lane);
+		/** Block until value was pushed, or the pipeline was aborted */
+		template<typename T> bool push(SPSCQueue<T>& queue, T& value);
+		/** Block until a value was popped, or the queue was drained, or the pipeline was aborted */
+		template<typename T> bool pop(SPSCQueue<T>& queue, T& value);
+
+	public:
+		ParsePipeline(VisitingParser& parser, const PipelineOptions& options = {});
+
+		/**
+		 * @brief Parse all (remaining) events of the parser, and call consumer for each of them in file order.
+		 * @details The consumer is called on the calling thread. Returns the amount of consumed events.
+		 */
+		size_t run(const Consumer& consumer);
+	};
+
+}
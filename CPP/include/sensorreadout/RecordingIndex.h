@@ -0,0 +1,135 @@
+#pragma once
+
+#include <istream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SensorReadoutParser.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # RecordingIndex
+	// ######################
+
+	struct RecordingIndexOptions {
+		/** Amount of lines per indexed block. Smaller blocks make range queries read less, but grow the index. */
+		size_t blockLineCnt = 1024;
+		/** EventTypes for which the offset of every single event is stored (std::nullopt = all types) */
+		std::optional<EventTypeFilter> indexedEventTypes;
+
+		bool operator==(const RecordingIndexOptions& o) const = default;
+	};
+
+	/**
+	 * @brief Sparse index of a textual recording, used for random access without parsing the entire file.
+	 * @details The recording is split into blocks of blockLineCnt lines. For every block, the byte offset of its first line
+	 * and the timestamp bounds needed to answer time-range queries in logarithmic time are stored. Since timestamps of
+	 * different sensors are not strictly ordered within a recording, each block stores the maximum timestamp up to (and including)
+	 * itself, and the minimum timestamp from itself onwards. Additionally, the offsets of all events of the indexed EventTypes are kept.
+	 * An index is usually stored as sidecar file next to its recording (see sidecarPath()). To detect outdated sidecars, the
+	 * index additionally stores the options it was built with, and the size, modification time and a hash over the first and last
+	 * bytes of the recording.
+	 */
+	class RecordingIndex {
+
+	public: // Associated Types & Constants
+		struct Block {
+			uint64_t offset;
+			/** Largest timestamp of all lines in this and all previous blocks */
+			Timestamp maxTimestampUpTo;
+			/** Smallest timestamp of all lines in this and all following blocks */
+			Timestamp minTimestampFrom;
+		};
+		struct EventEntry {
+			Timestamp timestamp;
+			uint64_t offset;
+		};
+		/** Range of bytes [begin, end) within the recording */
+		struct ByteRange {
+			uint64_t begin;
+			uint64_t end;
+
+			bool empty() const { return begin >= end; }
+		};
+
+	private:
+		uint64_t recordingSize = 0;
+		/** Modification time of the recording file (0 if built from a buffer) */
+		int64_t recordingMTime = 0;
+		/** Hash over the head and tail of the recording, see hashRecording() */
+		uint64_t recordingHash = 0;
+		FileVersion fileVersion = FileVersion::V1;
+		RecordingIndexOptions options;
+		uint64_t lineCnt = 0;
+		std::vector<Block> blocks;
+		std::map<EventId, std::vector<EventEntry>> eventEntries;
+
+	public:
+		/** Build the index for the given recording buffer */
+		static RecordingIndex buildFromBuffer(std::string_view recording, FileVersion fileVersion = FileVersion::V1, const RecordingIndexOptions& options = {});
+		/** Build the index for the recording at the given path */
+		static RecordingIndex build(const std::string& recordingPath, FileVersion fileVersion = FileVersion::V1, const RecordingIndexOptions& options = {});
+
+		/** Path of the sidecar index file that belongs to the given recording */
+		static std::string sidecarPath(const std::string& recordingPath) { return recordingPath + ".idx"; }
+		void save(const std::string& indexPath) const;
+		static RecordingIndex load(const std::string& indexPath);
+		/**
+		 * @brief Load the sidecar index of the given recording, or build and save it if it does not exist or is outdated.
+		 * @details A sidecar is outdated if it was written by an older version of this library, was built with different
+		 * options, or if the recording's size, modification time or head/tail hash changed.
+		 */
+		static RecordingIndex loadOrBuild(const std::string& recordingPath, FileVersion fileVersion = FileVersion::V1, const RecordingIndexOptions& options = {});
+
+		/**
+		 * @brief Find the smallest range of whole blocks containing all events with a timestamp within [begin, end).
+		 * @details The range may also contain events outside of the requested interval. Runs in O(log(blockCnt)).
+		 */
+		ByteRange timeRange(Timestamp begin, Timestamp end) const;
+		/** Offset of the first block that can contain events with a timestamp >= the given timestamp */
+		uint64_t offsetOf(Timestamp timestamp) const { return timeRange(timestamp, std::numeric_limits<Timestamp>::max()).begin; }
+
+		/** All events of the given type in the order of the recording. Empty if the type was not indexed. */
+		const std::vector<EventEntry>& events(EventType eventType) const;
+
+		const std::vector<Block>& getBlocks() const { return blocks; }
+		uint64_t getRecordingSize() const { return recordingSize; }
+		FileVersion getFileVersion() const { return fileVersion; }
+		const RecordingIndexOptions& getOptions() const { return options; }
+		uint64_t getLineCnt() const { return lineCnt; }
+	};
+
+
+	// ###########
+	// # SeekableReader
+	// ######################
+
+	/**
+	 * @brief Random access to a textual recording stream, using its RecordingIndex.
+	 * @details The stream has to be seekable, the index has to outlive this reader.
+	 */
+	class SeekableReader {
+	private:
+		std::istream& stream;
+		const RecordingIndex& index;
+		FileVersion fileVersion;
+		std::string rangeBuffer;
+
+	public:
+		SeekableReader(std::istream& stream, const RecordingIndex& index, FileVersion fileVersion = FileVersion::V1);
+
+		/** Seek to the given offset, which has to be the start of a line (e.g. taken from the index), and parse from there */
+		VisitingParser parserAtOffset(uint64_t offset);
+		/** Seek to the first block that can contain events with a timestamp >= the given timestamp, and parse from there */
+		VisitingParser parserAtTime(Timestamp timestamp);
+
+		/** All events with a timestamp within [begin, end), in the order of the recording */
+		std::vector<RawSensorEvent> query(Timestamp begin, Timestamp end, const std::optional<EventTypeFilter>& eventFilter = std::nullopt);
+	};
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include "SensorReadoutParser.h"
+#include "MappedVisitingParser.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # ValueStatistics
+	// ######################
+
+	/**
+	 * @brief Running min / max / mean / variance of one value (Welford).
+	 * @details Two instances can be merged with the parallel variant of the algorithm (Chan et al.), giving the same
+	 * result as if all values were pushed into one instance.
+	 */
+	struct ValueStatistics {
+		size_t count = 0;
+		double min = std::numeric_limits<double>::infinity();
+		double max = -std::numeric_limits<double>::infinity();
+		double mean = 0;
+		/** Sum of squared differences from the mean */
+		double m2 = 0;
+
+		void push(double value) {
+			++count;
+			min = std::min(min, value);
+			max = std::max(max, value);
+			double delta = value - mean;
+			mean += delta / static_cast<double>(count);
+			m2 += delta * (value - mean);
+		}
+		void merge(const ValueStatistics& o);
+
+		/** Population variance, 0 for less than two values */
+		double variance() const { return (count > 1) ? (m2 / static_cast<double>(count)) : 0.0; }
+		double stddev() const;
+	};
+
+
+	// ###########
+	// # EventTypeStatistics
+	// ######################
+
+	/** Statistics of all events of one EventType */
+	struct EventTypeStatistics {
+		/** Bucket i counts intervals in [2^(i-1), 2^i) nanoseconds, bucket 0 counts intervals of 0 */
+		static constexpr size_t INTERVAL_BUCKET_CNT = 64;
+		static constexpr size_t LARGEST_GAP_CNT = 8;
+
+		struct Gap {
+			/** Timestamp of the event before the gap */
+			Timestamp start;
+			Timestamp duration;
+		};
+
+		size_t eventCnt = 0;
+		Timestamp firstTimestamp = 0;
+		Timestamp lastTimestamp = 0;
+		/** Events with a timestamp smaller than that of their predecessor. They do not contribute an interval. */
+		size_t outOfOrderCnt = 0;
+		/** Intervals between consecutive events in nanoseconds. Its stddev is the jitter. */
+		ValueStatistics intervals;
+		std::array<size_t, INTERVAL_BUCKET_CNT> intervalHistogram = {};
+		/** The largest intervals between consecutive events, sorted descending */
+		std::vector<Gap> largestGaps;
+		/** Statistics for each value of numeric event types */
+		std::vector<ValueStatistics> values;
+		/** Unique MAC addresses of radio event types (Wifi, BLE, WifiRTT, EddystoneUID), encoded as integer */
+		std::unordered_set<uint64_t> macs;
+
+		/** Account for one more event at timestamp */
+		void pushTimestamp(Timestamp timestamp);
+		void pushMac(const MacAddress& mac);
+		/** Merge the statistics of o, which covers the events directly following the events of this instance */
+		void merge(const EventTypeStatistics& o);
+
+		/** Mean amount of events per second */
+		double meanRate() const;
+		size_t uniqueMacCnt() const { return macs.size(); }
+
+	private:
+		void pushInterval(Timestamp start, Timestamp interval);
+	};
+
+
+	// ###########
+	// # RecordingStatistics
+	// ######################
+
+	/**
+	 * @brief Per EventType statistics of a recording, calculated in a single streaming pass (C++ counterpart of recordingStatistics.m).
+	 * @details Only the values that are needed are decoded from the raw events: numeric values, and the MAC addresses of
+	 * radio events. All other events only contribute their timestamp.
+	 *
+	 * Statistics are mergeable: when a recording is split into consecutive chunks that are processed in parallel,
+	 * merging the statistics of all chunks in order gives the same result as one pass over the whole recording.
+	 */
+	class RecordingStatistics {
+	private:
+		size_t eventCnt = 0;
+		Timestamp firstTimestamp = 0;
+		Timestamp lastTimestamp = 0;
+		std::map<EventType, EventTypeStatistics> eventTypes;
+		// scratch buffer, to avoid allocating per Wifi event
+		std::vector<WifiAdvertisement> wifiAdvertisements;
+
+	public:
+		void add(const RawSensorEventView& rawEvent);
+		void add(const SensorEvent& evt);
+		/** Merge the statistics of o, which covers the events directly following the events of this instance */
+		void merge(const RecordingStatistics& o);
+
+		/** Calculate the statistics of all (remaining) events of the given parser */
+		static RecordingStatistics compute(VisitingParser& parser);
+		static RecordingStatistics compute(MappedVisitingParser& parser);
+
+		size_t getEventCnt() const { return eventCnt; }
+		/** Duration between the smallest and the largest timestamp */
+		Timestamp getDuration() const { return lastTimestamp - firstTimestamp; }
+		const std::map<EventType, EventTypeStatistics>& getEventTypes() const { return eventTypes; }
+		/** Statistics of the given EventType, or nullptr if the recording has no such event */
+		const EventTypeStatistics* get(EventType eventType) const;
+
+	private:
+		EventTypeStatistics& pushTimestamp(EventType eventType, Timestamp timestamp);
+	};
+
+}
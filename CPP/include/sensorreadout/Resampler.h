@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+	#include <immintrin.h>
+#endif
+
+#include "ColumnarRecording.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # Resampling
+	// ######################
+	//
+	// Semantics follow Octave_Matlab/src/timedResample.m: the resampled signal starts at startTs (which has to be >= the
+	// first timestamp of the signal), and has one sample every interval nanoseconds. Resampling stops at the last sample
+	// of the signal, i.e. the result contains all grid points startTs + i * interval <= last timestamp.
+	// Only channels with floating point values can be resampled.
+
+	enum class Interpolation {
+		Linear,
+		/** Cubic Hermite spline, with tangents from the neighboring samples (Catmull-Rom for non-uniform timestamps) */
+		Cubic
+	};
+
+	struct ResampleOptions {
+		Interpolation interpolation = Interpolation::Linear;
+		/** Amount of worker threads (0 = use hardware concurrency) */
+		size_t threadCnt = 0;
+		/** Amount of output samples per parallel task */
+		size_t blockSampleCnt = 64 * 1024;
+	};
+
+	/**
+	 * @brief Result of resampling a NumericChannel to a fixed-rate grid.
+	 * @details Like in NumericChannel, the VALUE_CNT values of sample i start at values[i * VALUE_CNT].
+	 */
+	template<typename TEvent>
+	struct ResampledChannel {
+		using Event = TEvent;
+		using NumericValue = typename TEvent::NumericValue;
+		static constexpr size_t VALUE_CNT = TEvent::VALUE_CNT;
+
+		Timestamp startTs = 0;
+		Timestamp interval = 0;
+		std::vector<NumericValue> values;
+
+		size_t size() const { return values.size() / VALUE_CNT; }
+		bool empty() const { return values.empty(); }
+		Timestamp timestamp(size_t idx) const { return startTs + idx * interval; }
+		const NumericValue* sample(size_t idx) const { return &values[idx * VALUE_CNT]; }
+		NumericValue value(size_t idx, size_t component) const { return values[idx * VALUE_CNT + component]; }
+	};
+
+	namespace _internal {
+
+		/** Amount of grid points of the resampled signal */
+		size_t resampledSampleCnt(Timestamp firstTs, Timestamp lastTs, Timestamp startTs, Timestamp interval);
+
+		/** out[c] = sum_k weights[k] * samples[k][c] for all c in [0, cnt) */
+		template<size_t N, typename TValue>
+		inline void weightedSum(const TValue* const (&samples)[N], const TValue (&weights)[N], TValue* out, size_t cnt) {
+			for(size_t c = 0; c < cnt; ++c) {
+				TValue acc = weights[0] * samples[0][c];
+				for(size_t k = 1; k < N; ++k) { acc += weights[k] * samples[k][c]; }
+				out[c] = acc;
+			}
+		}
+
+	#if defined(__SSE2__) || defined(_M_X64)
+		template<size_t N>
+		inline void weightedSum(const float* const (&samples)[N], const float (&weights)[N], float* out, size_t cnt) {
+			size_t c = 0;
+		#if defined(__AVX__)
+			__m256 w8[N];
+			for(size_t k = 0; k < N; ++k) { w8[k] = _mm256_set1_ps(weights[k]); }
+			for(; c + 8 <= cnt; c += 8) {
+				__m256 acc = _mm256_mul_ps(w8[0], _mm256_loadu_ps(samples[0] + c));
+				for(size_t k = 1; k < N; ++k) { acc = _mm256_add_ps(acc, _mm256_mul_ps(w8[k], _mm256_loadu_ps(samples[k] + c))); }
+				_mm256_storeu_ps(out + c, acc);
+			}
+		#endif
+			__m128 w4[N];
+			for(size_t k = 0; k < N; ++k) { w4[k] = _mm_set1_ps(weights[k]); }
+			for(; c + 4 <= cnt; c += 4) {
+				__m128 acc = _mm_mul_ps(w4[0], _mm_loadu_ps(samples[0] + c));
+				for(size_t k = 1; k < N; ++k) { acc = _mm_add_ps(acc, _mm_mul_ps(w4[k], _mm_loadu_ps(samples[k] + c))); }
+				_mm_storeu_ps(out + c, acc);
+			}
+			if(c < cnt) { // remaining 1-3 values (e.g. all of XYZ) through a padded buffer, which never reads past the samples
+				alignas(16) float padded[N][4] = {};
+				alignas(16) float result[4];
+				for(size_t k = 0; k < N; ++k) { std::memcpy(padded[k], samples[k] + c, (cnt - c) * sizeof(float)); }
+				__m128 acc = _mm_mul_ps(w4[0], _mm_load_ps(padded[0]));
+				for(size_t k = 1; k < N; ++k) { acc = _mm_add_ps(acc, _mm_mul_ps(w4[k], _mm_load_ps(padded[k]))); }
+				_mm_store_ps(result, acc);
+				std::memcpy(out + c, result, (cnt - c) * sizeof(float));
+			}
+		}
+
+		template<size_t N>
+		inline void weightedSum(const double* const (&samples)[N], const double (&weights)[N], double* out, size_t cnt) {
+			size_t c = 0;
+		#if defined(__AVX__)
+			__m256d w4[N];
+			for(size_t k = 0; k < N; ++k) { w4[k] = _mm256_set1_pd(weights[k]); }
+			for(; c + 4 <= cnt; c += 4) {
+				__m256d acc = _mm256_mul_pd(w4[0], _mm256_loadu_pd(samples[0] + c));
+				for(size_t k = 1; k < N; ++k) { acc = _mm256_add_pd(acc, _mm256_mul_pd(w4[k], _mm256_loadu_pd(samples[k] + c))); }
+				_mm256_storeu_pd(out + c, acc);
+			}
+		#endif
+			__m128d w2[N];
+			for(size_t k = 0; k < N; ++k) { w2[k] = _mm_set1_pd(weights[k]); }
+			for(; c + 2 <= cnt; c += 2) {
+				__m128d acc = _mm_mul_pd(w2[0], _mm_loadu_pd(samples[0] + c));
+				for(size_t k = 1; k < N; ++k) { acc = _mm_add_pd(acc, _mm_mul_pd(w2[k], _mm_loadu_pd(samples[k] + c))); }
+				_mm_storeu_pd(out + c, acc);
+			}
+			if(c < cnt) {
+				double acc = weights[0] * samples[0][c];
+				for(size_t k = 1; k < N; ++k) { acc += weights[k] * samples[k][c]; }
+				out[c] = acc;
+			}
+		}
+	#endif
+
+		/**
+		 * @brief Resample the grid points [outBegin, outEnd) of a signal with valueCnt interleaved values per sample.
+		 * @details out points to the start of the entire output (grid point 0).
+		 */
+		template<typename TValue>
+		void resampleRange(const Timestamp* timestamps, const TValue* values, size_t sampleCnt, size_t valueCnt,
+				Timestamp startTs, Timestamp interval, Interpolation interpolation, size_t outBegin, size_t outEnd, TValue* out) {
+			static_assert(std::is_floating_point_v<TValue>, "Only floating point signals can be interpolated");
+			if(outBegin >= outEnd) { return; }
+			// index of the last sample with a timestamp <= the first grid point
+			size_t j = std::upper_bound(timestamps, timestamps + sampleCnt, startTs + outBegin * interval) - timestamps - 1;
+			for(size_t i = outBegin; i < outEnd; ++i) {
+				const Timestamp ts = startTs + i * interval;
+				while(j + 1 < sampleCnt && timestamps[j + 1] <= ts) { ++j; }
+				TValue* outSample = out + i * valueCnt;
+				if(timestamps[j] == ts) {
+					std::copy_n(values + j * valueCnt, valueCnt, outSample);
+					continue;
+				}
+				// timestamps[j] < ts < timestamps[j + 1]
+				const double h = static_cast<double>(timestamps[j + 1] - timestamps[j]);
+				const double s = static_cast<double>(ts - timestamps[j]) / h;
+				const TValue* p0 = values + j * valueCnt;
+				const TValue* p1 = p0 + valueCnt;
+				if(interpolation == Interpolation::Linear) {
+					const TValue* const samples[2] = { p0, p1 };
+					const TValue weights[2] = { static_cast<TValue>(1.0 - s), static_cast<TValue>(s) };
+					weightedSum(samples, weights, outSample, valueCnt);
+				} else {
+					// Hermite basis, tangents m0 = (p1 - pm) / (t1 - tm) and m1 = (p2 - p0) / (t2 - t0), one-sided at the borders
+					const size_t m = (j > 0) ? (j - 1) : j;
+					const size_t n = (j + 2 < sampleCnt) ? (j + 2) : (j + 1);
+					const double s2 = s * s, s3 = s2 * s;
+					const double h00 = 2 * s3 - 3 * s2 + 1, h10 = s3 - 2 * s2 + s, h01 = -2 * s3 + 3 * s2, h11 = s3 - s2;
+					const double c0 = h10 * h / static_cast<double>(timestamps[j + 1] - timestamps[m]);
+					const double c1 = h11 * h / static_cast<double>(timestamps[n] - timestamps[j]);
+					const TValue* const samples[4] = { values + m * valueCnt, p0, p1, values + n * valueCnt };
+					const TValue weights[4] = { static_cast<TValue>(-c0), static_cast<TValue>(h00 - c1), static_cast<TValue>(h01 + c0), static_cast<TValue>(c1) };
+					weightedSum(samples, weights, outSample, valueCnt);
+				}
+			}
+		}
+
+		/** Collect the tasks of resampling the first sampleCnt grid points of channel into result */
+		template<typename TEvent>
+		void planResample(const NumericChannel<TEvent>& channel, Timestamp startTs, Timestamp interval, size_t sampleCnt,
+				const ResampleOptions& options, ResampledChannel<TEvent>& result, std::vector<std::function<void()>>& tasks) {
+			exceptAssert(std::is_sorted(channel.timestamps.begin(), channel.timestamps.end()), "Timestamps of resampled signals have to be sorted");
+			result.startTs = startTs;
+			result.interval = interval;
+			result.values.resize(sampleCnt * TEvent::VALUE_CNT);
+			const size_t blockSampleCnt = std::max<size_t>(options.blockSampleCnt, 1);
+			for(size_t begin = 0; begin < sampleCnt; begin += blockSampleCnt) {
+				size_t end = std::min(begin + blockSampleCnt, sampleCnt);
+				tasks.push_back([&channel, &result, startTs, interval, begin, end, interpolation = options.interpolation]() {
+					resampleRange(channel.timestamps.data(), channel.values.data(), channel.size(), TEvent::VALUE_CNT,
+							startTs, interval, interpolation, begin, end, result.values.data());
+				});
+			}
+		}
+
+		void runTasks(const std::vector<std::function<void()>>& tasks, size_t threadCnt);
+	}
+
+	/** Resample a single channel to the grid startTs + i * interval */
+	template<typename TEvent>
+	ResampledChannel<TEvent> resample(const NumericChannel<TEvent>& channel, Timestamp startTs, Timestamp interval, const ResampleOptions& options = {}) {
+		ResampledChannel<TEvent> result;
+		if(channel.empty()) { return result; }
+		size_t sampleCnt = _internal::resampledSampleCnt(channel.timestamps.front(), channel.timestamps.back(), startTs, interval);
+		std::vector<std::function<void()>> tasks;
+		_internal::planResample(channel, startTs, interval, sampleCnt, options, result, tasks);
+		_internal::runTasks(tasks, options.threadCnt);
+		return result;
+	}
+
+
+	// ###########
+	// # ResampledRecording
+	// ######################
+
+	/**
+	 * @brief All floating point numeric channels of a recording, resampled to one common grid.
+	 * @details Like resampleIntoDataContainer() of the Octave TimestampedRecordingContainer, all channels start at the
+	 * same timestamp and are cut to the same amount of samples. Empty channels, and channels with integer values, stay empty.
+	 */
+	class ResampledRecording {
+	public: // Associated types
+		#define SENSORREADOUT_RESAMPLED_CHANNEL_TYPE(EvtType, EvtStruct) std::tuple<ResampledChannel<EvtStruct>>(),
+		using ResampledChannels = decltype(std::tuple_cat(SENSORREADOUT_NUMERIC_EVENTS(SENSORREADOUT_RESAMPLED_CHANNEL_TYPE) std::tuple<>()));
+		#undef SENSORREADOUT_RESAMPLED_CHANNEL_TYPE
+
+	private:
+		ResampledChannels channels;
+		Timestamp startTs = 0;
+		Timestamp interval = 0;
+		size_t sampleCnt = 0;
+
+	public:
+		/** Resample starting at the latest first timestamp of all resampled channels */
+		static ResampledRecording resample(const ColumnarRecording& recording, Timestamp interval, const ResampleOptions& options = {});
+		static ResampledRecording resample(const ColumnarRecording& recording, Timestamp startTs, Timestamp interval, const ResampleOptions& options = {});
+
+		template<typename TEvent> const ResampledChannel<TEvent>& channel() const { return std::get<ResampledChannel<TEvent>>(channels); }
+
+		Timestamp getStartTimestamp() const { return startTs; }
+		Timestamp getInterval() const { return interval; }
+		size_t size() const { return sampleCnt; }
+		Timestamp timestamp(size_t idx) const { return startTs + idx * interval; }
+	};
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <bitset>
 #include <charconv>
 #include <cinttypes>
 #include <cstring>
@@ -9,9 +10,11 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
+#include "HexCodec.h"
 #include "Tokenizer.h"
 
 inline std::ostream& operator<<(std::ostream& os, const std::vector<float>& vec) {
@@ -62,6 +65,11 @@ namespace SensorReadoutParser {
 	/// \brief Primitive type used to represent the frequency channel a wifi advertisement was sent on.
 	///
 	using WifiFrequency = uint32_t;
+	///
+	/// \brief Dense id of a MacAddress, assigned by a MacDictionary in the order of first occurrence.
+	///
+	using MacId = uint32_t;
+	inline constexpr MacId INVALID_MAC_ID = UINT32_MAX;
 
 	struct RawSensorEvent {
 		Timestamp timestamp = 0;
@@ -69,6 +77,23 @@ namespace SensorReadoutParser {
 		std::string parameterString;
 	};
 
+	///
+	/// \brief Non-owning variant of RawSensorEvent.
+	/// The parameterString points into the buffer the event was parsed from, and is
+	/// only valid as long as this buffer lives.
+	///
+	struct RawSensorEventView {
+		Timestamp timestamp = 0;
+		EventId eventId = 0;
+		std::string_view parameterString;
+
+		RawSensorEventView() = default;
+		RawSensorEventView(Timestamp timestamp, EventId eventId, std::string_view parameterString)
+			: timestamp(timestamp), eventId(eventId), parameterString(parameterString) {}
+		RawSensorEventView(const RawSensorEvent& rawEvent)
+			: timestamp(rawEvent.timestamp), eventId(rawEvent.eventId), parameterString(rawEvent.parameterString) {}
+	};
+
 	struct MacAddress {
 	public: // Associated Types & Constants
 		static constexpr size_t MAC_LENGTH = 6;
@@ -87,14 +112,27 @@ namespace SensorReadoutParser {
 
 		std::string toString() const;
 		std::string toColonDelimitedString() const;
+		/** The 48 bit address as integer, first byte most significant */
+		uint64_t toUInt64() const {
+			uint64_t result = 0;
+			for(size_t i = 0; i < MAC_LENGTH; ++i) { result = (result << 8) | mac[i]; }
+			return result;
+		}
+		/** Fibonacci hashing of toUInt64(), the upper bits are the best distributed ones */
+		size_t hash() const {
+			uint64_t hash = toUInt64() * 0x9E3779B97F4A7C15ull;
+			return static_cast<size_t>(hash ^ (hash >> 32));
+		}
 
-		bool operator==(const MacAddress& o);
+		bool operator==(const MacAddress& o) const;
 	};
 
 	struct WifiAdvertisement {
 		MacAddress mac;
 		Rssi rssi;
 		WifiFrequency channelFreq;
+		/** Id of mac, only set when parsing with a MacDictionary */
+		MacId macId = INVALID_MAC_ID;
 	};
 
 	struct DecawaveUWBMeasurement {
@@ -118,19 +156,65 @@ namespace SensorReadoutParser {
 
 	namespace _internal {
 
+		///
+		/// \brief Assembles the ';'-separated parameterString of an event into a reusable buffer.
+		/// Numbers are formatted with std::to_chars, floating point values in their shortest round-trip representation.
+		///
 		class ParameterAssembler {
 		private:
-			std::ostringstream stream;
+			std::string buffer;
+			size_t fieldCnt = 0;
+
+			template<typename TNumber>
+			void appendNumber(TNumber value) {
+				char numberBuffer[64];
+			#ifdef ANDROID // NDK26 will have to_chars, everything before... is missing to_chars<float> and to_chars<double>
+				if constexpr(std::is_floating_point_v<TNumber>) {
+					int len = std::snprintf(numberBuffer, sizeof(numberBuffer), std::is_same_v<TNumber, float> ? "%.9g" : "%.17g", value);
+					buffer.append(numberBuffer, len);
+					return;
+				}
+			#endif
+				auto [ptr, ec] = std::to_chars(numberBuffer, numberBuffer + sizeof(numberBuffer), value);
+				buffer.append(numberBuffer, ptr);
+			}
+
+			template<typename TValue>
+			void append(const TValue& value) {
+				if constexpr(std::is_same_v<TValue, bool>) {
+					buffer.push_back(value ? '1' : '0');
+				} else if constexpr(std::is_arithmetic_v<TValue>) {
+					appendNumber(value);
+				} else if constexpr(std::is_convertible_v<const TValue&, std::string_view>) {
+					buffer.append(std::string_view(value));
+				} else if constexpr(std::is_same_v<TValue, HexString>) {
+					size_t offset = buffer.size();
+					buffer.resize(offset + value.data.size() * 2);
+					HexCodec::encode(value.data.data(), value.data.size(), &buffer[offset]);
+				} else if constexpr(std::is_same_v<TValue, std::vector<float>>) {
+					buffer.push_back('[');
+					for (size_t i = 0; i < value.size(); ++i) {
+						if (i > 0) { buffer.append(", "); }
+						appendNumber(value[i]);
+					}
+					buffer.push_back(']');
+				} else {
+					static_assert(!sizeof(TValue), "Unsupported parameter type");
+				}
+			}
 
 		public:
-			ParameterAssembler() { stream.precision(15); }
 			template<typename TValue>
-			void push(TValue value) {
-				if (stream.tellp() > 0) { stream << ';'; }
-				stream << value;
+			void push(const TValue& value) {
+				if (fieldCnt++ > 0) { buffer.push_back(';'); }
+				append(value);
 			}
 
-			std::string str() const;
+			/** Reset for the next event, keeping the allocated buffer */
+			void clear() { buffer.clear(); fieldCnt = 0; }
+
+			std::string_view view() const { return buffer; }
+			std::string str() const { return buffer; }
 		};
 
 	} // namespace _internal
@@ -216,6 +300,37 @@ namespace SensorReadoutParser {
 		RecordingId = EVENTID_RECORDING_ID
 	};
 
+	///
+	/// \brief Set of accepted EventTypes, that can be checked directly on a raw EventId.
+	/// Used by the parsers to skip events of unwanted types before their parameters are decoded.
+	///
+	class EventTypeFilter {
+	private:
+		static constexpr EventId MIN_EVENTID = EVENTID_RECORDING_ID;
+		static constexpr EventId MAX_EVENTID = EVENTID_PREDICTED_POS;
+		std::bitset<MAX_EVENTID - MIN_EVENTID + 1> accepted;
+
+	public:
+		EventTypeFilter() = default;
+		EventTypeFilter(std::initializer_list<EventType> eventTypes) {
+			for(EventType eventType : eventTypes) { add(eventType); }
+		}
+		template<typename TIterator>
+		EventTypeFilter(TIterator begin, TIterator end) {
+			for(; begin != end; ++begin) { add(*begin); }
+		}
+
+		void add(EventType eventType) { accepted.set(static_cast<EventId>(eventType) - MIN_EVENTID); }
+		void remove(EventType eventType) { accepted.reset(static_cast<EventId>(eventType) - MIN_EVENTID); }
+
+		bool accepts(EventId eventId) const {
+			return (eventId >= MIN_EVENTID && eventId <= MAX_EVENTID && accepted.test(eventId - MIN_EVENTID));
+		}
+		bool accepts(EventType eventType) const { return accepts(static_cast<EventId>(eventType)); }
+
+		bool operator==(const EventTypeFilter& o) const = default;
+	};
+
 	enum class PedestrianActivity : PedestrianActivityId {
 		Walking = 0,
 		Standing = 1,
@@ -234,6 +349,7 @@ namespace SensorReadoutParser {
 	template<const size_t ARG_CNT = 1, typename TNumericValue = float>
 	struct NumericSensorEventBase {
 		using NumericValue = TNumericValue;
+		static constexpr size_t VALUE_CNT = ARG_CNT;
 
 		// static_assert (sizeof(Self) == (sizeof(NumericValue) * ARG_CNT), "Struct size and argument count do not match.");
 
@@ -248,12 +364,17 @@ namespace SensorReadoutParser {
 			return valuePtr[ARGIDX];
 		}
 
-		void parse(const std::string& parameterString) {
-			NumericValue* resultPtr = reinterpret_cast<NumericValue*>(this);
+		/** Parse the ARG_CNT values of the given parameterString into resultPtr */
+		static void parseInto(const std::string_view& parameterString, NumericValue* resultPtr) {
 			Tokenizer<';'> tokenizer(parameterString);
 			for (size_t i = 0; i < ARG_CNT; ++i) {
 				resultPtr[i] = tokenizer.nextAs<NumericValue>();
 			}
+			exceptAssert(tokenizer.isEOS(), "Numeric event has more parameters than expected");
+		}
+
+		void parse(const std::string_view& parameterString) {
+			parseInto(parameterString, reinterpret_cast<NumericValue*>(this));
 		}
 
 		void serializeInto(_internal::ParameterAssembler& stream) const {
@@ -292,7 +413,9 @@ namespace SensorReadoutParser {
 	struct WifiEvent {
 		std::vector<WifiAdvertisement> advertisements;
 
-		void parse(const std::string& parameterString);
+		/** Parse all advertisements of the given parameterString and append them to result */
+		static void parseAdvertisements(const std::string_view& parameterString, std::vector<WifiAdvertisement>& result);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct BLEEvent {
@@ -301,8 +424,10 @@ namespace SensorReadoutParser {
 		BluetoothTxPower txPower;
 		/** The entire advertisement packet as raw bytes */
 		std::vector<uint8_t> rawData;
+		/** Id of mac, only set when parsing with a MacDictionary */
+		MacId macId = INVALID_MAC_ID;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct RelativeHumidityEvent : public NumericSensorEventBase<1> {
@@ -340,8 +465,10 @@ namespace SensorReadoutParser {
 		Rssi rssi;
 		size_t numAttempted;
 		size_t numSuccessfull;
+		/** Id of mac, only set when parsing with a MacDictionary */
+		MacId macId = INVALID_MAC_ID;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct GameRotationVectorEvent : public XYZSensorEventBase {};
@@ -350,8 +477,10 @@ namespace SensorReadoutParser {
 		Rssi rssi;
 		BluetoothTxPower txPower;
 		UUID uid;
+		/** Id of mac, only set when parsing with a MacDictionary */
+		MacId macId = INVALID_MAC_ID;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct DecawaveUWBEvent {
@@ -361,7 +490,7 @@ namespace SensorReadoutParser {
 		uint8_t qualityFactor;
 		std::vector<DecawaveUWBMeasurement> anchorMeasurements;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct StepDetectorEvent {
@@ -369,7 +498,7 @@ namespace SensorReadoutParser {
 		Timestamp stepEndTs;
 		float probability;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct HeadingChangeEvent : public NumericSensorEventBase<1, double> {
@@ -381,7 +510,7 @@ namespace SensorReadoutParser {
 		uint8_t y;
 		std::array<uint8_t, 8> fieldCapacities;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct MicrophoneMetadataEvent {
@@ -389,7 +518,7 @@ namespace SensorReadoutParser {
 		size_t sampleRateHz;
 		std::string sampleFormat;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct StepProbabilityEvent {
@@ -397,7 +526,7 @@ namespace SensorReadoutParser {
 		size_t id;
 		float probability;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct CIR5GEvent {
@@ -405,7 +534,7 @@ namespace SensorReadoutParser {
 		std::vector<float> real;
 		std::vector<float> imag;
 
-		void parse(const std::string& prameterString);
+		void parse(const std::string_view& prameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 
@@ -432,7 +561,7 @@ namespace SensorReadoutParser {
 			return result;
 		}
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct GroundTruthEvent : public NumericSensorEventBase<1, size_t> {
@@ -444,14 +573,14 @@ namespace SensorReadoutParser {
 		float z;
 		size_t floorIdx;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct GroundTruthPathEvent {
 		std::string pathId;
 		size_t groundTruthPointCnt;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	
@@ -460,16 +589,56 @@ namespace SensorReadoutParser {
 		std::string person;
 		std::string comment;
 
-		void parse(const std::string& parameterString);
+		void parse(const std::string_view& parameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 	struct RecordingIdEvent {
 		UUID recordingId;
 
-		void parse(const std::string& prameterString);
+		void parse(const std::string_view& prameterString);
 		void serializeInto(_internal::ParameterAssembler& stream) const;
 	};
 
+	/** X-Macro listing all EventTypes whose events derive from NumericSensorEventBase */
+	#define SENSORREADOUT_NUMERIC_EVENTS(X) \
+		X(EventType::Accelerometer, AccelerometerEvent) \
+		X(EventType::Gravity, GravityEvent) \
+		X(EventType::LinearAcceleration, LinearAccelerationEvent) \
+		X(EventType::Gyroscope, GyroscopeEvent) \
+		X(EventType::MagneticField, MagneticFieldEvent) \
+		X(EventType::Pressure, PressureEvent) \
+		X(EventType::Orientation, OrientationEvent) \
+		X(EventType::RotationMatrix, RotationMatrixEvent) \
+		X(EventType::RelativeHumidity, RelativeHumidityEvent) \
+		X(EventType::OrientationOld, OrientationOldEvent) \
+		X(EventType::RotationVector, RotationVectorEvent) \
+		X(EventType::Light, LightEvent) \
+		X(EventType::AmbientTemperature, AmbientTemperatureEvent) \
+		X(EventType::HeartRate, HeartRateEvent) \
+		X(EventType::GPS, GPSEvent) \
+		X(EventType::GameRotationVector, GameRotationVectorEvent) \
+		X(EventType::HeadingChange, HeadingChangeEvent) \
+		X(EventType::GroundTruth, GroundTruthEvent)
+
+	/** X-Macro listing all EventTypes whose events have a variable layout, i.e. that do not derive from NumericSensorEventBase */
+	#define SENSORREADOUT_VARIABLE_EVENTS(X) \
+		X(EventType::Wifi, WifiEvent) \
+		X(EventType::BLE, BLEEvent) \
+		X(EventType::WifiRTT, WifiRTTEvent) \
+		X(EventType::EddystoneUID, EddystoneUIDEvent) \
+		X(EventType::DecawaveUWB, DecawaveUWBEvent) \
+		X(EventType::StepDetector, StepDetectorEvent) \
+		X(EventType::FutureShapeSensFloor, FutureShapeSensFloorEvent) \
+		X(EventType::MicrophoneMetadata, MicrophoneMetadataEvent) \
+		X(EventType::StepProbability, StepProbabilityEvent) \
+		X(EventType::CIR5G, CIR5GEvent) \
+		X(EventType::PedestrianActivity, PedestrianActivityEvent) \
+		X(EventType::GroundTruthPos, PosEvent) \
+		X(EventType::PredictedPos, PosEvent) \
+		X(EventType::GroundTruthPath, GroundTruthPathEvent) \
+		X(EventType::FileMetadata, FileMetadataEvent) \
+		X(EventType::RecordingId, RecordingIdEvent)
+
 
 	using EventData = std::variant<
 		AccelerometerEvent, GravityEvent, LinearAccelerationEvent, GyroscopeEvent, MagneticFieldEvent, PressureEvent, OrientationEvent, RotationMatrixEvent,
@@ -483,8 +652,11 @@ namespace SensorReadoutParser {
 		EventType eventType;
 		EventData data;
 
+		static SensorEvent parse(const RawSensorEventView& rawEvent);
 		static SensorEvent parse(const RawSensorEvent& rawEvent);
 		void serializeInto(RawSensorEvent& rawEvent) const;
+		/** Append only the parameters of this event to the given assembler */
+		void serializeParametersInto(_internal::ParameterAssembler& parameters) const;
 	};
 
 	enum class FileVersion {
@@ -494,6 +666,19 @@ namespace SensorReadoutParser {
 		V1
 	};
 
+	namespace _internal {
+		/**
+		 * @brief Split a single line (without its trailing newline) into timestamp, eventId and parameters.
+		 * @details The resulting parameterString points into the given line.
+		 */
+		void parseEventLine(const std::string_view& line, FileVersion fileVersion, RawSensorEventView& sensorEvent);
+		/**
+		 * @brief Same as parseEventLine(), but with already known positions of the first two ';' separators within the line.
+		 * @details Missing separators are passed as std::string_view::npos.
+		 */
+		void parseEventLine(const std::string_view& line, size_t timestampSepIdx, size_t eventIdSepIdx, FileVersion fileVersion, RawSensorEventView& sensorEvent);
+	}
+
 
 	// ###########
 	// # VisitingParser
@@ -504,11 +689,27 @@ namespace SensorReadoutParser {
 	private: // Parser state
 		std::istream& stream;
 		FileVersion fileVersion;
+		std::string lineBuffer;
+		std::optional<EventTypeFilter> eventFilter;
 
 	public: // API-Surface
 		VisitingParser(std::istream& stream, FileVersion fileVersion = FileVersion::V1);
 
+		/**
+		 * @brief Only return events whose type is accepted by the given filter.
+		 * @details Rejected lines are skipped right after their eventId was read, their parameters are never copied.
+		 */
+		void setEventFilter(std::optional<EventTypeFilter> eventFilter) { this->eventFilter = eventFilter; }
+		const std::optional<EventTypeFilter>& getEventFilter() const { return eventFilter; }
+
 		bool nextLine(RawSensorEvent& sensorEvent);
+		/**
+		 * @brief Read a block of roughly chunkSize bytes from the stream, extended up to the next line break.
+		 * @details The resulting chunk only contains complete lines and can be parsed with MappedVisitingParser::fromBuffer.
+		 */
+		bool nextChunk(std::string& chunk, size_t chunkSize);
+
+		FileVersion getFileVersion() const { return fileVersion; }
 	};
 
 
@@ -516,6 +717,15 @@ namespace SensorReadoutParser {
 	// # AggregatingParser
 	// ######################
 
+	struct ParallelParseOptions {
+		/** Amount of worker threads (0 = use hardware concurrency) */
+		size_t threadCnt = 0;
+		/** Approximate amount of bytes per chunk. Chunks are always extended to the next line break. */
+		size_t chunkSize = 4 * 1024 * 1024;
+	};
+
+	class MacDictionary;
+
 	class AggregatingParser {
 
 	public:
@@ -524,12 +734,27 @@ namespace SensorReadoutParser {
 
 	private:
 		VisitingParser parser;
+		MacDictionary* macDictionary = nullptr;
 
 	public:
 		AggregatingParser(std::istream& stream, FileVersion fileVersion = FileVersion::V1);
 
+		/** Only parse events whose type is accepted by the given filter. Rejected events are never decoded. */
+		void setEventFilter(std::optional<EventTypeFilter> eventFilter) { parser.setEventFilter(eventFilter); }
+		/**
+		 * @brief Intern the MACs of all parsed radio events into the given dictionary, and set their macId.
+		 * @details The dictionary has to outlive the parser, and can be shared by multiple recordings. Ids are
+		 * assigned in the order of the events, also for parseParallel(). Pass nullptr to disable.
+		 */
+		void setMacDictionary(MacDictionary* macDictionary) { this->macDictionary = macDictionary; }
+
 		AggregatedParseResult parse();
 		AggregatedRawParseResult parseRaw();
+		/**
+		 * @brief Parse the stream in chunks on a pool of worker threads.
+		 * @details The result is identical to the one of parse(), including the order of events.
+		 */
+		AggregatedParseResult parseParallel(const ParallelParseOptions& options = {});
 	};
 
 
@@ -537,19 +762,41 @@ namespace SensorReadoutParser {
 	// ###########
 	// # Serializer
 	// ######################
+	/**
+	 * @brief Serializer for SensorReadout recordings.
+	 * @details Output is collected in an internal buffer and written to the stream in large blocks.
+	 * Call flush() before writing to the underlying stream directly. The destructor flushes as well, but has to
+	 * ignore I/O errors, so call flush() explicitly before destruction to get them reported as exception.
+	 */
 	class Serializer {
 
+	public: // Associated Types & Constants
+		/** Size of the internal buffer at which it is written to the stream */
+		static constexpr size_t FLUSH_THRESHOLD = 1024 * 1024;
+
 	private: // Serializer state
 		std::ostream& stream;
 		FileVersion fileVersion;
+		std::string buffer;
+		_internal::ParameterAssembler parameterAssembler;
+
+		void writeHeader(Timestamp timestamp, EventId eventId);
+		void writeBuffer();
 
 	public:
 		Serializer(std::ostream& stream, FileVersion fileVersion = FileVersion::V1);
 		~Serializer();
 
 		void write(const RawSensorEvent& sensorEvent);
+		void write(const RawSensorEventView& sensorEvent);
 		void write(const SensorEvent& sensorEvent);
 
+		/** Write the buffered output to the stream and flush it. Throws std::runtime_error on I/O errors. */
 		void flush();
 	};
 } // namespace SensorReadoutParser
+
+template<>
+struct std::hash<SensorReadoutParser::MacAddress> {
+	size_t operator()(const SensorReadoutParser::MacAddress& mac) const noexcept { return mac.hash(); }
+};
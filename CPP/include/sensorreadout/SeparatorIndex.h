@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+	#include <immintrin.h>
+#endif
+
+namespace SensorReadoutParser {
+
+	namespace _internal {
+
+		static constexpr size_t SCAN_WIDTH = 64;
+
+		/**
+		 * @brief Scan a window of up to 64 bytes for two characters at once.
+		 * @details Bit i of the resulting masks is set if data[i] equals the respective character.
+		 * Windows shorter than 64 bytes are copied into a padded buffer, so this never reads past data + len.
+		 */
+		inline void matchMasks64(const char* data, size_t len, char a, char b, uint64_t& maskA, uint64_t& maskB) {
+			alignas(SCAN_WIDTH) char padded[SCAN_WIDTH];
+			if(len < SCAN_WIDTH) {
+				std::memset(padded, 0, SCAN_WIDTH);
+				std::memcpy(padded, data, len);
+				data = padded;
+			}
+		#if defined(__AVX2__)
+			const __m256i va = _mm256_set1_epi8(a);
+			const __m256i vb = _mm256_set1_epi8(b);
+			const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+			const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+			maskA = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, va)))
+				| (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, va)))) << 32);
+			maskB = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, vb)))
+				| (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, vb)))) << 32);
+		#elif defined(__SSE2__) || defined(_M_X64)
+			const __m128i va = _mm_set1_epi8(a);
+			const __m128i vb = _mm_set1_epi8(b);
+			maskA = 0; maskB = 0;
+			for(size_t i = 0; i < SCAN_WIDTH / 16; ++i) {
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16));
+				maskA |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, va)))) << (i * 16);
+				maskB |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vb)))) << (i * 16);
+			}
+		#else
+			maskA = 0; maskB = 0;
+			for(size_t i = 0; i < SCAN_WIDTH; ++i) {
+				maskA |= static_cast<uint64_t>(data[i] == a) << i;
+				maskB |= static_cast<uint64_t>(data[i] == b) << i;
+			}
+		#endif
+			if(len < SCAN_WIDTH) { // the padding might contain matches if a or b is '\0'
+				const uint64_t validMask = (static_cast<uint64_t>(1) << len) - 1;
+				maskA &= validMask;
+				maskB &= validMask;
+			}
+		}
+
+		inline uint64_t matchMask64(const char* data, size_t len, char c) {
+			uint64_t mask, unused;
+			matchMasks64(data, len, c, c, mask, unused);
+			return mask;
+		}
+
+		/** Find the first set bit at or after bit position from within a sequence of 64bit masks */
+		inline size_t nextSetBit(const std::vector<uint64_t>& masks, size_t from) {
+			size_t wordIdx = from / SCAN_WIDTH;
+			if(wordIdx >= masks.size()) { return std::string_view::npos; }
+			uint64_t word = masks[wordIdx] & (~static_cast<uint64_t>(0) << (from % SCAN_WIDTH));
+			while(word == 0) {
+				if(++wordIdx == masks.size()) { return std::string_view::npos; }
+				word = masks[wordIdx];
+			}
+			return wordIdx * SCAN_WIDTH + std::countr_zero(word);
+		}
+
+	}
+
+
+	// ###########
+	// # SeparatorIndex
+	// ######################
+
+	/**
+	 * @brief Index over all field (';') and line ('\n') separators of a block of a recording.
+	 * @details The index is computed in one vectorized pass over the block and stores one bit per byte
+	 * and separator type. Lookups then only have to scan the (32x smaller) bitmasks.
+	 */
+	class SeparatorIndex {
+	private:
+		std::string_view block;
+		std::vector<uint64_t> fieldMasks;
+		std::vector<uint64_t> lineMasks;
+
+	public:
+		SeparatorIndex() = default;
+		explicit SeparatorIndex(std::string_view block) { build(block); }
+
+		/** (Re-)build the index over the given block. Previously allocated storage is reused. */
+		void build(std::string_view block) {
+			this->block = block;
+			size_t wordCnt = (block.size() + _internal::SCAN_WIDTH - 1) / _internal::SCAN_WIDTH;
+			fieldMasks.resize(wordCnt);
+			lineMasks.resize(wordCnt);
+			for(size_t i = 0; i < wordCnt; ++i) {
+				size_t offset = i * _internal::SCAN_WIDTH;
+				_internal::matchMasks64(block.data() + offset, std::min(_internal::SCAN_WIDTH, block.size() - offset),
+						';', '\n', fieldMasks[i], lineMasks[i]);
+			}
+		}
+
+		/** Position of the next ';' at or after pos, relative to the block. npos if there is none. */
+		size_t nextFieldSeparator(size_t pos) const { return _internal::nextSetBit(fieldMasks, pos); }
+		/** Position of the next '\n' at or after pos, relative to the block. npos if there is none. */
+		size_t nextLineSeparator(size_t pos) const { return _internal::nextSetBit(lineMasks, pos); }
+
+		std::string_view data() const { return block; }
+		size_t size() const { return block.size(); }
+	};
+
+}
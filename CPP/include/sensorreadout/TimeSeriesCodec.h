@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "ColumnarRecording.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # Time Series Format
+	// ######################
+	//
+	// A time series file starts with an 8 byte header:
+	//   char[4] magic ("SRTS") | uint16 formatVersion | uint16 byteOrderMark (0x0102)
+	// followed by independently decodable blocks, each holding up to blockSampleCnt samples of one numeric channel:
+	//   int32 eventId | uint32 sampleCnt | uint32 timestampByteCnt | uint32 valueByteCnt | timestamps | values
+	// Timestamps are stored as LEB128 varints: the first one verbatim, the second as zigzag encoded delta,
+	// and all following ones as zigzag encoded delta-of-delta, which is 0 (one byte) for a constant sampling rate.
+	// Values are stored component by component, each component as Gorilla XOR compressed bit stream: the first value
+	// verbatim, then a 0 bit for unchanged values, 10 + meaningful bits if the XOR with the previous value fits
+	// into the previous window of meaningful bits, or 11 + leading zero count + meaningful bit count + meaningful bits.
+
+	namespace _internal {
+		constexpr std::string_view TIME_SERIES_MAGIC = "SRTS";
+		constexpr uint16_t TIME_SERIES_FORMAT_VERSION = 1;
+		constexpr uint16_t TIME_SERIES_BYTE_ORDER_MARK = 0x0102;
+		constexpr size_t TIME_SERIES_FILE_HEADER_SIZE = 8;
+		constexpr size_t TIME_SERIES_BLOCK_HEADER_SIZE = sizeof(EventId) + 3 * sizeof(uint32_t);
+
+		/** LSB-first bit stream writer */
+		class BitWriter {
+		private:
+			std::string& output;
+			uint64_t accumulator = 0;
+			unsigned accumulatorBits = 0;
+
+		public:
+			BitWriter(std::string& output) : output(output) {}
+
+			/** Append the lowest bitCnt (<= 64) bits of value */
+			void write(uint64_t value, unsigned bitCnt) {
+				if(bitCnt == 0) { return; }
+				if(bitCnt < 64) { value &= (static_cast<uint64_t>(1) << bitCnt) - 1; }
+				accumulator |= value << accumulatorBits;
+				if(accumulatorBits + bitCnt >= 64) {
+					output.append(reinterpret_cast<const char*>(&accumulator), sizeof(accumulator));
+					unsigned consumedBits = 64 - accumulatorBits;
+					accumulator = (consumedBits < 64) ? (value >> consumedBits) : 0;
+					accumulatorBits = accumulatorBits + bitCnt - 64;
+				} else {
+					accumulatorBits += bitCnt;
+				}
+			}
+			/** Write the remaining bits, padded to full bytes */
+			void finish() {
+				output.append(reinterpret_cast<const char*>(&accumulator), (accumulatorBits + 7) / 8);
+				accumulator = 0;
+				accumulatorBits = 0;
+			}
+		};
+
+		/** LSB-first bit stream reader, counterpart of the BitWriter */
+		class BitReader {
+		private:
+			std::string_view input;
+			size_t bitPtr = 0;
+
+			uint64_t readWord(size_t bytePtr) const {
+				uint64_t word = 0;
+				std::memcpy(&word, input.data() + bytePtr, std::min<size_t>(sizeof(word), input.size() - bytePtr));
+				return word;
+			}
+
+		public:
+			BitReader(std::string_view input) : input(input) {}
+
+			/** Read the next bitCnt (<= 64) bits */
+			uint64_t read(unsigned bitCnt) {
+				if(bitCnt == 0) { return 0; }
+				exceptAssert(bitPtr + bitCnt <= input.size() * 8, "Truncated time series block");
+				if(bitCnt > 56) { // a single unaligned word read covers at most 57 bits
+					uint64_t low = read(32);
+					return low | (read(bitCnt - 32) << 32);
+				}
+				uint64_t result = readWord(bitPtr / 8) >> (bitPtr % 8);
+				bitPtr += bitCnt;
+				return result & ((static_cast<uint64_t>(1) << bitCnt) - 1);
+			}
+		};
+
+		void writeVarint(std::string& output, uint64_t value);
+		uint64_t readVarint(std::string_view input, size_t& ptr);
+		inline uint64_t zigzagEncode(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+		inline int64_t zigzagDecode(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+		/** Unsigned integer type with the size of TValue, used to XOR values bitwise */
+		template<typename TValue>
+		using XorBits = std::conditional_t<sizeof(TValue) == 4, uint32_t, uint64_t>;
+
+		/** Gorilla XOR encoding of the component-th value of cnt interleaved samples with stride values each */
+		template<typename TValue>
+		void encodeXorSeries(BitWriter& writer, const TValue* values, size_t cnt, size_t stride) {
+			using Bits = XorBits<TValue>;
+			constexpr unsigned BITS = sizeof(Bits) * 8;
+			constexpr unsigned LEADING_BITS = (BITS == 32) ? 5 : 6;
+			if(cnt == 0) { return; }
+			Bits prev = std::bit_cast<Bits>(values[0]);
+			writer.write(prev, BITS);
+			unsigned prevLeading = BITS;
+			unsigned prevTrailing = 0;
+			for(size_t i = 1; i < cnt; ++i) {
+				Bits cur = std::bit_cast<Bits>(values[i * stride]);
+				Bits xorValue = cur ^ prev;
+				prev = cur;
+				if(xorValue == 0) {
+					writer.write(0b0, 1);
+					continue;
+				}
+				unsigned leading = std::countl_zero(xorValue);
+				unsigned trailing = std::countr_zero(xorValue);
+				if(leading >= prevLeading && trailing >= prevTrailing) { // fits into the previous window
+					writer.write(0b01, 2);
+					writer.write(xorValue >> prevTrailing, BITS - prevLeading - prevTrailing);
+				} else {
+					unsigned meaningfulBits = BITS - leading - trailing;
+					writer.write(0b11, 2);
+					writer.write(leading, LEADING_BITS);
+					writer.write(meaningfulBits - 1, LEADING_BITS);
+					writer.write(xorValue >> trailing, meaningfulBits);
+					prevLeading = leading;
+					prevTrailing = trailing;
+				}
+			}
+		}
+
+		template<typename TValue>
+		void decodeXorSeries(BitReader& reader, TValue* values, size_t cnt, size_t stride) {
+			using Bits = XorBits<TValue>;
+			constexpr unsigned BITS = sizeof(Bits) * 8;
+			constexpr unsigned LEADING_BITS = (BITS == 32) ? 5 : 6;
+			if(cnt == 0) { return; }
+			Bits prev = static_cast<Bits>(reader.read(BITS));
+			values[0] = std::bit_cast<TValue>(prev);
+			unsigned prevLeading = BITS;
+			unsigned prevTrailing = 0;
+			for(size_t i = 1; i < cnt; ++i) {
+				if(reader.read(1) != 0) {
+					if(reader.read(1) != 0) {
+						prevLeading = static_cast<unsigned>(reader.read(LEADING_BITS));
+						unsigned meaningfulBits = static_cast<unsigned>(reader.read(LEADING_BITS)) + 1;
+						exceptWhen(prevLeading + meaningfulBits > BITS, "Corrupted time series block");
+						prevTrailing = BITS - prevLeading - meaningfulBits;
+					}
+					prev ^= static_cast<Bits>(reader.read(BITS - prevLeading - prevTrailing)) << prevTrailing;
+				}
+				values[i * stride] = std::bit_cast<TValue>(prev);
+			}
+		}
+	}
+
+
+	// ###########
+	// # TimeSeriesWriter
+	// ######################
+
+	/**
+	 * @brief Writer for the compressed time series format of numeric channels.
+	 * @details Samples are collected per channel, and written as block once blockSampleCnt samples of a channel are pending.
+	 * Blocks of different channels are thereby interleaved in the output, roughly in the order of the recording.
+	 * Pending samples are written by the destructor, which ignores I/O errors. Call flush() explicitly to get them reported.
+	 */
+	class TimeSeriesWriter {
+
+	public: // Associated Types & Constants
+		static constexpr size_t DEFAULT_BLOCK_SAMPLE_CNT = 4096;
+
+	private:
+		std::ostream& stream;
+		size_t blockSampleCnt;
+		ColumnarRecording::NumericChannels pendingChannels;
+		std::string blockBuffer;
+
+		template<typename TEvent>
+		void writeBlock(EventType eventType, const NumericChannel<TEvent>& channel, size_t begin, size_t end);
+
+	public:
+		TimeSeriesWriter(std::ostream& stream, size_t blockSampleCnt = DEFAULT_BLOCK_SAMPLE_CNT);
+		~TimeSeriesWriter();
+
+		/** Add a sample of a numeric event. Returns false (and ignores the event) if its type is not numeric. */
+		bool write(const SensorEvent& sensorEvent);
+		/** Write all numeric channels of the given recording */
+		void write(const ColumnarRecording& recording);
+
+		/** Write all pending samples as (partial) blocks */
+		void flush();
+	};
+
+
+	// ###########
+	// # TimeSeriesReader
+	// ######################
+
+	/**
+	 * @brief Streaming reader for the compressed time series format.
+	 */
+	class TimeSeriesReader {
+	private:
+		std::istream& stream;
+		std::string blockBuffer;
+
+	public:
+		/** Construct a reader on the given stream and validate its file header */
+		TimeSeriesReader(std::istream& stream);
+
+		/** Decode the next block and append its samples to the corresponding channel of the given recording */
+		bool nextBlock(ColumnarRecording& recording);
+		/** Decode all (remaining) blocks into a new ColumnarRecording */
+		ColumnarRecording readAll();
+	};
+
+}
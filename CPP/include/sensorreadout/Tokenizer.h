@@ -9,6 +9,7 @@
 
 #include "Assert.h"
 #include "ParseLocaleContext.h"
+#include "SeparatorIndex.h"
 
 namespace SensorReadoutParser {
 
@@ -25,6 +26,24 @@ namespace SensorReadoutParser {
 		std::string_view str;
 		size_t ptr = 0;
 		ParseLocaleContext localeCtx;
+		// separator bitmask of the 64 byte window [maskBase, maskEnd) of str, filled lazily
+		uint64_t sepMask = 0;
+		size_t maskBase = 0;
+		size_t maskEnd = 0;
+
+		size_t findNextSeparator(size_t from) {
+			while(from < str.length()) {
+				if(from < maskBase || from >= maskEnd) { // peekNext() might have moved the window beyond ptr
+					maskBase = from;
+					maskEnd = std::min(from + _internal::SCAN_WIDTH, str.length());
+					sepMask = _internal::matchMask64(str.data() + maskBase, maskEnd - maskBase, SEPERATOR);
+				}
+				uint64_t remainingMask = sepMask & (~static_cast<uint64_t>(0) << (from - maskBase));
+				if(remainingMask != 0) { return maskBase + std::countr_zero(remainingMask); }
+				from = maskEnd;
+			}
+			return std::string::npos;
+		}
 
 	public:
 		/**
@@ -40,7 +59,7 @@ namespace SensorReadoutParser {
 		std::optional<std::string_view> peekNext() {
 			std::string_view result;
 			if(isEOS()) { return {}; }
-			auto nextSepPtr = str.find(SEPERATOR, ptr);
+			auto nextSepPtr = findNextSeparator(ptr);
 			if(nextSepPtr == std::string::npos) { // reached EOS, no further tokens
 				nextSepPtr = str.length();
 			}
@@ -50,7 +69,7 @@ namespace SensorReadoutParser {
 		std::string_view next() {
 			std::string_view result;
 			exceptAssert(!isEOS(), "Unexpected EOS");
-			auto nextSepPtr = str.find(SEPERATOR, ptr);
+			auto nextSepPtr = findNextSeparator(ptr);
 			if(nextSepPtr == std::string::npos) { // reached EOS, no further tokens
 				nextSepPtr = str.length();
 			}
@@ -82,7 +101,7 @@ namespace SensorReadoutParser {
 
 		void skipNext() {
 			exceptAssert(!isEOS(), "Unexpected EOS");
-			auto nextSepPtr = str.find(SEPERATOR, ptr);
+			auto nextSepPtr = findNextSeparator(ptr);
 			if(nextSepPtr == std::string::npos) { // reached EOS, no further tokens
 				nextSepPtr = str.length();
 			}
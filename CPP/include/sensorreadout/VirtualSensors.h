@@ -0,0 +1,204 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "SensorReadoutParser.h"
+#include "MappedVisitingParser.h"
+
+namespace SensorReadoutParser {
+
+	// ###########
+	// # VirtualSensor
+	// ######################
+
+	/**
+	 * @brief Event emitted by a VirtualSensor.
+	 * @details Values are stored inline, such that emitting an event never allocates.
+	 */
+	struct DerivedEvent {
+		static constexpr size_t MAX_VALUE_CNT = 9;
+
+		Timestamp timestamp = 0;
+		size_t valueCnt = 0;
+		std::array<float, MAX_VALUE_CNT> values = {};
+	};
+
+	/**
+	 * @brief Base of all virtual sensors, the streaming counterpart of the Octave VirtualSensorBase.
+	 * @details A virtual sensor consumes the events of a recording one by one, and emits derived events as soon as
+	 * they can be calculated. Sensors with multiple inputs keep the latest value of their secondary inputs,
+	 * and emit one event per event of their primary input.
+	 */
+	class VirtualSensor {
+	public: // Associated types
+		using Sink = std::function<void(const DerivedEvent&)>;
+
+	private:
+		size_t channelCnt;
+
+	public:
+		VirtualSensor(size_t channelCnt) : channelCnt(channelCnt) {}
+		virtual ~VirtualSensor() = default;
+
+		/** Amount of values of each emitted event */
+		size_t getChannelCnt() const { return channelCnt; }
+
+		/** Consume the next event of the recording. Derived events are passed to sink. */
+		virtual void push(const SensorEvent& evt, const Sink& sink) = 0;
+	};
+
+	namespace _internal {
+		/** Copy the values of a numeric event into values. Returns the amount of values, 0 for non-numeric events. */
+		size_t numericValues(const SensorEvent& evt, std::array<float, DerivedEvent::MAX_VALUE_CNT>& values);
+		/** Amount of values of the given event type, 0 for non-numeric event types */
+		size_t numericValueCnt(EventType eventType);
+	}
+
+
+	// ###########
+	// # Madgwick
+	// ######################
+
+	/**
+	 * @brief Madgwick's gradient descent orientation filter for accelerometer and gyroscope (port of Madgwick.m).
+	 * @details The quaternion (w, x, y, z) transforms the world coordinate system into the device's local coordinate system.
+	 */
+	class MadgwickFilter {
+	private:
+		float beta;
+		std::array<float, 4> quat = {1, 0, 0, 0};
+
+	public:
+		MadgwickFilter(float beta) : beta(beta) {}
+
+		/** Integrate one step of dtSec seconds. Gyroscope in rad/s, the accelerometer in any unit. */
+		void push(const float* accel, const float* gyro, float dtSec);
+		/** Forcefully adapt to the accelerometer readings within one step */
+		void fastStart(const float* accel, const float* gyro, float dtSec);
+
+		const std::array<float, 4>& getQuat() const { return quat; }
+		/** Rotate point by the current quaternion (q * p * q^-1), like Octave's rotatepoint */
+		void rotatePoint(const float* point, float* result) const;
+	};
+
+	/**
+	 * @brief Orientation quaternion (w, x, y, z) from Accelerometer and Gyroscope, emitted for each Gyroscope event.
+	 * @details With sampleFrequency = 0, the step size is taken from the timestamps of consecutive Gyroscope events.
+	 * The first step adapts to the accelerometer at once (see MadgwickFilter::fastStart()).
+	 */
+	class MadgwickOrientation : public VirtualSensor {
+	private:
+		MadgwickFilter filter;
+		float sampleFrequency;
+		std::array<float, DerivedEvent::MAX_VALUE_CNT> accel = {};
+		bool hasAccel = false;
+		bool started = false;
+		Timestamp lastGyroTimestamp = 0;
+		bool hasGyroTimestamp = false;
+
+	protected:
+		/** Update the filter with the given event. Returns true if the orientation was updated. */
+		bool update(const SensorEvent& evt);
+
+	public:
+		MadgwickOrientation(float beta = 0.1f, float sampleFrequency = 0) : VirtualSensor(4), filter(beta), sampleFrequency(sampleFrequency) {}
+		MadgwickOrientation(size_t channelCnt, float beta, float sampleFrequency) : VirtualSensor(channelCnt), filter(beta), sampleFrequency(sampleFrequency) {}
+
+		void push(const SensorEvent& evt, const Sink& sink) override;
+		const MadgwickFilter& getFilter() const { return filter; }
+	};
+
+	/**
+	 * @brief The 3-dimensional input sensor, rotated by the Madgwick orientation (port of MadgwickFiltered.m).
+	 * @details One event is emitted per event of the input sensor, once an orientation is available.
+	 */
+	class MadgwickFiltered : public MadgwickOrientation {
+	private:
+		EventType inputType;
+		bool hasOrientation = false;
+
+	public:
+		/** Throws std::runtime_error if inputType is not a 3-dimensional numeric sensor */
+		MadgwickFiltered(EventType inputType, float beta = 0.1f, float sampleFrequency = 0);
+
+		void push(const SensorEvent& evt, const Sink& sink) override;
+	};
+
+
+	// ###########
+	// # Features
+	// ######################
+
+	/** Euclidean norm of all values of the input sensor (port of Magnitude.m) */
+	class Magnitude : public VirtualSensor {
+	private:
+		EventType inputType;
+
+	public:
+		/** Throws std::runtime_error if inputType is not a numeric sensor */
+		Magnitude(EventType inputType);
+
+		void push(const SensorEvent& evt, const Sink& sink) override;
+	};
+
+	/**
+	 * @brief Orientation independent acceleration (port of NormalizedAccelFeature.m).
+	 * @details Emits (vertical, horizontal) for each LinearAcceleration event: the acceleration along the latest Gravity vector,
+	 * and the magnitude of the acceleration perpendicular to it. With filterOrder > 1, the acceleration is smoothed by a
+	 * moving mean over the last filterOrder samples. Unlike Octave's centered movmean, this filter is causal.
+	 */
+	class NormalizedAccel : public VirtualSensor {
+	private:
+		std::vector<std::array<float, 3>> filterWindow;
+		std::array<double, 3> filterSum = {};
+		size_t filterPtr = 0;
+		size_t filterFill = 0;
+		std::array<float, DerivedEvent::MAX_VALUE_CNT> gravity = {};
+		bool hasGravity = false;
+
+	public:
+		NormalizedAccel(size_t filterOrder = 0);
+
+		void push(const SensorEvent& evt, const Sink& sink) override;
+	};
+
+
+	// ###########
+	// # VirtualSensorStage
+	// ######################
+
+	/**
+	 * @brief Runs multiple virtual sensors on one stream of events in a single pass.
+	 * @details Derived events are passed to the sink along with the index of the sensor that emitted them, right when
+	 * they are calculated. Nothing is buffered between the sensors and the sink.
+	 * The per-sensor sinks refer to the stage, which is therefore neither copyable nor movable.
+	 */
+	class VirtualSensorStage {
+	public: // Associated types
+		using Sink = std::function<void(size_t sensorIdx, const DerivedEvent&)>;
+
+	private:
+		std::vector<std::unique_ptr<VirtualSensor>> sensors;
+		std::vector<VirtualSensor::Sink> sensorSinks;
+		Sink sink;
+
+	public:
+		VirtualSensorStage(Sink sink) : sink(std::move(sink)) {}
+		VirtualSensorStage(const VirtualSensorStage&) = delete;
+		VirtualSensorStage& operator=(const VirtualSensorStage&) = delete;
+
+		/** Add a sensor, and return its index */
+		size_t add(std::unique_ptr<VirtualSensor> sensor);
+		const VirtualSensor& get(size_t sensorIdx) const { return *sensors[sensorIdx]; }
+		size_t size() const { return sensors.size(); }
+
+		void push(const SensorEvent& evt);
+		/** Push all (remaining) events of the parser. Returns the amount of consumed events. */
+		size_t run(VisitingParser& parser);
+		size_t run(MappedVisitingParser& parser);
+	};
+
+}
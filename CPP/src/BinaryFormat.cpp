@@ -0,0 +1,516 @@
+#include <sensorreadout/BinaryFormat.h>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace SensorReadoutParser {
+
+// ###########
+// # Payload Encoding
+// ######################
+
+namespace {
+
+	static_assert(sizeof(MacAddress) == MacAddress::MAC_LENGTH, "MacAddress has to be stored packed");
+
+	/** Appends the fields of an event to a binary payload */
+	class PayloadWriter {
+	private:
+		std::string& payload;
+
+	public:
+		PayloadWriter(std::string& payload) : payload(payload) {}
+
+		template<typename TValue>
+		void pod(const TValue& value) {
+			static_assert(std::is_trivially_copyable_v<TValue>);
+			payload.append(reinterpret_cast<const char*>(&value), sizeof(TValue));
+		}
+		void size(size_t value) { pod(static_cast<uint64_t>(value)); }
+		void count(size_t cnt) {
+			exceptAssert(cnt <= UINT32_MAX, "Too many elements for binary payload");
+			pod(static_cast<uint32_t>(cnt));
+		}
+		template<typename TValue>
+		void array(const std::vector<TValue>& values) {
+			count(values.size());
+			payload.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(TValue));
+		}
+		void string(const std::string& value) {
+			count(value.size());
+			payload.append(value);
+		}
+	};
+
+	/** Reads the fields of an event from a binary payload, with bounds checks on every access */
+	class PayloadReader {
+	private:
+		std::string_view payload;
+		size_t ptr = 0;
+
+		const char* take(size_t byteCnt) {
+			exceptAssert(payload.size() - ptr >= byteCnt, "Truncated binary payload");
+			const char* result = payload.data() + ptr;
+			ptr += byteCnt;
+			return result;
+		}
+
+	public:
+		PayloadReader(std::string_view payload) : payload(payload) {}
+
+		template<typename TValue>
+		void pod(TValue& value) {
+			static_assert(std::is_trivially_copyable_v<TValue>);
+			std::memcpy(&value, take(sizeof(TValue)), sizeof(TValue));
+		}
+		void size(size_t& value) {
+			uint64_t value64;
+			pod(value64);
+			value = static_cast<size_t>(value64);
+		}
+		/** Read an element count, and verify that the remaining payload can hold that many elements of elementSize bytes */
+		size_t count(size_t elementSize) {
+			uint32_t cnt;
+			pod(cnt);
+			exceptAssert(cnt <= (payload.size() - ptr) / elementSize, "Truncated binary payload");
+			return cnt;
+		}
+		template<typename TValue>
+		void array(std::vector<TValue>& values) {
+			values.resize(count(sizeof(TValue)));
+			std::memcpy(values.data(), take(values.size() * sizeof(TValue)), values.size() * sizeof(TValue));
+		}
+		void string(std::string& value) {
+			size_t cnt = count(1);
+			value.assign(take(cnt), cnt);
+		}
+		void finish() { exceptAssert(ptr == payload.size(), "Binary payload is longer than expected"); }
+	};
+
+	// Numeric events: the array of their VALUE_CNT values
+
+	template<typename TEvent>
+	void encode(PayloadWriter& out, const TEvent& evt) {
+		for(size_t i = 0; i < TEvent::VALUE_CNT; ++i) { out.pod((&evt.template getValue<0>())[i]); }
+	}
+	template<typename TEvent>
+	void decode(PayloadReader& in, TEvent& evt) {
+		for(size_t i = 0; i < TEvent::VALUE_CNT; ++i) { in.pod((&evt.template getValue<0>())[i]); }
+	}
+
+	// Variable events: their fields in declaration order
+
+	void encode(PayloadWriter& out, const WifiEvent& evt) {
+		out.count(evt.advertisements.size());
+		for(const WifiAdvertisement& adv : evt.advertisements) {
+			out.pod(adv.mac);
+			out.pod(adv.rssi);
+			out.pod(adv.channelFreq);
+		}
+	}
+	void decode(PayloadReader& in, WifiEvent& evt) {
+		evt.advertisements.resize(in.count(sizeof(MacAddress) + sizeof(Rssi) + sizeof(WifiFrequency)));
+		for(WifiAdvertisement& adv : evt.advertisements) {
+			in.pod(adv.mac);
+			in.pod(adv.rssi);
+			in.pod(adv.channelFreq);
+			adv.macId = INVALID_MAC_ID;
+		}
+	}
+
+	void encode(PayloadWriter& out, const BLEEvent& evt) {
+		out.pod(evt.mac);
+		out.pod(evt.rssi);
+		out.pod(evt.txPower);
+		out.array(evt.rawData);
+	}
+	void decode(PayloadReader& in, BLEEvent& evt) {
+		in.pod(evt.mac);
+		in.pod(evt.rssi);
+		in.pod(evt.txPower);
+		in.array(evt.rawData);
+		evt.macId = INVALID_MAC_ID;
+	}
+
+	void encode(PayloadWriter& out, const WifiRTTEvent& evt) {
+		out.pod(static_cast<uint8_t>(evt.success));
+		out.pod(evt.mac);
+		out.pod(evt.distanceMM);
+		out.pod(evt.distanceStdDevMM);
+		out.pod(evt.rssi);
+		out.size(evt.numAttempted);
+		out.size(evt.numSuccessfull);
+	}
+	void decode(PayloadReader& in, WifiRTTEvent& evt) {
+		uint8_t success;
+		in.pod(success);
+		evt.success = (success != 0);
+		in.pod(evt.mac);
+		in.pod(evt.distanceMM);
+		in.pod(evt.distanceStdDevMM);
+		in.pod(evt.rssi);
+		in.size(evt.numAttempted);
+		in.size(evt.numSuccessfull);
+		evt.macId = INVALID_MAC_ID;
+	}
+
+	void encode(PayloadWriter& out, const EddystoneUIDEvent& evt) {
+		out.pod(evt.mac);
+		out.pod(evt.rssi);
+		out.pod(evt.txPower);
+		out.pod(evt.uid.data);
+	}
+	void decode(PayloadReader& in, EddystoneUIDEvent& evt) {
+		in.pod(evt.mac);
+		in.pod(evt.rssi);
+		in.pod(evt.txPower);
+		in.pod(evt.uid.data);
+		evt.macId = INVALID_MAC_ID;
+	}
+
+	void encode(PayloadWriter& out, const DecawaveUWBEvent& evt) {
+		out.pod(evt.x);
+		out.pod(evt.y);
+		out.pod(evt.z);
+		out.pod(evt.qualityFactor);
+		out.count(evt.anchorMeasurements.size());
+		for(const DecawaveUWBMeasurement& measurement : evt.anchorMeasurements) {
+			out.pod(measurement.nodeId);
+			out.pod(measurement.distance);
+			out.pod(measurement.qualityFactor);
+		}
+	}
+	void decode(PayloadReader& in, DecawaveUWBEvent& evt) {
+		in.pod(evt.x);
+		in.pod(evt.y);
+		in.pod(evt.z);
+		in.pod(evt.qualityFactor);
+		evt.anchorMeasurements.resize(in.count(sizeof(uint16_t) + sizeof(float) + sizeof(uint8_t)));
+		for(DecawaveUWBMeasurement& measurement : evt.anchorMeasurements) {
+			in.pod(measurement.nodeId);
+			in.pod(measurement.distance);
+			in.pod(measurement.qualityFactor);
+		}
+	}
+
+	void encode(PayloadWriter& out, const StepDetectorEvent& evt) {
+		out.pod(evt.stepStartTs);
+		out.pod(evt.stepEndTs);
+		out.pod(evt.probability);
+	}
+	void decode(PayloadReader& in, StepDetectorEvent& evt) {
+		in.pod(evt.stepStartTs);
+		in.pod(evt.stepEndTs);
+		in.pod(evt.probability);
+	}
+
+	void encode(PayloadWriter& out, const FutureShapeSensFloorEvent& evt) {
+		out.pod(evt.roomId);
+		out.pod(evt.x);
+		out.pod(evt.y);
+		out.pod(evt.fieldCapacities);
+	}
+	void decode(PayloadReader& in, FutureShapeSensFloorEvent& evt) {
+		in.pod(evt.roomId);
+		in.pod(evt.x);
+		in.pod(evt.y);
+		in.pod(evt.fieldCapacities);
+	}
+
+	void encode(PayloadWriter& out, const MicrophoneMetadataEvent& evt) {
+		out.size(evt.channelCnt);
+		out.size(evt.sampleRateHz);
+		out.string(evt.sampleFormat);
+	}
+	void decode(PayloadReader& in, MicrophoneMetadataEvent& evt) {
+		in.size(evt.channelCnt);
+		in.size(evt.sampleRateHz);
+		in.string(evt.sampleFormat);
+	}
+
+	void encode(PayloadWriter& out, const StepProbabilityEvent& evt) {
+		out.pod(evt.ts);
+		out.size(evt.id);
+		out.pod(evt.probability);
+	}
+	void decode(PayloadReader& in, StepProbabilityEvent& evt) {
+		in.pod(evt.ts);
+		in.size(evt.id);
+		in.pod(evt.probability);
+	}
+
+	void encode(PayloadWriter& out, const CIR5GEvent& evt) {
+		out.string(evt.baseStationId);
+		out.array(evt.real);
+		out.array(evt.imag);
+	}
+	void decode(PayloadReader& in, CIR5GEvent& evt) {
+		in.string(evt.baseStationId);
+		in.array(evt.real);
+		in.array(evt.imag);
+	}
+
+	void encode(PayloadWriter& out, const PedestrianActivityEvent& evt) {
+		out.pod(evt.rawActivityId);
+		out.string(evt.rawActivityName);
+	}
+	void decode(PayloadReader& in, PedestrianActivityEvent& evt) {
+		in.pod(evt.rawActivityId);
+		in.string(evt.rawActivityName);
+		evt.activity = static_cast<PedestrianActivity>(evt.rawActivityId);
+	}
+
+	void encode(PayloadWriter& out, const PosEvent& evt) {
+		out.pod(evt.x);
+		out.pod(evt.y);
+		out.pod(evt.z);
+		out.size(evt.floorIdx);
+	}
+	void decode(PayloadReader& in, PosEvent& evt) {
+		in.pod(evt.x);
+		in.pod(evt.y);
+		in.pod(evt.z);
+		in.size(evt.floorIdx);
+	}
+
+	void encode(PayloadWriter& out, const GroundTruthPathEvent& evt) {
+		out.string(evt.pathId);
+		out.size(evt.groundTruthPointCnt);
+	}
+	void decode(PayloadReader& in, GroundTruthPathEvent& evt) {
+		in.string(evt.pathId);
+		in.size(evt.groundTruthPointCnt);
+	}
+
+	void encode(PayloadWriter& out, const FileMetadataEvent& evt) {
+		out.string(evt.date);
+		out.string(evt.person);
+		out.string(evt.comment);
+	}
+	void decode(PayloadReader& in, FileMetadataEvent& evt) {
+		in.string(evt.date);
+		in.string(evt.person);
+		in.string(evt.comment);
+	}
+
+	void encode(PayloadWriter& out, const RecordingIdEvent& evt) {
+		out.pod(evt.recordingId.data);
+	}
+	void decode(PayloadReader& in, RecordingIdEvent& evt) {
+		in.pod(evt.recordingId.data);
+	}
+
+}
+
+void _internal::decodeBinaryPayload(const BinaryRecordView& record, SensorEvent& sensorEvent) {
+	#define BINARY_PAYLOAD_DECODE_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			EvtStruct& evt = (std::holds_alternative<EvtStruct>(sensorEvent.data)) \
+					? std::get<EvtStruct>(sensorEvent.data) : sensorEvent.data.emplace<EvtStruct>(); \
+			decode(in, evt); \
+			break; \
+		}
+
+	PayloadReader in(record.payload);
+	sensorEvent.timestamp = record.timestamp;
+	sensorEvent.eventType = static_cast<EventType>(record.eventId);
+	switch(sensorEvent.eventType) {
+		SENSORREADOUT_NUMERIC_EVENTS(BINARY_PAYLOAD_DECODE_CASE)
+		SENSORREADOUT_VARIABLE_EVENTS(BINARY_PAYLOAD_DECODE_CASE)
+		default: throw std::runtime_error("Attempted to decode unknown event type.");
+	}
+	in.finish();
+}
+
+
+// ###########
+// # BinaryReader
+// ######################
+
+BinaryReader::BinaryReader(std::istream& stream) : stream(stream) {
+	exceptAssert(ensureAvailable(_internal::BINARY_FILE_HEADER_SIZE), "Truncated binary file header");
+	const char* header = buffer.data() + ptr;
+	uint16_t formatVersion, byteOrderMark;
+	std::memcpy(&formatVersion, header + 4, sizeof(formatVersion));
+	std::memcpy(&byteOrderMark, header + 6, sizeof(byteOrderMark));
+	exceptAssert(std::string_view(header, 4) == _internal::BINARY_MAGIC, "Not a binary SensorReadout recording");
+	exceptAssert(byteOrderMark == _internal::BINARY_BYTE_ORDER_MARK, "Binary recording was written with a different byte order");
+	exceptAssert(formatVersion == _internal::BINARY_FORMAT_VERSION, "Unsupported binary format version");
+	ptr += _internal::BINARY_FILE_HEADER_SIZE;
+}
+
+bool BinaryReader::ensureAvailable(size_t byteCnt) {
+	if(bufferEnd - ptr >= byteCnt) { return true; }
+	// move the remainder to the front, and fill up the buffer behind it
+	std::copy(buffer.begin() + ptr, buffer.begin() + bufferEnd, buffer.begin());
+	bufferEnd -= ptr;
+	ptr = 0;
+	if(buffer.size() < std::max(byteCnt, READ_BLOCK_SIZE)) { buffer.resize(std::max(byteCnt, READ_BLOCK_SIZE)); }
+	while(bufferEnd < byteCnt && stream) {
+		stream.read(buffer.data() + bufferEnd, buffer.size() - bufferEnd);
+		bufferEnd += stream.gcount();
+	}
+	return bufferEnd >= byteCnt;
+}
+
+bool BinaryReader::nextAnyRecord(BinaryRecordView& record) {
+	if(!ensureAvailable(_internal::BINARY_RECORD_HEADER_SIZE)) {
+		exceptAssert(ptr == bufferEnd, "Truncated binary record");
+		return false;
+	}
+	uint32_t payloadSize;
+	const char* header = buffer.data() + ptr;
+	std::memcpy(&record.timestamp, header, sizeof(Timestamp));
+	std::memcpy(&record.eventId, header + sizeof(Timestamp), sizeof(EventId));
+	std::memcpy(&payloadSize, header + sizeof(Timestamp) + sizeof(EventId), sizeof(payloadSize));
+	exceptAssert(ensureAvailable(_internal::BINARY_RECORD_HEADER_SIZE + payloadSize), "Truncated binary record");
+	record.payload = std::string_view(buffer.data() + ptr + _internal::BINARY_RECORD_HEADER_SIZE, payloadSize);
+	ptr += _internal::BINARY_RECORD_HEADER_SIZE + payloadSize;
+	return true;
+}
+
+bool BinaryReader::nextRecord(BinaryRecordView& record) {
+	do {
+		if(!nextAnyRecord(record)) { return false; }
+	} while(eventFilter && !eventFilter->accepts(record.eventId));
+	return true;
+}
+
+bool BinaryReader::nextLine(RawSensorEvent& sensorEvent) {
+	#define BINARY_READER_FORMAT_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			parameterAssembler.clear(); \
+			_internal::decodeNumericPayload<EvtStruct>(record.payload).serializeInto(parameterAssembler); \
+			sensorEvent.parameterString.assign(parameterAssembler.view()); \
+			break; \
+		}
+	#define BINARY_READER_DECODE_FORMAT_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			parameterAssembler.clear(); \
+			_internal::decodeBinaryPayload(record, decodedEvent); \
+			std::get<EvtStruct>(decodedEvent.data).serializeInto(parameterAssembler); \
+			sensorEvent.parameterString.assign(parameterAssembler.view()); \
+			break; \
+		}
+
+	BinaryRecordView record;
+	if(!nextRecord(record)) { return false; }
+	sensorEvent.timestamp = record.timestamp;
+	sensorEvent.eventId = record.eventId;
+	switch(static_cast<EventType>(record.eventId)) {
+		SENSORREADOUT_NUMERIC_EVENTS(BINARY_READER_FORMAT_CASE)
+		SENSORREADOUT_VARIABLE_EVENTS(BINARY_READER_DECODE_FORMAT_CASE)
+		default: sensorEvent.parameterString.assign(record.payload); break;
+	}
+	return true;
+}
+
+bool BinaryReader::nextEvent(SensorEvent& sensorEvent) {
+	BinaryRecordView record;
+	if(!nextRecord(record)) { return false; }
+	_internal::decodeBinaryPayload(record, sensorEvent);
+	return true;
+}
+
+
+// ###########
+// # BinaryWriter
+// ######################
+
+BinaryWriter::BinaryWriter(std::ostream& stream) : stream(stream) {
+	buffer.reserve(FLUSH_THRESHOLD + 4096);
+	buffer.append(_internal::BINARY_MAGIC);
+	buffer.append(reinterpret_cast<const char*>(&_internal::BINARY_FORMAT_VERSION), sizeof(uint16_t));
+	buffer.append(reinterpret_cast<const char*>(&_internal::BINARY_BYTE_ORDER_MARK), sizeof(uint16_t));
+}
+
+BinaryWriter::~BinaryWriter() {
+	try { flush(); } catch (...) {}
+}
+
+void BinaryWriter::writeRecord(Timestamp timestamp, EventId eventId, const void* payload, size_t payloadSize) {
+	exceptAssert(payloadSize <= UINT32_MAX, "Payload too large for binary record");
+	uint32_t payloadSize32 = static_cast<uint32_t>(payloadSize);
+	char header[_internal::BINARY_RECORD_HEADER_SIZE];
+	std::memcpy(header, &timestamp, sizeof(Timestamp));
+	std::memcpy(header + sizeof(Timestamp), &eventId, sizeof(EventId));
+	std::memcpy(header + sizeof(Timestamp) + sizeof(EventId), &payloadSize32, sizeof(payloadSize32));
+	buffer.append(header, sizeof(header));
+	buffer.append(static_cast<const char*>(payload), payloadSize);
+	if(buffer.size() >= FLUSH_THRESHOLD) { writeBuffer(); }
+}
+
+void BinaryWriter::writeBuffer() {
+	stream.write(buffer.data(), buffer.size());
+	buffer.clear();
+	exceptAssert(stream.good(), "I/O error");
+}
+
+void BinaryWriter::write(const RawSensorEventView& sensorEvent) {
+	#define BINARY_WRITER_RAW_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			EvtStruct evt; \
+			evt.parse(sensorEvent.parameterString); \
+			payloadBuffer.clear(); \
+			PayloadWriter out(payloadBuffer); \
+			encode(out, evt); \
+			break; \
+		}
+
+	switch(static_cast<EventType>(sensorEvent.eventId)) {
+		SENSORREADOUT_NUMERIC_EVENTS(BINARY_WRITER_RAW_CASE)
+		SENSORREADOUT_VARIABLE_EVENTS(BINARY_WRITER_RAW_CASE)
+		default:
+			writeRecord(sensorEvent.timestamp, sensorEvent.eventId, sensorEvent.parameterString.data(), sensorEvent.parameterString.size());
+			return;
+	}
+	writeRecord(sensorEvent.timestamp, sensorEvent.eventId, payloadBuffer.data(), payloadBuffer.size());
+}
+
+void BinaryWriter::write(const SensorEvent& sensorEvent) {
+	#define BINARY_WRITER_EVENT_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			encode(out, std::get<EvtStruct>(sensorEvent.data)); \
+			break; \
+		}
+
+	payloadBuffer.clear();
+	PayloadWriter out(payloadBuffer);
+	switch(sensorEvent.eventType) {
+		SENSORREADOUT_NUMERIC_EVENTS(BINARY_WRITER_EVENT_CASE)
+		SENSORREADOUT_VARIABLE_EVENTS(BINARY_WRITER_EVENT_CASE)
+	}
+	writeRecord(sensorEvent.timestamp, static_cast<EventId>(sensorEvent.eventType), payloadBuffer.data(), payloadBuffer.size());
+}
+
+void BinaryWriter::flush() {
+	writeBuffer();
+	stream.flush();
+}
+
+
+// ###########
+// # Conversion
+// ######################
+
+size_t convertToBinary(VisitingParser& parser, BinaryWriter& writer) {
+	size_t eventCnt = 0;
+	RawSensorEvent sensorEvent;
+	while(parser.nextLine(sensorEvent)) {
+		writer.write(sensorEvent);
+		++eventCnt;
+	}
+	return eventCnt;
+}
+
+size_t convertToText(BinaryReader& reader, Serializer& serializer) {
+	size_t eventCnt = 0;
+	RawSensorEvent sensorEvent;
+	while(reader.nextLine(sensorEvent)) {
+		serializer.write(sensorEvent);
+		++eventCnt;
+	}
+	return eventCnt;
+}
+
+}
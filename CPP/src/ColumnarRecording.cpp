@@ -0,0 +1,223 @@
+#include <sensorreadout/ColumnarRecording.h>
+
+namespace SensorReadoutParser {
+
+// ###########
+// # Columnar Stores
+// ######################
+
+WifiEvent WifiEventStore::at(size_t idx) const {
+	WifiEvent evt;
+	evt.advertisements.assign(advertisementsOf(idx), advertisementsOf(idx) + advertisementCnt(idx));
+	return evt;
+}
+void WifiEventStore::push(Timestamp timestamp, const WifiEvent& evt) {
+	advertisements.insert(advertisements.end(), evt.advertisements.begin(), evt.advertisements.end());
+	advertisementOffsets.push_back(advertisements.size());
+	timestamps.push_back(timestamp);
+}
+void WifiEventStore::parse(Timestamp timestamp, const std::string_view& parameterString) {
+	size_t prevSize = advertisements.size();
+	try {
+		WifiEvent::parseAdvertisements(parameterString, advertisements);
+	} catch (...) {
+		advertisements.resize(prevSize);
+		throw;
+	}
+	advertisementOffsets.push_back(advertisements.size());
+	timestamps.push_back(timestamp);
+}
+void WifiEventStore::clear() {
+	timestamps.clear();
+	advertisementOffsets.assign(1, 0);
+	advertisements.clear();
+}
+
+BLEEvent BLEEventStore::at(size_t idx) const {
+	BLEEvent evt;
+	evt.mac = macs[idx];
+	evt.macId = macIds[idx];
+	evt.rssi = rssis[idx];
+	evt.txPower = txPowers[idx];
+	evt.rawData.assign(rawData.begin() + rawDataOffsets[idx], rawData.begin() + rawDataOffsets[idx + 1]);
+	return evt;
+}
+void BLEEventStore::push(Timestamp timestamp, const BLEEvent& evt) {
+	timestamps.push_back(timestamp);
+	macs.push_back(evt.mac);
+	macIds.push_back(evt.macId);
+	rssis.push_back(evt.rssi);
+	txPowers.push_back(evt.txPower);
+	rawData.insert(rawData.end(), evt.rawData.begin(), evt.rawData.end());
+	rawDataOffsets.push_back(rawData.size());
+}
+void BLEEventStore::parse(Timestamp timestamp, const std::string_view& parameterString) {
+	BLEEvent evt;
+	evt.parse(parameterString);
+	push(timestamp, evt);
+}
+void BLEEventStore::clear() {
+	timestamps.clear();
+	macs.clear();
+	macIds.clear();
+	rssis.clear();
+	txPowers.clear();
+	rawDataOffsets.assign(1, 0);
+	rawData.clear();
+}
+
+DecawaveUWBEvent DecawaveUWBEventStore::at(size_t idx) const {
+	DecawaveUWBEvent evt;
+	evt.x = x[idx];
+	evt.y = y[idx];
+	evt.z = z[idx];
+	evt.qualityFactor = qualityFactors[idx];
+	evt.anchorMeasurements.assign(anchorMeasurements.begin() + measurementOffsets[idx], anchorMeasurements.begin() + measurementOffsets[idx + 1]);
+	return evt;
+}
+void DecawaveUWBEventStore::push(Timestamp timestamp, const DecawaveUWBEvent& evt) {
+	timestamps.push_back(timestamp);
+	x.push_back(evt.x);
+	y.push_back(evt.y);
+	z.push_back(evt.z);
+	qualityFactors.push_back(evt.qualityFactor);
+	anchorMeasurements.insert(anchorMeasurements.end(), evt.anchorMeasurements.begin(), evt.anchorMeasurements.end());
+	measurementOffsets.push_back(anchorMeasurements.size());
+}
+void DecawaveUWBEventStore::parse(Timestamp timestamp, const std::string_view& parameterString) {
+	DecawaveUWBEvent evt;
+	evt.parse(parameterString);
+	push(timestamp, evt);
+}
+void DecawaveUWBEventStore::clear() {
+	timestamps.clear();
+	x.clear();
+	y.clear();
+	z.clear();
+	qualityFactors.clear();
+	measurementOffsets.assign(1, 0);
+	anchorMeasurements.clear();
+}
+
+
+// ###########
+// # ColumnarRecording
+// ######################
+
+void ColumnarRecording::add(const RawSensorEventView& rawEvent) {
+	#define COLUMNAR_RECORDING_PARSE_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			channel<EvtStruct>().parse(rawEvent.timestamp, rawEvent.parameterString); \
+			break; \
+		}
+
+	switch(static_cast<EventType>(rawEvent.eventId)) {
+		SENSORREADOUT_NUMERIC_EVENTS(COLUMNAR_RECORDING_PARSE_CASE)
+		case EventType::Wifi: {
+			const size_t firstAdvertisementIdx = wifiStore.advertisements.size();
+			wifiStore.parse(rawEvent.timestamp, rawEvent.parameterString);
+			assignWifiMacIds(firstAdvertisementIdx);
+			break;
+		}
+		case EventType::BLE: bleStore.parse(rawEvent.timestamp, rawEvent.parameterString); assignBLEMacId(); break;
+		case EventType::DecawaveUWB: decawaveUWBStore.parse(rawEvent.timestamp, rawEvent.parameterString); break;
+		default: otherEvents.push_back(SensorEvent::parse(rawEvent)); break;
+	}
+}
+
+void ColumnarRecording::add(const SensorEvent& evt) {
+	#define COLUMNAR_RECORDING_PUSH_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			channel<EvtStruct>().push(evt.timestamp, std::get<EvtStruct>(evt.data)); \
+			break; \
+		}
+
+	switch(evt.eventType) {
+		SENSORREADOUT_NUMERIC_EVENTS(COLUMNAR_RECORDING_PUSH_CASE)
+		case EventType::Wifi: {
+			const size_t firstAdvertisementIdx = wifiStore.advertisements.size();
+			wifiStore.push(evt.timestamp, std::get<WifiEvent>(evt.data));
+			assignWifiMacIds(firstAdvertisementIdx);
+			break;
+		}
+		case EventType::BLE: bleStore.push(evt.timestamp, std::get<BLEEvent>(evt.data)); assignBLEMacId(); break;
+		case EventType::DecawaveUWB: decawaveUWBStore.push(evt.timestamp, std::get<DecawaveUWBEvent>(evt.data)); break;
+		default: otherEvents.push_back(evt); break;
+	}
+}
+
+void ColumnarRecording::assignWifiMacIds(size_t firstAdvertisementIdx) {
+	if(!macDictionary) { return; }
+	for(size_t i = firstAdvertisementIdx; i < wifiStore.advertisements.size(); ++i) {
+		WifiAdvertisement& advertisement = wifiStore.advertisements[i];
+		advertisement.macId = macDictionary->intern(advertisement.mac);
+	}
+}
+
+void ColumnarRecording::assignBLEMacId() {
+	if(!macDictionary) { return; }
+	bleStore.macIds.back() = macDictionary->intern(bleStore.macs.back());
+}
+
+ColumnarRecording ColumnarRecording::parse(VisitingParser& parser, MacDictionary* macDictionary) {
+	ColumnarRecording result;
+	result.setMacDictionary(macDictionary);
+	RawSensorEvent rawEvent;
+	while(parser.nextLine(rawEvent)) {
+		result.add(RawSensorEventView(rawEvent));
+	}
+	result.setMacDictionary(nullptr);
+	return result;
+}
+
+ColumnarRecording ColumnarRecording::parse(MappedVisitingParser& parser, MacDictionary* macDictionary) {
+	ColumnarRecording result;
+	result.setMacDictionary(macDictionary);
+	RawSensorEventView rawEvent;
+	while(parser.nextLine(rawEvent)) {
+		result.add(rawEvent);
+	}
+	result.setMacDictionary(nullptr);
+	return result;
+}
+
+ColumnarRecording ColumnarRecording::parse(BinaryReader& reader, MacDictionary* macDictionary) {
+	#define COLUMNAR_RECORDING_BINARY_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			result.channel<EvtStruct>().pushBinary(record.timestamp, record.payload); \
+			break; \
+		}
+
+	ColumnarRecording result;
+	result.setMacDictionary(macDictionary);
+	BinaryRecordView record;
+	SensorEvent decodedEvent;
+	while(reader.nextRecord(record)) {
+		switch(static_cast<EventType>(record.eventId)) {
+			SENSORREADOUT_NUMERIC_EVENTS(COLUMNAR_RECORDING_BINARY_CASE)
+			default: {
+				_internal::decodeBinaryPayload(record, decodedEvent);
+				result.add(decodedEvent);
+				break;
+			}
+		}
+	}
+	result.setMacDictionary(nullptr);
+	return result;
+}
+
+size_t ColumnarRecording::size() const {
+	size_t result = wifiStore.size() + bleStore.size() + decawaveUWBStore.size() + otherEvents.size();
+	forEachNumericChannel([&](EventType, const auto& numericChannel) { result += numericChannel.size(); });
+	return result;
+}
+
+void ColumnarRecording::clear() {
+	std::apply([](auto&... numericChannel) { (numericChannel.clear(), ...); }, numericChannels);
+	wifiStore.clear();
+	bleStore.clear();
+	decawaveUWBStore.clear();
+	otherEvents.clear();
+}
+
+}
@@ -0,0 +1,220 @@
+#include <sensorreadout/ExternalSort.h>
+#include <sensorreadout/Parallel.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace SensorReadoutParser {
+
+namespace {
+
+	/** Events of one run. The parameters of all events are stored back to back in one arena. */
+	struct Run {
+		struct Entry {
+			Timestamp timestamp;
+			EventId eventId;
+			size_t parameterOffset;
+			size_t parameterLength;
+		};
+		std::vector<Entry> entries;
+		std::string parameterArena;
+
+		size_t memoryUsage() const { return entries.size() * sizeof(Entry) + parameterArena.size(); }
+
+		void sort() {
+			std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.timestamp < b.timestamp; });
+		}
+		void writeTo(Serializer& serializer) const {
+			for(const auto& entry : entries) {
+				serializer.write(RawSensorEventView(entry.timestamp, entry.eventId,
+						std::string_view(parameterArena).substr(entry.parameterOffset, entry.parameterLength)));
+			}
+		}
+	};
+
+	/** Removes all temporary run files on destruction */
+	struct RunFiles {
+		std::vector<std::filesystem::path> paths;
+
+		~RunFiles() {
+			std::error_code ec;
+			for(const auto& path : paths) { std::filesystem::remove(path, ec); }
+		}
+	};
+
+	/** Reader on one sorted run file, used as element of the merge heap */
+	struct RunReader {
+		size_t runIdx;
+		std::ifstream stream;
+		VisitingParser parser;
+		RawSensorEvent current;
+
+		RunReader(size_t runIdx, const std::filesystem::path& path) : runIdx(runIdx), stream(path, std::ios::binary), parser(stream) {
+			exceptAssert(stream.is_open(), "Failed to open run file: " + path.string());
+		}
+		bool advance() { return parser.nextLine(current); }
+	};
+
+	/** Sort the run and write it to a new run file at path */
+	void writeRun(Run& run, const std::filesystem::path& path) {
+		run.sort();
+		std::ofstream runFile(path, std::ios::binary);
+		exceptAssert(runFile.is_open(), "Failed to create run file: " + path.string());
+		Serializer runSerializer(runFile);
+		run.writeTo(runSerializer);
+		runSerializer.flush(); // the destructor ignores I/O errors
+	}
+
+	/** k-way merge of the given sorted runs. Ties are resolved by the position of the run in runPaths, to keep the sort stable. */
+	void mergeRuns(const std::vector<std::filesystem::path>& runPaths, Serializer& serializer) {
+		std::vector<std::unique_ptr<RunReader>> readers;
+		for(size_t i = 0; i < runPaths.size(); ++i) {
+			auto reader = std::make_unique<RunReader>(i, runPaths[i]);
+			if(reader->advance()) { readers.push_back(std::move(reader)); }
+		}
+		auto laterThan = [](const std::unique_ptr<RunReader>& a, const std::unique_ptr<RunReader>& b) {
+			return (a->current.timestamp != b->current.timestamp) ? (a->current.timestamp > b->current.timestamp) : (a->runIdx > b->runIdx);
+		};
+		std::make_heap(readers.begin(), readers.end(), laterThan);
+		while(!readers.empty()) {
+			std::pop_heap(readers.begin(), readers.end(), laterThan);
+			RunReader& reader = *readers.back();
+			serializer.write(reader.current);
+			if(reader.advance()) {
+				std::push_heap(readers.begin(), readers.end(), laterThan);
+			} else {
+				readers.pop_back();
+			}
+		}
+	}
+
+}
+
+size_t sortRecording(VisitingParser& parser, Serializer& serializer, const ExternalSortOptions& options) {
+	const size_t threadCnt = (options.threadCnt > 0) ? options.threadCnt : std::max(1u, std::thread::hardware_concurrency());
+	const size_t runBudget = options.memoryBudget / (threadCnt + 1);
+	exceptWhen(runBudget == 0, "Memory budget too small");
+	exceptWhen(options.maxMergeFanIn < 2, "Merge fan-in has to be at least 2");
+	const std::filesystem::path tempDirectory = options.tempDirectory.empty() ? std::filesystem::temp_directory_path() : options.tempDirectory;
+	const std::string runPrefix = "sensorreadout_sort_" + std::to_string(std::random_device()()) + "_";
+
+	RunFiles runFiles;
+	auto newRunPath = [&]() {
+		runFiles.paths.push_back(tempDirectory / (runPrefix + std::to_string(runFiles.paths.size())));
+		return runFiles.paths.back();
+	};
+	size_t eventCnt = 0;
+
+	// ---- run phase: fill a run, while a fixed pool of threadCnt workers sorts and writes the previous ones
+	std::mutex mutex;
+	std::condition_variable runQueued;
+	std::condition_variable runTaken;
+	std::deque<std::pair<std::filesystem::path, Run>> queuedRuns;
+	size_t idleWorkers = 0;
+	bool inputDone = false;
+	std::exception_ptr error;
+	std::vector<std::thread> workers;
+	auto worker = [&]() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while(true) {
+			++idleWorkers;
+			runTaken.notify_one();
+			runQueued.wait(lock, [&]() { return !queuedRuns.empty() || inputDone; });
+			--idleWorkers;
+			if(queuedRuns.empty()) { return; }
+			auto [runPath, queuedRun] = std::move(queuedRuns.front());
+			queuedRuns.pop_front();
+			lock.unlock();
+			try {
+				writeRun(queuedRun, runPath);
+			} catch (...) {
+				std::lock_guard<std::mutex> errorLock(mutex);
+				if(!error) { error = std::current_exception(); }
+			}
+			lock.lock();
+		}
+	};
+	auto joinWorkers = [&]() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			inputDone = true;
+		}
+		runQueued.notify_all();
+		for(auto& workerThread : workers) { workerThread.join(); }
+		workers.clear();
+	};
+
+	Run run;
+	RawSensorEvent rawEvent;
+	bool inputEnded = false;
+	try {
+		while(!inputEnded) {
+			run.entries.clear();
+			run.parameterArena.clear();
+			while(run.memoryUsage() < runBudget) {
+				if(!parser.nextLine(rawEvent)) {
+					inputEnded = true;
+					break;
+				}
+				run.entries.push_back(Run::Entry { rawEvent.timestamp, rawEvent.eventId, run.parameterArena.size(), rawEvent.parameterString.size() });
+				run.parameterArena.append(rawEvent.parameterString);
+			}
+			eventCnt += run.entries.size();
+			if(inputEnded && runFiles.paths.empty()) { // everything fits into memory
+				run.sort();
+				run.writeTo(serializer);
+				return eventCnt;
+			}
+			if(run.entries.empty()) { break; }
+
+			if(workers.empty()) {
+				for(size_t i = 0; i < threadCnt; ++i) { workers.emplace_back(worker); }
+			}
+			// hand the run to an idle worker, such that at most threadCnt runs are sorted while the next one is filled
+			std::unique_lock<std::mutex> lock(mutex);
+			runTaken.wait(lock, [&]() { return idleWorkers > queuedRuns.size() || error; });
+			if(error) { break; }
+			queuedRuns.emplace_back(newRunPath(), std::move(run));
+			runQueued.notify_one();
+			run = Run();
+		}
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if(!error) { error = std::current_exception(); }
+	}
+	joinWorkers();
+	if(error) { std::rethrow_exception(error); }
+
+	// ---- merge phase: merge groups of up to maxMergeFanIn consecutive runs into intermediate runs, until one pass
+	// can merge all remaining runs into the output. Groups of consecutive runs keep the merge stable.
+	std::vector<std::filesystem::path> runPaths = runFiles.paths;
+	while(runPaths.size() > options.maxMergeFanIn) {
+		const size_t groupCnt = (runPaths.size() + options.maxMergeFanIn - 1) / options.maxMergeFanIn;
+		std::vector<std::filesystem::path> mergedPaths;
+		for(size_t groupIdx = 0; groupIdx < groupCnt; ++groupIdx) { mergedPaths.push_back(newRunPath()); }
+		_internal::parallelFor(groupCnt, threadCnt, [&](size_t groupIdx) {
+			auto groupBegin = runPaths.begin() + groupIdx * options.maxMergeFanIn;
+			auto groupEnd = runPaths.begin() + std::min(runPaths.size(), (groupIdx + 1) * options.maxMergeFanIn);
+			std::ofstream mergedFile(mergedPaths[groupIdx], std::ios::binary);
+			exceptAssert(mergedFile.is_open(), "Failed to create run file: " + mergedPaths[groupIdx].string());
+			Serializer mergedSerializer(mergedFile);
+			mergeRuns(std::vector<std::filesystem::path>(groupBegin, groupEnd), mergedSerializer);
+			mergedSerializer.flush();
+			std::error_code ec; // merged runs are not needed anymore, free their disk space early
+			for(auto it = groupBegin; it != groupEnd; ++it) { std::filesystem::remove(*it, ec); }
+		});
+		runPaths = std::move(mergedPaths);
+	}
+	mergeRuns(runPaths, serializer);
+	return eventCnt;
+}
+
+}
@@ -0,0 +1,202 @@
+#include <sensorreadout/FingerprintMatcher.h>
+#include <sensorreadout/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+	#include <immintrin.h>
+#endif
+
+namespace SensorReadoutParser {
+
+namespace {
+
+	/** Matrix rows are padded to a multiple of this, so the kernels never need a scalar tail */
+	constexpr size_t SIMD_WIDTH = 8;
+
+	/** Call fn(mac, rssi) for every RSSI value of evt, if its type is one of the sources */
+	template<typename TFn>
+	void forEachRssi(const SensorEvent& evt, const EventTypeFilter& sources, TFn fn) {
+		if(!sources.accepts(evt.eventType)) { return; }
+		switch(evt.eventType) {
+			case EventType::Wifi:
+				for(const auto& advertisement : std::get<WifiEvent>(evt.data).advertisements) { fn(advertisement.mac, advertisement.rssi); }
+				break;
+			case EventType::BLE: { const auto& data = std::get<BLEEvent>(evt.data); fn(data.mac, data.rssi); break; }
+			case EventType::WifiRTT: { const auto& data = std::get<WifiRTTEvent>(evt.data); fn(data.mac, data.rssi); break; }
+			case EventType::EddystoneUID: { const auto& data = std::get<EddystoneUIDEvent>(evt.data); fn(data.mac, data.rssi); break; }
+			default: break;
+		}
+	}
+
+	// Each kernel adds to dist[c] the change in distance contribution of one MAC, when the query measured q instead
+	// of m (missingRssi) there: for Euclidean (r-q)^2 - (r-m)^2 = 2(m-q) * r + (q^2 - m^2), for Manhattan
+	// |r-q| - |r-m| = |r-q| - (r-m) (stored values are clamped to r >= m). cnt is a multiple of SIMD_WIDTH.
+
+	void accumulateEuclidean(const float* row, float q, float m, float* dist, size_t cnt) {
+		const float a = 2 * (m - q);
+		const float b = q * q - m * m;
+		size_t c = 0;
+	#if defined(__AVX__)
+		const __m256 a8 = _mm256_set1_ps(a), b8 = _mm256_set1_ps(b);
+		for(; c < cnt; c += 8) {
+			__m256 d = _mm256_add_ps(_mm256_loadu_ps(dist + c), _mm256_add_ps(_mm256_mul_ps(a8, _mm256_loadu_ps(row + c)), b8));
+			_mm256_storeu_ps(dist + c, d);
+		}
+	#elif defined(__SSE2__) || defined(_M_X64)
+		const __m128 a4 = _mm_set1_ps(a), b4 = _mm_set1_ps(b);
+		for(; c < cnt; c += 4) {
+			__m128 d = _mm_add_ps(_mm_loadu_ps(dist + c), _mm_add_ps(_mm_mul_ps(a4, _mm_loadu_ps(row + c)), b4));
+			_mm_storeu_ps(dist + c, d);
+		}
+	#endif
+		for(; c < cnt; ++c) { dist[c] += a * row[c] + b; }
+	}
+
+	void accumulateManhattan(const float* row, float q, float m, float* dist, size_t cnt) {
+		size_t c = 0;
+	#if defined(__AVX__)
+		const __m256 q8 = _mm256_set1_ps(q), m8 = _mm256_set1_ps(m);
+		const __m256 absMask8 = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+		for(; c < cnt; c += 8) {
+			__m256 r = _mm256_loadu_ps(row + c);
+			__m256 delta = _mm256_sub_ps(_mm256_and_ps(_mm256_sub_ps(r, q8), absMask8), _mm256_sub_ps(r, m8));
+			_mm256_storeu_ps(dist + c, _mm256_add_ps(_mm256_loadu_ps(dist + c), delta));
+		}
+	#elif defined(__SSE2__) || defined(_M_X64)
+		const __m128 q4 = _mm_set1_ps(q), m4 = _mm_set1_ps(m);
+		const __m128 absMask4 = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		for(; c < cnt; c += 4) {
+			__m128 r = _mm_loadu_ps(row + c);
+			__m128 delta = _mm_sub_ps(_mm_and_ps(_mm_sub_ps(r, q4), absMask4), _mm_sub_ps(r, m4));
+			_mm_storeu_ps(dist + c, _mm_add_ps(_mm_loadu_ps(dist + c), delta));
+		}
+	#endif
+		for(; c < cnt; ++c) { dist[c] += std::abs(row[c] - q) - (row[c] - m); }
+	}
+
+}
+
+
+// ###########
+// # FingerprintMatcher
+// ######################
+
+FingerprintMatcher::FingerprintMatcher(const Fingerprints& fingerprints, const FingerprintMatcherOptions& options) : options(options) {
+	const float m = options.missingRssi;
+
+	// mean RSSI per (row, column), collected sparse before the matrix size is known
+	struct Cell { MacId row; float rssi; };
+	std::vector<std::vector<Cell>> columns;
+	std::unordered_map<MacId, std::pair<double, size_t>> sums;
+	std::vector<SensorEvent> pendingEvts;
+	size_t fpIdx = 0;
+	for(const Fingerprint& fp : fingerprints) {
+		sums.clear();
+		auto accumulate = [&](const std::vector<SensorEvent>& evts) {
+			for(const SensorEvent& evt : evts) {
+				forEachRssi(evt, options.sources, [&](const MacAddress& mac, Rssi rssi) {
+					auto& [sum, cnt] = sums[macRows.intern(mac)];
+					sum += rssi;
+					++cnt;
+				});
+			}
+		};
+		accumulate(fp.evts);
+		if(fp.hasPendingEvents()) {
+			pendingEvts.clear();
+			fp.pendingEvts->decodeInto(pendingEvts);
+			accumulate(pendingEvts);
+		}
+		if(!sums.empty()) {
+			std::vector<Cell>& column = columns.emplace_back();
+			for(const auto& [row, sumCnt] : sums) {
+				column.push_back({row, std::max(m, static_cast<float>(sumCnt.first / static_cast<double>(sumCnt.second)))});
+			}
+			columnFpIdcs.push_back(fpIdx);
+		}
+		++fpIdx;
+	}
+
+	stride = (columns.size() + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+	matrix.assign(macRows.size() * stride, m);
+	missingDistance.assign(stride, 0);
+	for(size_t col = 0; col < columns.size(); ++col) {
+		for(const Cell& cell : columns[col]) {
+			matrix[cell.row * stride + col] = cell.rssi;
+			const float diff = cell.rssi - m;
+			missingDistance[col] += (options.metric == RssiDistanceMetric::Euclidean) ? (diff * diff) : diff;
+		}
+	}
+}
+
+void FingerprintMatcher::computeDistances(std::span<const RssiMeasurement> query, std::vector<float>& distances) const {
+	const float m = options.missingRssi;
+	distances = missingDistance;
+
+	// mean RSSI per MAC of the query, MACs measured multiple times contribute once
+	struct Measurement { uint64_t key; MacId row; float rssi; };
+	std::vector<Measurement> measurements;
+	measurements.reserve(query.size());
+	for(const RssiMeasurement& measurement : query) {
+		measurements.push_back({measurement.mac.toUInt64(), macRows.find(measurement.mac), static_cast<float>(measurement.rssi)});
+	}
+	std::sort(measurements.begin(), measurements.end(), [](const auto& a, const auto& b) { return a.key < b.key; });
+
+	float unknownDistance = 0;
+	for(size_t i = 0; i < measurements.size();) {
+		size_t end = i;
+		float sum = 0;
+		for(; end < measurements.size() && measurements[end].key == measurements[i].key; ++end) { sum += measurements[end].rssi; }
+		const float q = std::max(m, sum / static_cast<float>(end - i));
+
+		const MacId row = measurements[i].row;
+		if(row == INVALID_MAC_ID) { // no fingerprint saw this MAC, so it adds the same distance to all of them
+			unknownDistance += (options.metric == RssiDistanceMetric::Euclidean) ? ((q - m) * (q - m)) : (q - m);
+		} else if(options.metric == RssiDistanceMetric::Euclidean) {
+			accumulateEuclidean(&matrix[row * stride], q, m, distances.data(), stride);
+		} else {
+			accumulateManhattan(&matrix[row * stride], q, m, distances.data(), stride);
+		}
+		i = end;
+	}
+	for(float& distance : distances) { distance += unknownDistance; }
+}
+
+std::vector<FingerprintMatch> FingerprintMatcher::match(std::span<const RssiMeasurement> query, size_t k) const {
+	std::vector<float> distances;
+	computeDistances(query, distances);
+
+	std::vector<FingerprintMatch> result(columnFpIdcs.size());
+	for(size_t col = 0; col < columnFpIdcs.size(); ++col) {
+		result[col] = { columnFpIdcs[col], distances[col] };
+	}
+	auto cmp = [](const FingerprintMatch& a, const FingerprintMatch& b) {
+		return (a.distance != b.distance) ? (a.distance < b.distance) : (a.fpIdx < b.fpIdx);
+	};
+	k = std::min(k, result.size());
+	std::partial_sort(result.begin(), result.begin() + k, result.end(), cmp);
+	result.resize(k);
+	if(options.metric == RssiDistanceMetric::Euclidean) {
+		// the incremental float updates can leave tiny negative values for an exact match
+		for(FingerprintMatch& match : result) { match.distance = std::sqrt(std::max(0.0f, match.distance)); }
+	}
+	return result;
+}
+
+std::vector<FingerprintMatch> FingerprintMatcher::match(const WifiEvent& query, size_t k) const {
+	std::vector<RssiMeasurement> measurements;
+	measurements.reserve(query.advertisements.size());
+	for(const WifiAdvertisement& advertisement : query.advertisements) { measurements.push_back({advertisement.mac, advertisement.rssi}); }
+	return match(measurements, k);
+}
+
+std::vector<std::vector<FingerprintMatch>> FingerprintMatcher::matchAll(std::span<const WifiEvent> queries, size_t k, size_t threadCnt) const {
+	std::vector<std::vector<FingerprintMatch>> result(queries.size());
+	_internal::parallelFor(queries.size(), threadCnt, [&](size_t queryIdx) { result[queryIdx] = match(queries[queryIdx], k); });
+	return result;
+}
+
+}
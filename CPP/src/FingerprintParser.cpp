@@ -0,0 +1,115 @@
+#include <sensorreadout/FingerprintParser.h>
+#include <sensorreadout/Parallel.h>
+
+#include <cstring>
+#include <iterator>
+
+namespace SensorReadoutParser {
+
+// ###########
+// # Fingerprints
+// ######################
+
+void PendingFingerprintEvents::decodeInto(std::vector<SensorEvent>& evts) const {
+	RawSensorEventView rawEvt;
+	size_t lineStart = 0;
+	while(lineStart < lines.size()) {
+		size_t lineEnd = lines.find('\n', lineStart);
+		if(lineEnd == std::string_view::npos) { lineEnd = lines.size(); }
+		_internal::parseEventLine(lines.substr(lineStart, lineEnd - lineStart), fileVersion, rawEvt);
+		lineStart = lineEnd + 1;
+		if(typeFilter && !typeFilter->accepts(rawEvt.eventId)) { continue; }
+		evts.push_back(SensorEvent::parse(rawEvt));
+	}
+}
+
+void Fingerprints::addToSpatialIndex(const Fingerprint& fp, size_t fpIdx) {
+	if(fp.fpType == FingerprintType::Point) {
+		if(fp.hasPosition() && fp.hasFloorIdx()) { spatialIndex.insert(fp.getFloorIdx(), fp.getPosition(), fpIdx); }
+		return;
+	}
+	// path positions are on the floor of the point they belong to, falling back to the fingerprint's floor
+	const auto positions = fp.getPositions();
+	const auto floorIdcs = fp.getFloorIdcs();
+	for(size_t i = 0; i < positions.size(); ++i) {
+		if(i < floorIdcs.size()) { spatialIndex.insert(floorIdcs[i], positions[i], fpIdx, i); }
+		else if(fp.hasFloorIdx()) { spatialIndex.insert(fp.getFloorIdx(), positions[i], fpIdx, i); }
+	}
+}
+
+void Fingerprints::loadEvents(size_t threadCnt) {
+	_internal::parallelFor(fingerprints.size(), threadCnt, [&](size_t fpIdx) { fingerprints[fpIdx].loadEvents(); });
+}
+
+
+// ###########
+// # FingerprintParser
+// ######################
+
+Fingerprints FingerprintParser::index(std::optional<EventFilter> eventFilter) {
+	std::optional<EventTypeFilter> typeFilter;
+	if(eventFilter) { typeFilter = EventTypeFilter(eventFilter->begin(), eventFilter->end()); }
+
+	auto buffer = std::make_shared<std::string>();
+	stream.clear();
+	stream.seekg(0, std::ios::end);
+	const std::streamoff streamSize = stream.tellg();
+	stream.seekg(0, std::ios::beg);
+	if(streamSize >= 0 && stream.good()) { // seekable: read the whole file with one call
+		buffer->resize(static_cast<size_t>(streamSize));
+		stream.read(buffer->data(), streamSize);
+		buffer->resize(static_cast<size_t>(stream.gcount()));
+	} else {
+		stream.clear();
+		buffer->assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+	if(stream.bad()) { throw std::runtime_error("An error occured while reading the Fingerprint file."); }
+	const std::string_view data(*buffer);
+
+	size_t pos = 0;
+	// next line without its newline, returns false at the end of the buffer
+	auto nextLine = [&](std::string_view& line) {
+		if(pos >= data.size()) { return false; }
+		const char* lineEnd = static_cast<const char*>(std::memchr(data.data() + pos, '\n', data.size() - pos));
+		size_t lineEndIdx = (lineEnd != nullptr) ? static_cast<size_t>(lineEnd - data.data()) : data.size();
+		line = data.substr(pos, lineEndIdx - pos);
+		pos = lineEndIdx + 1;
+		return true;
+	};
+
+	Fingerprints result;
+	std::string_view line;
+	while(true) {
+		// find fp header
+		do {
+			if(!nextLine(line)) { return result; }
+		} while(line.empty() || line.front() != '[');
+
+		Fingerprint currentFp;
+		if(line == "[fingerprint:point]") { currentFp.fpType = FingerprintType::Point; }
+		else if(line == "[fingerprint:path]") { currentFp.fpType = FingerprintType::Path; }
+		else { throw std::runtime_error("Encountered unsupported fingerprint type"); }
+
+		FingerprintParameters parameters;
+		while(true) {
+			if(!nextLine(line)) { throw std::runtime_error("Unexpected end of file"); }
+			if(line.empty()) { break; }
+			auto [propKey, propValue] = parseParameterLine(line);
+			parameters.insert({propKey, propValue});
+		}
+		exceptAssert(parameters.find("name") != parameters.end(), "Fingerprint missing required 'name' property");
+		currentFp.name = parameters.at("name");
+		currentFp.setParameters(std::move(parameters));
+
+		// events are terminated by an empty line, or the end of the file
+		const size_t evtsStart = std::min(pos, data.size());
+		size_t evtsEnd = evtsStart;
+		while(nextLine(line) && !line.empty()) {
+			evtsEnd = static_cast<size_t>(line.data() - data.data()) + line.size();
+		}
+		currentFp.pendingEvts = PendingFingerprintEvents { buffer, data.substr(evtsStart, evtsEnd - evtsStart), fileVersion, typeFilter };
+		result.add(std::move(currentFp));
+	}
+}
+
+}
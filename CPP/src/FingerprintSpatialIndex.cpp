@@ -0,0 +1,140 @@
+#include <sensorreadout/FingerprintSpatialIndex.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace SensorReadoutParser {
+
+namespace {
+
+	double distance(const std::array<double, 3>& a, const std::array<double, 3>& b) {
+		const double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+		return std::sqrt(dx * dx + dy * dy + dz * dz);
+	}
+
+	/** Keeps the closest position of each fingerprint encountered during a query */
+	struct ClosestPerFingerprint {
+		std::unordered_map<size_t, SpatialQueryResult> results;
+
+		void push(size_t fpIdx, size_t positionIdx, double distance) {
+			auto [it, inserted] = results.try_emplace(fpIdx, SpatialQueryResult { fpIdx, positionIdx, distance });
+			if(!inserted && distance < it->second.distance) { it->second = { fpIdx, positionIdx, distance }; }
+		}
+
+		/** Results sorted by distance, ties broken by fingerprint index to keep the order deterministic */
+		std::vector<SpatialQueryResult> sorted(size_t maxCnt = SIZE_MAX) const {
+			std::vector<SpatialQueryResult> result;
+			result.reserve(results.size());
+			for(const auto& [fpIdx, match] : results) { result.push_back(match); }
+			auto cmp = [](const SpatialQueryResult& a, const SpatialQueryResult& b) {
+				return (a.distance != b.distance) ? (a.distance < b.distance) : (a.fpIdx < b.fpIdx);
+			};
+			if(maxCnt < result.size()) {
+				std::partial_sort(result.begin(), result.begin() + maxCnt, result.end(), cmp);
+				result.resize(maxCnt);
+			} else {
+				std::sort(result.begin(), result.end(), cmp);
+			}
+			return result;
+		}
+	};
+
+}
+
+void FingerprintSpatialIndex::insert(size_t floorIdx, const std::array<double, 3>& position, size_t fpIdx, size_t positionIdx) {
+	Floor& floor = floors[floorIdx];
+	const CellCoord cell = cellOf(position);
+	floor.cells[cellKey(cell)].push_back({position, fpIdx, positionIdx});
+	floor.minCell = { std::min(floor.minCell.x, cell.x), std::min(floor.minCell.y, cell.y) };
+	floor.maxCell = { std::max(floor.maxCell.x, cell.x), std::max(floor.maxCell.y, cell.y) };
+	++entryCnt;
+}
+
+std::vector<SpatialQueryResult> FingerprintSpatialIndex::findWithinRadius(size_t floorIdx, const std::array<double, 3>& position, double radius) const {
+	auto floorIt = floors.find(floorIdx);
+	if(floorIt == floors.end() || radius < 0) { return {}; }
+	const Floor& floor = floorIt->second;
+
+	ClosestPerFingerprint closest;
+	auto visitCell = [&](const std::vector<Entry>& entries) {
+		for(const Entry& entry : entries) {
+			double dist = distance(entry.position, position);
+			if(dist <= radius) { closest.push(entry.fpIdx, entry.positionIdx, dist); }
+		}
+	};
+
+	// cells overlapping the radius' bounding square, clamped to the occupied area of the floor
+	const CellCoord from = cellOf({position[0] - radius, position[1] - radius, 0});
+	const CellCoord to = cellOf({position[0] + radius, position[1] + radius, 0});
+	const int64_t fromX = std::max(from.x, floor.minCell.x), toX = std::min(to.x, floor.maxCell.x);
+	const int64_t fromY = std::max(from.y, floor.minCell.y), toY = std::min(to.y, floor.maxCell.y);
+	if(fromX > toX || fromY > toY) { return {}; }
+
+	if(static_cast<uint64_t>(toX - fromX + 1) * static_cast<uint64_t>(toY - fromY + 1) > floor.cells.size()) {
+		// huge radius: cheaper to visit every occupied cell
+		for(const auto& [key, entries] : floor.cells) { visitCell(entries); }
+	} else {
+		for(int64_t x = fromX; x <= toX; ++x) {
+			for(int64_t y = fromY; y <= toY; ++y) {
+				auto cellIt = floor.cells.find(cellKey({static_cast<int32_t>(x), static_cast<int32_t>(y)}));
+				if(cellIt != floor.cells.end()) { visitCell(cellIt->second); }
+			}
+		}
+	}
+	return closest.sorted();
+}
+
+std::vector<SpatialQueryResult> FingerprintSpatialIndex::findNearest(size_t floorIdx, const std::array<double, 3>& position, size_t k) const {
+	auto floorIt = floors.find(floorIdx);
+	if(floorIt == floors.end() || k == 0) { return {}; }
+	const Floor& floor = floorIt->second;
+
+	ClosestPerFingerprint closest;
+	auto visitCell = [&](int64_t x, int64_t y) {
+		auto cellIt = floor.cells.find(cellKey({static_cast<int32_t>(x), static_cast<int32_t>(y)}));
+		if(cellIt == floor.cells.end()) { return; }
+		for(const Entry& entry : cellIt->second) {
+			closest.push(entry.fpIdx, entry.positionIdx, distance(entry.position, position));
+		}
+	};
+
+	// Visit rings of cells (by chebyshev distance to the query's cell) from the inside out. Every position in a cell
+	// of ring r+1 is at least r * cellSize away from the query, which allows stopping as soon as k fingerprints are
+	// known that are closer than that.
+	const CellCoord center = cellOf(position);
+	const int64_t cx = center.x, cy = center.y;
+	const int64_t maxRing = std::max({cx - floor.minCell.x, floor.maxCell.x - cx, cy - floor.minCell.y, floor.maxCell.y - cy});
+	const int64_t firstRing = std::max<int64_t>({0, floor.minCell.x - cx, cx - floor.maxCell.x, floor.minCell.y - cy, cy - floor.maxCell.y});
+	for(int64_t ring = firstRing; ring <= maxRing; ++ring) {
+		const int64_t fromX = std::max<int64_t>(cx - ring, floor.minCell.x), toX = std::min<int64_t>(cx + ring, floor.maxCell.x);
+		const int64_t fromY = std::max<int64_t>(cy - ring + 1, floor.minCell.y), toY = std::min<int64_t>(cy + ring - 1, floor.maxCell.y);
+		// top and bottom rows of the ring
+		for(int64_t y : {cy - ring, cy + ring}) {
+			if(y < floor.minCell.y || y > floor.maxCell.y) { continue; }
+			for(int64_t x = fromX; x <= toX; ++x) { visitCell(x, y); }
+			if(ring == 0) { break; }
+		}
+		// left and right columns, without the corners
+		for(int64_t x : {cx - ring, cx + ring}) {
+			if(ring == 0 || x < floor.minCell.x || x > floor.maxCell.x) { continue; }
+			for(int64_t y = fromY; y <= toY; ++y) { visitCell(x, y); }
+		}
+
+		if(closest.results.size() >= k) {
+			std::vector<SpatialQueryResult> best = closest.sorted(k);
+			if(best.back().distance <= static_cast<double>(ring) * cellSize) { return best; }
+		}
+	}
+	return closest.sorted(k);
+}
+
+FingerprintSpatialIndex::CellCoord FingerprintSpatialIndex::cellOf(const std::array<double, 3>& position) const {
+	auto toCell = [&](double value) {
+		double cell = std::floor(value / cellSize);
+		return static_cast<int32_t>(std::clamp(cell, static_cast<double>(INT32_MIN), static_cast<double>(INT32_MAX)));
+	};
+	return { toCell(position[0]), toCell(position[1]) };
+}
+
+}
@@ -0,0 +1,158 @@
+#ifdef SENSORREADOUT_WITH_ZLIB
+
+#include <sensorreadout/GzipInputStream.h>
+#include <sensorreadout/Assert.h>
+
+#include <zlib.h>
+
+namespace SensorReadoutParser {
+
+// ###########
+// # GzipStreamBuffer
+// ######################
+
+GzipStreamBuffer::GzipStreamBuffer(std::istream& source, size_t blockSize) : source(source), blockSize(blockSize) {
+	exceptWhen(blockSize == 0, "Block size has to be larger than 0");
+	decompressThread = std::thread(&GzipStreamBuffer::decompress, this);
+}
+
+GzipStreamBuffer::~GzipStreamBuffer() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopRequested = true;
+	}
+	slotAvailable.notify_all();
+	decompressThread.join();
+}
+
+bool GzipStreamBuffer::pushBlock(std::string&& block) {
+	std::unique_lock<std::mutex> lock(mutex);
+	slotAvailable.wait(lock, [&]() { return filledBlocks.size() < QUEUE_DEPTH || stopRequested; });
+	if(stopRequested) { return false; }
+	filledBlocks.push_back(std::move(block));
+	blockAvailable.notify_one();
+	return true;
+}
+
+void GzipStreamBuffer::decompress() {
+	auto nextFreeBlock = [&]() {
+		std::lock_guard<std::mutex> lock(mutex);
+		std::string result;
+		if(!freeBlocks.empty()) {
+			result = std::move(freeBlocks.back());
+			freeBlocks.pop_back();
+		}
+		result.resize(blockSize);
+		return result;
+	};
+
+	z_stream zStream = {};
+	// windowBits 15 + 32: automatically detect gzip and zlib headers
+	if(inflateInit2(&zStream, 15 + 32) != Z_OK) {
+		std::lock_guard<std::mutex> lock(mutex);
+		error = std::make_exception_ptr(std::runtime_error("Failed to initialize zlib"));
+		finished = true;
+		blockAvailable.notify_one();
+		return;
+	}
+	try {
+		std::vector<char> input(std::min<size_t>(blockSize, 256 * 1024));
+		std::string block = nextFreeBlock();
+		size_t blockFill = 0;
+		bool memberEnd = false;
+		while(true) {
+			if(zStream.avail_in == 0) {
+				source.read(input.data(), input.size());
+				exceptWhen(source.bad(), "An error occured while reading the compressed file.");
+				zStream.next_in = reinterpret_cast<Bytef*>(input.data());
+				zStream.avail_in = static_cast<uInt>(source.gcount());
+				if(zStream.avail_in == 0) {
+					exceptAssert(memberEnd, "Unexpected end of compressed file");
+					break;
+				}
+			}
+			if(memberEnd) { // there is more input after the end of a gzip member: concatenated members
+				exceptAssert(inflateReset(&zStream) == Z_OK, "Failed to reset zlib");
+				memberEnd = false;
+			}
+			zStream.next_out = reinterpret_cast<Bytef*>(block.data() + blockFill);
+			zStream.avail_out = static_cast<uInt>(blockSize - blockFill);
+			int ret = inflate(&zStream, Z_NO_FLUSH);
+			exceptWhen(ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR,
+					std::string("Decompression failed: ") + ((zStream.msg != nullptr) ? zStream.msg : "unknown error"));
+			memberEnd = (ret == Z_STREAM_END);
+			blockFill = blockSize - zStream.avail_out;
+			if(blockFill == blockSize) {
+				if(!pushBlock(std::move(block))) { break; }
+				block = nextFreeBlock();
+				blockFill = 0;
+			}
+		}
+		if(blockFill > 0) {
+			block.resize(blockFill);
+			pushBlock(std::move(block));
+		}
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(mutex);
+		error = std::current_exception();
+	}
+	inflateEnd(&zStream);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	finished = true;
+	blockAvailable.notify_one();
+}
+
+GzipStreamBuffer::int_type GzipStreamBuffer::underflow() {
+	if(gptr() < egptr()) { return traits_type::to_int_type(*gptr()); }
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if(currentBlock.capacity() > 0) { freeBlocks.push_back(std::move(currentBlock)); }
+		currentBlock = std::string();
+		blockAvailable.wait(lock, [&]() { return !filledBlocks.empty() || finished; });
+		if(filledBlocks.empty()) {
+			if(error) { std::rethrow_exception(error); }
+			return traits_type::eof();
+		}
+		currentBlock = std::move(filledBlocks.front());
+		filledBlocks.pop_front();
+	}
+	slotAvailable.notify_one();
+	setg(currentBlock.data(), currentBlock.data(), currentBlock.data() + currentBlock.size());
+	return traits_type::to_int_type(*gptr());
+}
+
+
+// ###########
+// # GzipInputStream
+// ######################
+
+GzipInputStream::GzipInputStream(const std::string& filePath, size_t blockSize)
+		: std::istream(nullptr), file(std::make_unique<std::ifstream>(filePath, std::ios::binary)) {
+	exceptAssert(file->is_open(), "Failed to open compressed file: " + filePath);
+	buffer = std::make_unique<GzipStreamBuffer>(*file, blockSize);
+	rdbuf(buffer.get());
+	// rethrow decompression errors instead of silently ending the stream
+	exceptions(std::ios::badbit);
+}
+
+GzipInputStream::GzipInputStream(std::istream& source, size_t blockSize)
+		: std::istream(nullptr), buffer(std::make_unique<GzipStreamBuffer>(source, blockSize)) {
+	rdbuf(buffer.get());
+	exceptions(std::ios::badbit);
+}
+
+bool GzipInputStream::isGzip(std::istream& stream) {
+	int first = stream.get();
+	if(first == std::istream::traits_type::eof()) {
+		stream.clear();
+		return false;
+	}
+	int second = stream.peek();
+	stream.unget();
+	return first == 0x1f && second == 0x8b;
+}
+
+}
+
+#endif
@@ -0,0 +1,42 @@
+#include <sensorreadout/MacDictionary.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace SensorReadoutParser {
+
+MacDictionary::MacDictionary(size_t expectedMacCnt) {
+	rehash(std::bit_ceil(std::max(MIN_CAPACITY, expectedMacCnt * 2)));
+}
+
+void MacDictionary::clear() {
+	macs.clear();
+	slots.clear();
+	rehash(MIN_CAPACITY);
+}
+
+void MacDictionary::rehash(size_t capacity) {
+	std::vector<Slot> oldSlots(capacity);
+	std::swap(slots, oldSlots);
+	slotBits = static_cast<unsigned>(std::countr_zero(capacity));
+	for(const Slot& oldSlot : oldSlots) {
+		if(oldSlot.key == EMPTY_KEY) { continue; }
+		size_t slotIdx = slotOf(oldSlot.key);
+		while(slots[slotIdx].key != EMPTY_KEY) { slotIdx = (slotIdx + 1) & (slots.size() - 1); }
+		slots[slotIdx] = oldSlot;
+	}
+}
+
+void MacDictionary::assignIds(SensorEvent& evt) {
+	switch(evt.eventType) {
+		case EventType::Wifi:
+			for(auto& advertisement : std::get<WifiEvent>(evt.data).advertisements) { advertisement.macId = intern(advertisement.mac); }
+			break;
+		case EventType::BLE: { auto& data = std::get<BLEEvent>(evt.data); data.macId = intern(data.mac); break; }
+		case EventType::WifiRTT: { auto& data = std::get<WifiRTTEvent>(evt.data); data.macId = intern(data.mac); break; }
+		case EventType::EddystoneUID: { auto& data = std::get<EddystoneUIDEvent>(evt.data); data.macId = intern(data.mac); break; }
+		default: break;
+	}
+}
+
+}
@@ -0,0 +1,102 @@
+#include <sensorreadout/MappedVisitingParser.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SensorReadoutParser {
+
+// ###########
+// # MappedFile
+// ######################
+
+MappedFile::MappedFile(const std::string& filePath) {
+	int fd = ::open(filePath.c_str(), O_RDONLY);
+	exceptWhen(fd < 0, "Failed to open file for mapping: " + filePath);
+	struct stat fileStat;
+	if(::fstat(fd, &fileStat) != 0) {
+		::close(fd);
+		throw std::runtime_error("Failed to stat file for mapping: " + filePath);
+	}
+	size = static_cast<size_t>(fileStat.st_size);
+	if(size > 0) { // mapping an empty file is not allowed
+		void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(mapped == MAP_FAILED) {
+			::close(fd);
+			throw std::runtime_error("Failed to map file: " + filePath);
+		}
+		// we are going to scan through the file once, front to back
+		::madvise(mapped, size, MADV_SEQUENTIAL);
+		data = static_cast<const char*>(mapped);
+	}
+	::close(fd);
+}
+
+MappedFile::MappedFile(MappedFile&& o) noexcept : data(o.data), size(o.size) {
+	o.data = nullptr;
+	o.size = 0;
+}
+
+MappedFile::~MappedFile() {
+	if(data != nullptr) {
+		::munmap(const_cast<char*>(data), size);
+	}
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+	std::swap(data, o.data);
+	std::swap(size, o.size);
+	return *this;
+}
+
+
+// ###########
+// # MappedVisitingParser
+// ######################
+
+MappedVisitingParser::MappedVisitingParser(const std::string& filePath, FileVersion fileVersion)
+	: mapping(std::in_place, filePath), buffer(mapping->view()), fileVersion(fileVersion) {}
+
+void MappedVisitingParser::indexWindow(size_t windowBase, size_t windowSize) {
+	indexBase = windowBase;
+	separatorIndex.build(buffer.substr(windowBase, windowSize));
+}
+
+bool MappedVisitingParser::nextLine(RawSensorEventView& sensorEvent) {
+	do {
+		if(!nextAnyLine(sensorEvent)) { return false; }
+	} while(eventFilter && !eventFilter->accepts(sensorEvent.eventId));
+	return true;
+}
+
+bool MappedVisitingParser::nextAnyLine(RawSensorEventView& sensorEvent) {
+	if(ptr >= buffer.size()) { return false; }
+	size_t windowEnd = indexBase + separatorIndex.size();
+	if(ptr >= windowEnd) {
+		indexWindow(ptr, INDEX_WINDOW_SIZE);
+		windowEnd = indexBase + separatorIndex.size();
+	}
+	size_t lineEnd = separatorIndex.nextLineSeparator(ptr - indexBase);
+	while(lineEnd == std::string_view::npos && windowEnd < buffer.size()) {
+		// line crosses the indexed window, re-index starting at this line (with a larger window if required)
+		indexWindow(ptr, std::max(INDEX_WINDOW_SIZE, 2 * (windowEnd - ptr)));
+		windowEnd = indexBase + separatorIndex.size();
+		lineEnd = separatorIndex.nextLineSeparator(0);
+	}
+	lineEnd = (lineEnd == std::string_view::npos) ? buffer.size() : (indexBase + lineEnd);
+
+	// the first two field separators are within [ptr, lineEnd) if the line is valid
+	auto lineRelativeSeparator = [&](size_t from) -> size_t {
+		size_t sepIdx = separatorIndex.nextFieldSeparator(from - indexBase);
+		if(sepIdx == std::string_view::npos || indexBase + sepIdx >= lineEnd) { return std::string_view::npos; }
+		return indexBase + sepIdx - ptr;
+	};
+	size_t dIdx = lineRelativeSeparator(ptr);
+	size_t dIdx2 = (dIdx == std::string_view::npos) ? dIdx : lineRelativeSeparator(ptr + dIdx + 1);
+	_internal::parseEventLine(buffer.substr(ptr, lineEnd - ptr), dIdx, dIdx2, fileVersion, sensorEvent);
+	ptr = lineEnd + 1;
+	return true;
+}
+
+}
@@ -0,0 +1,43 @@
+#include <sensorreadout/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SensorReadoutParser {
+
+namespace _internal {
+
+	void parallelFor(size_t taskCnt, size_t threadCnt, const std::function<void(size_t)>& task) {
+		if(threadCnt == 0) { threadCnt = std::max(1u, std::thread::hardware_concurrency()); }
+		threadCnt = std::min(threadCnt, taskCnt);
+		if(threadCnt <= 1) {
+			for(size_t i = 0; i < taskCnt; ++i) { task(i); }
+			return;
+		}
+		std::atomic<size_t> nextTask = 0;
+		std::mutex errorMutex;
+		std::exception_ptr error;
+		auto worker = [&]() {
+			for(size_t i = nextTask++; i < taskCnt; i = nextTask++) {
+				try {
+					task(i);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(errorMutex);
+					if(!error) { error = std::current_exception(); }
+					nextTask = taskCnt;
+				}
+			}
+		};
+		std::vector<std::thread> workers;
+		for(size_t i = 0; i < threadCnt; ++i) { workers.emplace_back(worker); }
+		for(auto& workerThread : workers) { workerThread.join(); }
+		if(error) { std::rethrow_exception(error); }
+	}
+
+}
+
+}
@@ -0,0 +1,113 @@
+#include <sensorreadout/Pipeline.h>
+#include <sensorreadout/MappedVisitingParser.h>
+
+namespace SensorReadoutParser {
+
+ParsePipeline::ParsePipeline(VisitingParser& parser, const PipelineOptions& options) : parser(parser), options(options) {
+	exceptWhen(options.chunkSize == 0, "Chunk size has to be larger than 0");
+	exceptWhen(options.queueDepth == 0, "Queue depth has to be larger than 0");
+	if(this->options.parserCnt == 0) {
+		this->options.parserCnt = std::max(2u, std::thread::hardware_concurrency()) - 1;
+	}
+}
+
+void ParsePipeline::abort(std::exception_ptr exception) {
+	std::lock_guard<std::mutex> lock(errorMutex);
+	if(!error) { error = exception; }
+	stop();
+}
+
+void ParsePipeline::stop() {
+	aborted.store(true, std::memory_order_release);
+	for(auto& lane : lanes) {
+		lane->chunks.notify();
+		lane->batches.notify();
+	}
+}
+
+template<typename T>
+bool ParsePipeline::push(SPSCQueue<T>& queue, T& value) {
+	bool pushed = false;
+	queue.waitFor([&]() { return (pushed = queue.tryPush(value)) || aborted.load(std::memory_order_acquire); });
+	return pushed;
+}
+
+template<typename T>
+bool ParsePipeline::pop(SPSCQueue<T>& queue, T& value) {
+	bool popped = false;
+	queue.waitFor([&]() {
+		return aborted.load(std::memory_order_acquire) || (popped = queue.tryPop(value)) || queue.isDrained();
+	});
+	return popped;
+}
+
+void ParsePipeline::readStage() {
+	try {
+		for(size_t laneIdx = 0; !aborted.load(std::memory_order_acquire); laneIdx = (laneIdx + 1) % lanes.size()) {
+			Lane& lane = *lanes[laneIdx];
+			std::string chunk;
+			lane.freeChunks.tryPop(chunk);
+			if(!parser.nextChunk(chunk, options.chunkSize)) { break; }
+			if(!push(lane.chunks, chunk)) { break; }
+		}
+	} catch (...) {
+		abort(std::current_exception());
+	}
+	for(auto& lane : lanes) { lane->chunks.close(); }
+}
+
+void ParsePipeline::parseStage(Lane& lane) {
+	try {
+		std::string chunk;
+		while(pop(lane.chunks, chunk)) {
+			EventBatch batch;
+			lane.freeBatches.tryPop(batch);
+			batch.clear();
+			auto chunkParser = MappedVisitingParser::fromBuffer(chunk, parser.getFileVersion());
+			chunkParser.setEventFilter(parser.getEventFilter());
+			RawSensorEventView rawSensorEvent;
+			while(chunkParser.nextLine(rawSensorEvent)) {
+				batch.push_back(SensorEvent::parse(rawSensorEvent));
+			}
+			lane.freeChunks.tryPush(chunk);
+			if(!push(lane.batches, batch)) { break; }
+		}
+	} catch (...) {
+		abort(std::current_exception());
+	}
+	lane.batches.close();
+}
+
+size_t ParsePipeline::run(const Consumer& consumer) {
+	lanes.clear();
+	for(size_t i = 0; i < options.parserCnt; ++i) { lanes.push_back(std::make_unique<Lane>(options.queueDepth)); }
+	aborted = false;
+	error = nullptr;
+
+	std::vector<std::thread> threads;
+	threads.emplace_back(&ParsePipeline::readStage, this);
+	for(auto& lane : lanes) { threads.emplace_back(&ParsePipeline::parseStage, this, std::ref(*lane)); }
+
+	// consume the batches in the round-robin order in which the chunks were distributed
+	size_t eventCnt = 0;
+	try {
+		EventBatch batch;
+		// the first lane without a further batch marks the end of the recording
+		for(size_t laneIdx = 0; pop(lanes[laneIdx]->batches, batch);) {
+			Lane& lane = *lanes[laneIdx];
+			for(const auto& sensorEvent : batch) { consumer(sensorEvent); }
+			eventCnt += batch.size();
+			lane.freeBatches.tryPush(batch);
+			laneIdx = (laneIdx + 1) % lanes.size();
+		}
+	} catch (...) {
+		abort(std::current_exception());
+	}
+	// stop the producers, in case the consumer ended early
+	stop();
+	for(auto& thread : threads) { thread.join(); }
+	if(error) { std::rethrow_exception(error); }
+	return eventCnt;
+}
+
+}
@@ -0,0 +1,266 @@
+#include <sensorreadout/RecordingIndex.h>
+#include <sensorreadout/MappedVisitingParser.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace SensorReadoutParser {
+
+namespace {
+	constexpr std::string_view INDEX_MAGIC = "SRIX";
+	constexpr uint16_t INDEX_FORMAT_VERSION = 2;
+	constexpr uint16_t INDEX_BYTE_ORDER_MARK = 0x0102;
+	/** Amount of bytes at the start and at the end of a recording that are hashed to detect modifications */
+	constexpr size_t HASHED_BYTE_CNT = 4096;
+
+	/** FNV-1a over the head and the tail of the recording. Appending to or rewriting a recording changes at least one of them. */
+	uint64_t hashRecording(std::string_view recording) {
+		uint64_t hash = 0xCBF29CE484222325ull;
+		auto hashBytes = [&](std::string_view bytes) {
+			for(char c : bytes) { hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull; }
+		};
+		const size_t hashedCnt = std::min(HASHED_BYTE_CNT, recording.size());
+		hashBytes(recording.substr(0, hashedCnt));
+		hashBytes(recording.substr(recording.size() - hashedCnt));
+		return hash;
+	}
+
+	int64_t modificationTimeOf(const std::string& path) {
+		return static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+	}
+
+	template<typename T>
+	void writePod(std::ostream& stream, const T& value) {
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+	template<typename T>
+	void writePodArray(std::ostream& stream, const std::vector<T>& values) {
+		writePod<uint64_t>(stream, values.size());
+		stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+	}
+
+	template<typename T>
+	T readPod(std::istream& stream) {
+		T value;
+		stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+		exceptAssert(stream.gcount() == sizeof(T), "Truncated index file");
+		return value;
+	}
+	void checkEventId(EventId eventId) {
+		exceptAssert(eventId >= EVENTID_RECORDING_ID && eventId <= EVENTID_PREDICTED_POS, "Invalid event id in index file");
+	}
+	/** Read a length-prefixed array, whose length is bounded by the remaining bytes of the streamSize bytes long stream */
+	template<typename T>
+	void readPodArray(std::istream& stream, uint64_t streamSize, std::vector<T>& values) {
+		uint64_t cnt = readPod<uint64_t>(stream);
+		exceptAssert(cnt <= (streamSize - static_cast<uint64_t>(stream.tellg())) / sizeof(T), "Truncated index file");
+		values.resize(cnt);
+		stream.read(reinterpret_cast<char*>(values.data()), cnt * sizeof(T));
+		exceptAssert(static_cast<uint64_t>(stream.gcount()) == cnt * sizeof(T), "Truncated index file");
+	}
+}
+
+// ###########
+// # RecordingIndex
+// ######################
+
+RecordingIndex RecordingIndex::buildFromBuffer(std::string_view recording, FileVersion fileVersion, const RecordingIndexOptions& options) {
+	exceptWhen(options.blockLineCnt == 0, "Block line count has to be larger than 0");
+	RecordingIndex result;
+	result.recordingSize = recording.size();
+	result.recordingHash = hashRecording(recording);
+	result.fileVersion = fileVersion;
+	result.options = options;
+
+	// collect the timestamp bounds of every single block first, then accumulate them over the blocks
+	std::vector<Timestamp> blockMins;
+	std::vector<Timestamp> blockMaxs;
+	MappedVisitingParser parser = MappedVisitingParser::fromBuffer(recording, fileVersion);
+	RawSensorEventView rawEvent;
+	for(uint64_t offset = parser.position(); parser.nextLine(rawEvent); offset = parser.position(), ++result.lineCnt) {
+		if(result.lineCnt % options.blockLineCnt == 0) {
+			result.blocks.push_back(Block { offset, 0, 0 });
+			blockMins.push_back(rawEvent.timestamp);
+			blockMaxs.push_back(rawEvent.timestamp);
+		}
+		blockMins.back() = std::min(blockMins.back(), rawEvent.timestamp);
+		blockMaxs.back() = std::max(blockMaxs.back(), rawEvent.timestamp);
+		if(!options.indexedEventTypes || options.indexedEventTypes->accepts(rawEvent.eventId)) {
+			result.eventEntries[rawEvent.eventId].push_back(EventEntry { rawEvent.timestamp, offset });
+		}
+	}
+
+	Timestamp maxTimestamp = std::numeric_limits<Timestamp>::min();
+	for(size_t i = 0; i < result.blocks.size(); ++i) {
+		maxTimestamp = std::max(maxTimestamp, blockMaxs[i]);
+		result.blocks[i].maxTimestampUpTo = maxTimestamp;
+	}
+	Timestamp minTimestamp = std::numeric_limits<Timestamp>::max();
+	for(size_t i = result.blocks.size(); i-- > 0;) {
+		minTimestamp = std::min(minTimestamp, blockMins[i]);
+		result.blocks[i].minTimestampFrom = minTimestamp;
+	}
+	return result;
+}
+
+RecordingIndex RecordingIndex::build(const std::string& recordingPath, FileVersion fileVersion, const RecordingIndexOptions& options) {
+	const int64_t mtime = modificationTimeOf(recordingPath);
+	MappedFile recording(recordingPath);
+	RecordingIndex result = buildFromBuffer(recording.view(), fileVersion, options);
+	result.recordingMTime = mtime;
+	return result;
+}
+
+void RecordingIndex::save(const std::string& indexPath) const {
+	std::ofstream stream(indexPath, std::ios::binary | std::ios::trunc);
+	exceptAssert(stream.is_open(), "Failed to open index file for writing: " + indexPath);
+	stream.write(INDEX_MAGIC.data(), INDEX_MAGIC.size());
+	writePod(stream, INDEX_FORMAT_VERSION);
+	writePod(stream, INDEX_BYTE_ORDER_MARK);
+	writePod(stream, recordingSize);
+	writePod(stream, recordingMTime);
+	writePod(stream, recordingHash);
+	writePod(stream, static_cast<uint8_t>(fileVersion));
+	writePod<uint64_t>(stream, options.blockLineCnt);
+	writePod<uint8_t>(stream, options.indexedEventTypes.has_value());
+	if(options.indexedEventTypes) {
+		std::vector<EventId> indexedEventIds;
+		for(EventId eventId = EVENTID_RECORDING_ID; eventId <= EVENTID_PREDICTED_POS; ++eventId) {
+			if(options.indexedEventTypes->accepts(eventId)) { indexedEventIds.push_back(eventId); }
+		}
+		writePodArray(stream, indexedEventIds);
+	}
+	writePod(stream, lineCnt);
+	writePodArray(stream, blocks);
+	writePod<uint64_t>(stream, eventEntries.size());
+	for(const auto& [eventId, entries] : eventEntries) {
+		writePod(stream, eventId);
+		writePodArray(stream, entries);
+	}
+	stream.flush();
+	exceptAssert(stream.good(), "I/O error");
+}
+
+RecordingIndex RecordingIndex::load(const std::string& indexPath) {
+	std::ifstream stream(indexPath, std::ios::binary);
+	exceptAssert(stream.is_open(), "Failed to open index file: " + indexPath);
+	const uint64_t streamSize = std::filesystem::file_size(indexPath);
+	char magic[4];
+	stream.read(magic, sizeof(magic));
+	exceptAssert(stream.gcount() == sizeof(magic) && std::string_view(magic, sizeof(magic)) == INDEX_MAGIC, "Not a SensorReadout index file");
+	uint16_t formatVersion = readPod<uint16_t>(stream);
+	uint16_t byteOrderMark = readPod<uint16_t>(stream);
+	exceptAssert(byteOrderMark == INDEX_BYTE_ORDER_MARK, "Index file was written with a different byte order");
+	exceptAssert(formatVersion == INDEX_FORMAT_VERSION, "Unsupported index format version");
+
+	RecordingIndex result;
+	result.recordingSize = readPod<uint64_t>(stream);
+	result.recordingMTime = readPod<int64_t>(stream);
+	result.recordingHash = readPod<uint64_t>(stream);
+	uint8_t fileVersion = readPod<uint8_t>(stream);
+	exceptAssert(fileVersion <= static_cast<uint8_t>(FileVersion::V1), "Invalid file version in index file");
+	result.fileVersion = static_cast<FileVersion>(fileVersion);
+	result.options.blockLineCnt = readPod<uint64_t>(stream);
+	if(readPod<uint8_t>(stream)) {
+		std::vector<EventId> indexedEventIds;
+		readPodArray(stream, streamSize, indexedEventIds);
+		result.options.indexedEventTypes = EventTypeFilter();
+		for(EventId eventId : indexedEventIds) {
+			checkEventId(eventId);
+			result.options.indexedEventTypes->add(static_cast<EventType>(eventId));
+		}
+	}
+	result.lineCnt = readPod<uint64_t>(stream);
+	readPodArray(stream, streamSize, result.blocks);
+	uint64_t eventTypeCnt = readPod<uint64_t>(stream);
+	for(uint64_t i = 0; i < eventTypeCnt; ++i) {
+		EventId eventId = readPod<EventId>(stream);
+		checkEventId(eventId);
+		readPodArray(stream, streamSize, result.eventEntries[eventId]);
+	}
+	return result;
+}
+
+RecordingIndex RecordingIndex::loadOrBuild(const std::string& recordingPath, FileVersion fileVersion, const RecordingIndexOptions& options) {
+	std::string indexPath = sidecarPath(recordingPath);
+	if(std::filesystem::exists(indexPath)) {
+		std::optional<RecordingIndex> result;
+		try {
+			result = load(indexPath);
+		} catch(const std::runtime_error&) {} // unreadable (e.g. older format version) sidecars are rebuilt
+		if(result && result->fileVersion == fileVersion && result->options == options
+				&& result->recordingSize == std::filesystem::file_size(recordingPath)
+				&& result->recordingMTime == modificationTimeOf(recordingPath)
+				&& result->recordingHash == hashRecording(MappedFile(recordingPath).view())) {
+			return std::move(*result);
+		}
+	}
+	RecordingIndex result = build(recordingPath, fileVersion, options);
+	result.save(indexPath);
+	return result;
+}
+
+RecordingIndex::ByteRange RecordingIndex::timeRange(Timestamp begin, Timestamp end) const {
+	// all blocks before the first one whose maxTimestampUpTo reaches begin only contain earlier events,
+	// and all blocks starting at the first one whose minTimestampFrom reaches end only contain later events.
+	auto firstBlock = std::partition_point(blocks.begin(), blocks.end(), [&](const Block& block) { return block.maxTimestampUpTo < begin; });
+	auto lastBlock = std::partition_point(blocks.begin(), blocks.end(), [&](const Block& block) { return block.minTimestampFrom < end; });
+	uint64_t beginOffset = (firstBlock == blocks.end()) ? recordingSize : firstBlock->offset;
+	uint64_t endOffset = (lastBlock == blocks.end()) ? recordingSize : lastBlock->offset;
+	return ByteRange { beginOffset, std::max(beginOffset, endOffset) };
+}
+
+const std::vector<RecordingIndex::EventEntry>& RecordingIndex::events(EventType eventType) const {
+	static const std::vector<EventEntry> EMPTY;
+	auto it = eventEntries.find(static_cast<EventId>(eventType));
+	return (it == eventEntries.end()) ? EMPTY : it->second;
+}
+
+
+// ###########
+// # SeekableReader
+// ######################
+
+SeekableReader::SeekableReader(std::istream& stream, const RecordingIndex& index, FileVersion fileVersion)
+		: stream(stream), index(index), fileVersion(fileVersion) {
+	stream.seekg(0, std::ios::end);
+	exceptAssert(static_cast<uint64_t>(stream.tellg()) == index.getRecordingSize(), "Index does not belong to the given recording");
+}
+
+VisitingParser SeekableReader::parserAtOffset(uint64_t offset) {
+	exceptWhen(offset > index.getRecordingSize(), "Offset is outside of the recording");
+	stream.clear();
+	stream.seekg(offset);
+	exceptAssert(stream.good(), "Seeking within the recording failed");
+	return VisitingParser(stream, fileVersion);
+}
+
+VisitingParser SeekableReader::parserAtTime(Timestamp timestamp) {
+	return parserAtOffset(index.offsetOf(timestamp));
+}
+
+std::vector<RawSensorEvent> SeekableReader::query(Timestamp begin, Timestamp end, const std::optional<EventTypeFilter>& eventFilter) {
+	std::vector<RawSensorEvent> result;
+	RecordingIndex::ByteRange range = index.timeRange(begin, end);
+	if(range.empty()) { return result; }
+
+	rangeBuffer.resize(range.end - range.begin);
+	stream.clear();
+	stream.seekg(range.begin);
+	stream.read(rangeBuffer.data(), rangeBuffer.size());
+	exceptAssert(static_cast<size_t>(stream.gcount()) == rangeBuffer.size(), "Reading from the recording failed");
+
+	MappedVisitingParser parser = MappedVisitingParser::fromBuffer(rangeBuffer, fileVersion);
+	parser.setEventFilter(eventFilter);
+	RawSensorEventView rawEvent;
+	while(parser.nextLine(rawEvent)) {
+		if(rawEvent.timestamp >= begin && rawEvent.timestamp < end) {
+			result.push_back(RawSensorEvent { rawEvent.timestamp, rawEvent.eventId, std::string(rawEvent.parameterString) });
+		}
+	}
+	return result;
+}
+
+}
@@ -0,0 +1,209 @@
+#include <sensorreadout/RecordingStatistics.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace SensorReadoutParser {
+
+namespace {
+
+	template<typename TEvent>
+	void pushValues(const TEvent& evt, std::vector<ValueStatistics>& values) {
+		const auto* evtValues = &evt.template getValue<0>();
+		values.resize(TEvent::VALUE_CNT);
+		for(size_t i = 0; i < TEvent::VALUE_CNT; ++i) {
+			values[i].push(static_cast<double>(evtValues[i]));
+		}
+	}
+
+}
+
+
+// ###########
+// # ValueStatistics
+// ######################
+
+void ValueStatistics::merge(const ValueStatistics& o) {
+	if(o.count == 0) { return; }
+	if(count == 0) {
+		*this = o;
+		return;
+	}
+	const double totalCnt = static_cast<double>(count + o.count);
+	const double delta = o.mean - mean;
+	mean += delta * static_cast<double>(o.count) / totalCnt;
+	m2 += o.m2 + delta * delta * static_cast<double>(count) * static_cast<double>(o.count) / totalCnt;
+	count += o.count;
+	min = std::min(min, o.min);
+	max = std::max(max, o.max);
+}
+
+double ValueStatistics::stddev() const { return std::sqrt(variance()); }
+
+
+// ###########
+// # EventTypeStatistics
+// ######################
+
+void EventTypeStatistics::pushInterval(Timestamp start, Timestamp interval) {
+	intervals.push(static_cast<double>(interval));
+	intervalHistogram[std::min<size_t>(std::bit_width(interval), INTERVAL_BUCKET_CNT - 1)] += 1;
+	if(largestGaps.size() == LARGEST_GAP_CNT && largestGaps.back().duration >= interval) { return; }
+	auto pos = std::find_if(largestGaps.begin(), largestGaps.end(), [&](const Gap& gap) { return gap.duration < interval; });
+	largestGaps.insert(pos, Gap { start, interval });
+	if(largestGaps.size() > LARGEST_GAP_CNT) { largestGaps.pop_back(); }
+}
+
+void EventTypeStatistics::pushTimestamp(Timestamp timestamp) {
+	if(eventCnt == 0) {
+		firstTimestamp = timestamp;
+	} else if(timestamp < lastTimestamp) {
+		++outOfOrderCnt;
+	} else {
+		pushInterval(lastTimestamp, timestamp - lastTimestamp);
+	}
+	++eventCnt;
+	lastTimestamp = timestamp;
+}
+
+void EventTypeStatistics::pushMac(const MacAddress& mac) {
+	macs.insert(mac.toUInt64());
+}
+
+void EventTypeStatistics::merge(const EventTypeStatistics& o) {
+	if(o.eventCnt == 0) { return; }
+	if(eventCnt == 0) {
+		*this = o;
+		return;
+	}
+	// the interval across the chunk border
+	if(o.firstTimestamp < lastTimestamp) {
+		++outOfOrderCnt;
+	} else {
+		pushInterval(lastTimestamp, o.firstTimestamp - lastTimestamp);
+	}
+	eventCnt += o.eventCnt;
+	lastTimestamp = o.lastTimestamp;
+	outOfOrderCnt += o.outOfOrderCnt;
+	intervals.merge(o.intervals);
+	for(size_t i = 0; i < INTERVAL_BUCKET_CNT; ++i) { intervalHistogram[i] += o.intervalHistogram[i]; }
+	largestGaps.insert(largestGaps.end(), o.largestGaps.begin(), o.largestGaps.end());
+	std::stable_sort(largestGaps.begin(), largestGaps.end(), [](const Gap& a, const Gap& b) { return a.duration > b.duration; });
+	if(largestGaps.size() > LARGEST_GAP_CNT) { largestGaps.resize(LARGEST_GAP_CNT); }
+	values.resize(std::max(values.size(), o.values.size()));
+	for(size_t i = 0; i < o.values.size(); ++i) { values[i].merge(o.values[i]); }
+	macs.insert(o.macs.begin(), o.macs.end());
+}
+
+double EventTypeStatistics::meanRate() const {
+	if(intervals.count == 0 || intervals.mean == 0) { return 0; }
+	return 1e9 / intervals.mean;
+}
+
+
+// ###########
+// # RecordingStatistics
+// ######################
+
+EventTypeStatistics& RecordingStatistics::pushTimestamp(EventType eventType, Timestamp timestamp) {
+	if(eventCnt == 0) {
+		firstTimestamp = lastTimestamp = timestamp;
+	} else {
+		firstTimestamp = std::min(firstTimestamp, timestamp);
+		lastTimestamp = std::max(lastTimestamp, timestamp);
+	}
+	++eventCnt;
+	EventTypeStatistics& result = eventTypes[eventType];
+	result.pushTimestamp(timestamp);
+	return result;
+}
+
+void RecordingStatistics::add(const RawSensorEventView& rawEvent) {
+	#define RECORDING_STATISTICS_PARSE_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			EvtStruct evt; \
+			evt.parse(rawEvent.parameterString); \
+			pushValues(evt, pushTimestamp(EvtType, rawEvent.timestamp).values); \
+			break; \
+		}
+
+	const EventType eventType = static_cast<EventType>(rawEvent.eventId);
+	switch(eventType) {
+		SENSORREADOUT_NUMERIC_EVENTS(RECORDING_STATISTICS_PARSE_CASE)
+		case EventType::Wifi: {
+			wifiAdvertisements.clear();
+			WifiEvent::parseAdvertisements(rawEvent.parameterString, wifiAdvertisements);
+			EventTypeStatistics& stats = pushTimestamp(eventType, rawEvent.timestamp);
+			for(const auto& advertisement : wifiAdvertisements) { stats.pushMac(advertisement.mac); }
+			break;
+		}
+		case EventType::BLE:
+		case EventType::WifiRTT:
+		case EventType::EddystoneUID:
+			add(SensorEvent::parse(rawEvent));
+			break;
+		default: pushTimestamp(eventType, rawEvent.timestamp); break;
+	}
+}
+
+void RecordingStatistics::add(const SensorEvent& evt) {
+	#define RECORDING_STATISTICS_PUSH_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			pushValues(std::get<EvtStruct>(evt.data), stats.values); \
+			break; \
+		}
+
+	EventTypeStatistics& stats = pushTimestamp(evt.eventType, evt.timestamp);
+	switch(evt.eventType) {
+		SENSORREADOUT_NUMERIC_EVENTS(RECORDING_STATISTICS_PUSH_CASE)
+		case EventType::Wifi: {
+			for(const auto& advertisement : std::get<WifiEvent>(evt.data).advertisements) { stats.pushMac(advertisement.mac); }
+			break;
+		}
+		case EventType::BLE: stats.pushMac(std::get<BLEEvent>(evt.data).mac); break;
+		case EventType::WifiRTT: stats.pushMac(std::get<WifiRTTEvent>(evt.data).mac); break;
+		case EventType::EddystoneUID: stats.pushMac(std::get<EddystoneUIDEvent>(evt.data).mac); break;
+		default: break;
+	}
+}
+
+void RecordingStatistics::merge(const RecordingStatistics& o) {
+	if(o.eventCnt == 0) { return; }
+	if(eventCnt == 0) {
+		firstTimestamp = o.firstTimestamp;
+		lastTimestamp = o.lastTimestamp;
+	} else {
+		firstTimestamp = std::min(firstTimestamp, o.firstTimestamp);
+		lastTimestamp = std::max(lastTimestamp, o.lastTimestamp);
+	}
+	eventCnt += o.eventCnt;
+	for(const auto& [eventType, stats] : o.eventTypes) {
+		eventTypes[eventType].merge(stats);
+	}
+}
+
+RecordingStatistics RecordingStatistics::compute(VisitingParser& parser) {
+	RecordingStatistics result;
+	RawSensorEvent rawEvent;
+	while(parser.nextLine(rawEvent)) {
+		result.add(RawSensorEventView(rawEvent));
+	}
+	return result;
+}
+
+RecordingStatistics RecordingStatistics::compute(MappedVisitingParser& parser) {
+	RecordingStatistics result;
+	RawSensorEventView rawEvent;
+	while(parser.nextLine(rawEvent)) {
+		result.add(rawEvent);
+	}
+	return result;
+}
+
+const EventTypeStatistics* RecordingStatistics::get(EventType eventType) const {
+	auto it = eventTypes.find(eventType);
+	return (it != eventTypes.end()) ? &it->second : nullptr;
+}
+
+}
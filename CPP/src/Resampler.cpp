@@ -0,0 +1,72 @@
+#include <sensorreadout/Resampler.h>
+#include <sensorreadout/Parallel.h>
+
+#include <limits>
+
+namespace SensorReadoutParser {
+
+namespace _internal {
+
+	void runTasks(const std::vector<std::function<void()>>& tasks, size_t threadCnt) {
+		parallelFor(tasks.size(), threadCnt, [&](size_t i) { tasks[i](); });
+	}
+
+	size_t resampledSampleCnt(Timestamp firstTs, Timestamp lastTs, Timestamp startTs, Timestamp interval) {
+		exceptWhen(interval == 0, "Resampling interval has to be larger than 0");
+		exceptWhen(startTs < firstTs, "Start timestamp has to be >= the first timestamp of the signal");
+		if(startTs > lastTs) { return 0; }
+		return (lastTs - startTs) / interval + 1;
+	}
+
+}
+
+
+// ###########
+// # ResampledRecording
+// ######################
+
+ResampledRecording ResampledRecording::resample(const ColumnarRecording& recording, Timestamp interval, const ResampleOptions& options) {
+	Timestamp startTs = 0;
+	recording.forEachNumericChannel([&](EventType, const auto& channel) {
+		using NumericValue = typename std::remove_cvref_t<decltype(channel)>::NumericValue;
+		if constexpr(std::is_floating_point_v<NumericValue>) {
+			if(!channel.empty()) { startTs = std::max(startTs, channel.timestamps.front()); }
+		}
+	});
+	return resample(recording, startTs, interval, options);
+}
+
+ResampledRecording ResampledRecording::resample(const ColumnarRecording& recording, Timestamp startTs, Timestamp interval, const ResampleOptions& options) {
+	ResampledRecording result;
+	result.startTs = startTs;
+	result.interval = interval;
+
+	// common amount of samples of all channels
+	size_t sampleCnt = std::numeric_limits<size_t>::max();
+	recording.forEachNumericChannel([&](EventType, const auto& channel) {
+		using NumericValue = typename std::remove_cvref_t<decltype(channel)>::NumericValue;
+		if constexpr(std::is_floating_point_v<NumericValue>) {
+			if(!channel.empty()) {
+				sampleCnt = std::min(sampleCnt, _internal::resampledSampleCnt(channel.timestamps.front(), channel.timestamps.back(), startTs, interval));
+			}
+		}
+	});
+	if(sampleCnt == std::numeric_limits<size_t>::max()) { return result; }
+	result.sampleCnt = sampleCnt;
+
+	// blocks of all channels are resampled on one pool of threads
+	std::vector<std::function<void()>> tasks;
+	recording.forEachNumericChannel([&](EventType, const auto& channel) {
+		using Channel = std::remove_cvref_t<decltype(channel)>;
+		if constexpr(std::is_floating_point_v<typename Channel::NumericValue>) {
+			if(!channel.empty()) {
+				auto& resampledChannel = std::get<ResampledChannel<typename Channel::Event>>(result.channels);
+				_internal::planResample(channel, startTs, interval, sampleCnt, options, resampledChannel, tasks);
+			}
+		}
+	});
+	_internal::runTasks(tasks, options.threadCnt);
+	return result;
+}
+
+}
@@ -1,7 +1,16 @@
 #include <sensorreadout/SensorReadoutParser.h>
+#include <sensorreadout/MappedVisitingParser.h>
+#include <sensorreadout/HexCodec.h>
+#include <sensorreadout/MacDictionary.h>
+#include <sensorreadout/SeparatorIndex.h>
 
+#include <algorithm>
+#include <bit>
 #include <charconv>
-#include <iomanip>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace SensorReadoutParser {
 
@@ -14,14 +23,7 @@ template<> UUID fromStringView<UUID>(const std::string_view& str) {
 	return UUID::fromString(str);
 }
 template<> HexString fromStringView<HexString>(const std::string_view& str) {
-	exceptAssert(str.size() % 2 == 0, "Invalid HexString!");
-	HexString result;
-	for (size_t i = 0; i < str.length(); i += 2) {
-		std::string byteString = std::string(str.substr(i, 2));
-		char byte = std::strtol(byteString.c_str(), NULL, 16);
-		result.data.push_back(byte);
-	}
-	return result;
+	return HexString { HexCodec::decode(str) };
 }
 template<> MacAddress fromStringView<MacAddress>(const std::string_view& str) {
 	if(str.length() == MacAddress::STRING_LENGTH_SHORT) {
@@ -31,42 +33,17 @@ template<> MacAddress fromStringView<MacAddress>(const std::string_view& str) {
 	}
 }
 
-std::string ParameterAssembler::str() const { return stream.str(); }
-// override for uint8_t because retarded c++ default stream outputs this
-// as character instead of as number
-template<> void ParameterAssembler::push<uint8_t>(uint8_t value) {
-	push<uint32_t>(value);
-}
 
 
 // ###########
 // # BaseTypes
 // ######################
-static uint8_t parseHexNibble(char hex) {
-	if(hex >= '0' && hex <= '9') {
-		return hex - '0';
-	} else if(hex >= 'A' && hex <= 'F') {
-		return hex - 'A' + 10;
-	} else if(hex >= 'a' || hex <= 'f') {
-		return hex - 'a' + 10;
-	}
-	exceptUnreachable("Invalid hex encountered");
-}
-
-std::ostream& operator<<(std::ostream& output, const HexString& self) {
-	output << std::hex << std::uppercase << std::setfill( '0' );
-	for( uint8_t b : self.data ) {
-		output << std::setw(2) << static_cast<uint16_t>(b);
-	}
-	return output;
-}
-
 UUID UUID::fromString(const std::string_view& uuidStr) {
-	// exceptAssert(uuidStr.size() == STRING_LENGTH, "Attempted to parse invalid UUID string");
+	exceptAssert(uuidStr.size() == STRING_LENGTH, "Attempted to parse invalid UUID string");
 	UUID result;
 	for(size_t bPtr = 0, cPtr = 0; cPtr < STRING_LENGTH;) {
 		if(uuidStr[cPtr] != '-') {
-			result.data[bPtr] = (parseHexNibble(uuidStr[cPtr]) << 4) | parseHexNibble(uuidStr[cPtr + 1]);
+			result.data[bPtr] = HexCodec::decodeByte(&uuidStr[cPtr]);
 			cPtr += 2;
 			bPtr += 1;
 		} else {
@@ -77,7 +54,7 @@ UUID UUID::fromString(const std::string_view& uuidStr) {
 }
 
 std::string UUID::toString() const {
-	static const char* charMap = "0123456789abcdef";
+	const char* charMap = HexCodec::LOWER_DIGITS;
 	std::string result(STRING_LENGTH, '-');
 #define PRINT_UUID_BYTE(i,o) result[(i)*2 + o] = charMap[data[(i)] >> 4]; result[(i)*2 + 1 + o] = charMap[data[(i)] & 0xF]
 	for(auto i = 0; i < 4; ++i) { PRINT_UUID_BYTE(i, 0); }
@@ -91,20 +68,17 @@ std::string UUID::toString() const {
 MacAddress MacAddress::fromString(const std::string_view& macStr) {
 	exceptAssert(macStr.size() == STRING_LENGTH_SHORT, "Undelimited MAC-Address string has to have correct length");
 	MacAddress res;
-	exceptAssert(
-				sscanf(macStr.data(), "%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx", &res[0], &res[1], &res[2], &res[3], &res[4], &res[5]) == 6,
-			"Parsing undelimited MAC-Address failed"
-			);
+	HexCodec::decode(macStr, res.mac);
 	return res;
 }
 
 MacAddress MacAddress::fromColonDelimitedString(const std::string_view& delimitedMacStr) {
 	exceptAssert(delimitedMacStr.size() == STRING_LENGTH_COLONDELIMITED, "Delimited MAC-Address string has to have correct length");
 	MacAddress res;
-	exceptAssert(
-				sscanf(delimitedMacStr.data(), "%2hhx:%2hhx:%2hhx:%2hhx:%2hhx:%2hhx", &res[0], &res[1], &res[2], &res[3], &res[4], &res[5]) == 6,
-			"Parsing colon delimited MAC-Address failed"
-			);
+	for(size_t i = 0; i < MAC_LENGTH; ++i) {
+		exceptAssert(i == 0 || delimitedMacStr[i * 3 - 1] == ':', "Parsing colon delimited MAC-Address failed");
+		res.mac[i] = HexCodec::decodeByte(&delimitedMacStr[i * 3]);
+	}
 	return res;
 }
 
@@ -117,34 +91,28 @@ uint8_t& MacAddress::operator[](size_t idx) {
 }
 
 std::string MacAddress::toString() const {
-	std::string macString;
-	macString.resize(STRING_LENGTH_SHORT);
-	for(size_t i = 0; i < MAC_LENGTH; ++i) {
-		sprintf(&macString[i * 2], "%02X", mac[i]);
-	}
-	return macString;
+	return HexCodec::encode(mac, MAC_LENGTH);
 }
 std::string MacAddress::toColonDelimitedString() const {
-	std::string macString;
-	macString.resize(STRING_LENGTH_COLONDELIMITED);
+	std::string macString(STRING_LENGTH_COLONDELIMITED, ':');
 	for(size_t i = 0; i < MAC_LENGTH; ++i) {
-		sprintf(&macString[i * 3], "%02X:", mac[i]);
+		HexCodec::encode(&mac[i], 1, &macString[i * 3]);
 	}
 	return macString;
 }
 
-bool MacAddress::operator==(const MacAddress& o) {
-	for(size_t i = 0; i < MAC_LENGTH; ++i) {
-		if(o.mac[i] != mac[i]) { return false; }
-	}
-	return true;
+bool MacAddress::operator==(const MacAddress& o) const {
+	return std::memcmp(mac, o.mac, MAC_LENGTH) == 0;
 }
 
 // ###########
 // # ParsedModels
 // ######################
 
-void WifiEvent::parse(const std::string& parameterString) {
+void WifiEvent::parse(const std::string_view& parameterString) {
+	parseAdvertisements(parameterString, advertisements);
+}
+void WifiEvent::parseAdvertisements(const std::string_view& parameterString, std::vector<WifiAdvertisement>& advertisements) {
 	Tokenizer<';'> tokenizer(parameterString);
 	WifiAdvertisement advertisement;
 
@@ -172,7 +140,7 @@ void WifiEvent::serializeInto(_internal::ParameterAssembler& stream) const {
 	}
 }
 
-void BLEEvent::parse(const std::string& parameterString) {
+void BLEEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	mac = tokenizer.nextAs<MacAddress>();
 	rssi = tokenizer.nextAs<Rssi>();
@@ -190,7 +158,7 @@ void BLEEvent::serializeInto(_internal::ParameterAssembler& stream) const {
 	}
 }
 
-void WifiRTTEvent::parse(const std::string& parameterString) {
+void WifiRTTEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	success = tokenizer.nextAs<bool>();
 	mac = tokenizer.nextAs<MacAddress>();
@@ -210,7 +178,7 @@ void WifiRTTEvent::serializeInto(_internal::ParameterAssembler& stream) const {
 	stream.push(numSuccessfull);
 }
 
-void EddystoneUIDEvent::parse(const std::string& parameterString) {
+void EddystoneUIDEvent::parse(const std::string_view& parameterString) {
 	exceptAssert(parameterString.size() > 32, "EddystoneUID event does not seem to have all required fields");
 	Tokenizer<';'> tokenizer(parameterString);
 	mac = tokenizer.nextAs<MacAddress>();
@@ -225,7 +193,7 @@ void EddystoneUIDEvent::serializeInto(_internal::ParameterAssembler& stream) con
 	stream.push(uid.toString());
 }
 
-void StepDetectorEvent::parse(const std::string& parameterString) {
+void StepDetectorEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	stepStartTs = tokenizer.nextAs<Timestamp>();
 	stepEndTs = tokenizer.nextAs<Timestamp>();
@@ -237,7 +205,7 @@ void StepDetectorEvent::serializeInto(_internal::ParameterAssembler& stream) con
 	stream.push(probability);
 }
 
-void FutureShapeSensFloorEvent::parse(const std::string& parameterString) {
+void FutureShapeSensFloorEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	roomId = tokenizer.nextAs<uint16_t>();
 	x = tokenizer.nextAs<uint8_t>();
@@ -255,7 +223,7 @@ void FutureShapeSensFloorEvent::serializeInto(_internal::ParameterAssembler& str
 	}
 }
 
-void MicrophoneMetadataEvent::parse(const std::string& parameterString) {
+void MicrophoneMetadataEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	channelCnt = tokenizer.nextAs<size_t>();
 	sampleRateHz = tokenizer.nextAs<size_t>();
@@ -267,7 +235,7 @@ void MicrophoneMetadataEvent::serializeInto(_internal::ParameterAssembler& strea
 	stream.push(sampleFormat);
 }
 
-void StepProbabilityEvent::parse(const std::string& parameterString) {
+void StepProbabilityEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	ts = tokenizer.nextAs<Timestamp>();
 	id = tokenizer.nextAs<size_t>();
@@ -279,7 +247,7 @@ void StepProbabilityEvent::serializeInto(_internal::ParameterAssembler& stream)
 	stream.push(probability);
 }
 
-void CIR5GEvent::parse(const std::string& parameterString) {
+void CIR5GEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	baseStationId = tokenizer.next();
 	real = tokenizer.nextAs<std::vector<float>>();
@@ -291,7 +259,7 @@ void CIR5GEvent::serializeInto(_internal::ParameterAssembler& stream) const {
 	stream.push(imag);
 }
 
-void DecawaveUWBEvent::parse(const std::string& parameterString) {
+void DecawaveUWBEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	// packet header (estimated position + quality)
 	x = tokenizer.nextAs<float>() / 1000.0; // mm to m
@@ -324,7 +292,7 @@ void DecawaveUWBEvent::serializeInto(_internal::ParameterAssembler& stream) cons
 	}
 }
 
-void PedestrianActivityEvent::parse(const std::string& parameterString) {
+void PedestrianActivityEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	rawActivityName = tokenizer.next();
 	rawActivityId = tokenizer.nextAs<PedestrianActivityId>();
@@ -335,7 +303,7 @@ void PedestrianActivityEvent::serializeInto(_internal::ParameterAssembler& strea
 	stream.push(rawActivityId);
 }
 
-void PosEvent::parse(const std::string& parameterString) {
+void PosEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	x = tokenizer.nextAs<float>();
 	y = tokenizer.nextAs<float>();
@@ -349,7 +317,7 @@ void PosEvent::serializeInto(_internal::ParameterAssembler& stream) const {
 	stream.push(floorIdx);
 }
 
-void FileMetadataEvent::parse(const std::string& parameterString) {
+void FileMetadataEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	date = tokenizer.next();
 	person = tokenizer.next();
@@ -362,14 +330,14 @@ void FileMetadataEvent::serializeInto(_internal::ParameterAssembler& stream) con
 	stream.push(comment);
 }
 
-void RecordingIdEvent::parse(const std::string& parameterString) {
+void RecordingIdEvent::parse(const std::string_view& parameterString) {
 	recordingId = UUID::fromString(parameterString);
 }
 void RecordingIdEvent::serializeInto(_internal::ParameterAssembler& stream) const {
 	stream.push(recordingId.toString());
 }
 
-void GroundTruthPathEvent::parse(const std::string& parameterString) {
+void GroundTruthPathEvent::parse(const std::string_view& parameterString) {
 	Tokenizer<';'> tokenizer(parameterString);
 	pathId = tokenizer.next();
 	groundTruthPointCnt = tokenizer.nextAs<size_t>();
@@ -380,7 +348,7 @@ void GroundTruthPathEvent::serializeInto(_internal::ParameterAssembler& stream)
 	stream.push(groundTruthPointCnt);
 }
 
-SensorEvent SensorEvent::parse(const RawSensorEvent& rawEvent) {
+SensorEvent SensorEvent::parse(const RawSensorEventView& rawEvent) {
 	#define SENSOR_EVENT_PARSE_CASE(EvtType, EvtStruct) \
 		case EvtType: { \
 			EvtStruct evt; \
@@ -435,16 +403,25 @@ SensorEvent SensorEvent::parse(const RawSensorEvent& rawEvent) {
 	return result;
 }
 
+SensorEvent SensorEvent::parse(const RawSensorEvent& rawEvent) {
+	return parse(RawSensorEventView(rawEvent));
+}
+
 void SensorEvent::serializeInto(RawSensorEvent& rawEvent) const {
+	rawEvent.eventId = static_cast<EventId>(eventType);
+	rawEvent.timestamp = timestamp;
+	_internal::ParameterAssembler parameterStream;
+	serializeParametersInto(parameterStream);
+	rawEvent.parameterString.assign(parameterStream.view());
+}
+
+void SensorEvent::serializeParametersInto(_internal::ParameterAssembler& parameterStream) const {
 	#define SENSOR_EVENT_SERIALIZE_INTO_CASE(EvtType, EvtStruct) \
 		case EvtType: { \
 			std::get<EvtStruct>(data).serializeInto(parameterStream); \
 			break; \
 		}
 
-	rawEvent.eventId = static_cast<EventId>(eventType);
-	rawEvent.timestamp = timestamp;
-	_internal::ParameterAssembler parameterStream;
 	switch(eventType) {
 		SENSOR_EVENT_SERIALIZE_INTO_CASE(EventType::Accelerometer, AccelerometerEvent)
 		SENSOR_EVENT_SERIALIZE_INTO_CASE(EventType::Gravity, GravityEvent)
@@ -482,7 +459,6 @@ void SensorEvent::serializeInto(RawSensorEvent& rawEvent) const {
 		SENSOR_EVENT_SERIALIZE_INTO_CASE(EventType::FileMetadata, FileMetadataEvent)
 		SENSOR_EVENT_SERIALIZE_INTO_CASE(EventType::RecordingId, RecordingIdEvent)
 	}
-	rawEvent.parameterString = parameterStream.str();
 }
 
 
@@ -491,18 +467,20 @@ void SensorEvent::serializeInto(RawSensorEvent& rawEvent) const {
 // # VisitingParser
 // ######################
 
-VisitingParser::VisitingParser(std::istream& stream, FileVersion fileVersion) : stream(stream), fileVersion(fileVersion) {}
+void _internal::parseEventLine(const std::string_view& line, FileVersion fileVersion, RawSensorEventView& sensorEvent) {
+	// timestamp and eventId practically always fit into the first SCAN_WIDTH bytes, so one vectorized
+	// compare yields both separators. Only longer heads fall back to searching the rest of the line.
+	uint64_t fieldMask = matchMask64(line.data(), std::min(SCAN_WIDTH, line.size()), ';');
+	std::string_view::size_type dIdx = (fieldMask != 0) ? std::countr_zero(fieldMask) : line.find(';', SCAN_WIDTH);
+	fieldMask &= fieldMask - 1;
+	std::string_view::size_type dIdx2 = (fieldMask != 0) ? std::countr_zero(fieldMask)
+		: (dIdx == std::string_view::npos) ? dIdx : line.find(';', std::max(dIdx + 1, SCAN_WIDTH));
+	parseEventLine(line, dIdx, dIdx2, fileVersion, sensorEvent);
+}
 
-bool VisitingParser::nextLine(RawSensorEvent& sensorEvent) {
-	if(!stream.good()) {
-		if(stream.fail()) { throw std::runtime_error("An error occured while reading the SensorReadout file."); }
-		return false;
-	}
-	std::string line;
-	if(!std::getline(stream, line)) { return false; }
-	std::string::size_type dIdx = line.find(';', 0);
+void _internal::parseEventLine(const std::string_view& line, size_t dIdx, size_t dIdx2, FileVersion fileVersion, RawSensorEventView& sensorEvent) {
 	exceptWhen( // First section empty - no timestamp
-		(dIdx == std::string::npos || dIdx < 1),
+		(dIdx == std::string_view::npos || dIdx < 1),
 	   "SensorReadout file corrupted. Empty timestamp section.");
 	exceptAssert(
 		std::from_chars(line.data(), line.data() + dIdx, sensorEvent.timestamp).ec == std::errc(),
@@ -510,17 +488,49 @@ bool VisitingParser::nextLine(RawSensorEvent& sensorEvent) {
 	if(fileVersion == FileVersion::V0) { // transform timestamp from ms to ns
 		sensorEvent.timestamp *= 1000000;
 	}
-	std::string::size_type dIdx2 = line.find(';', dIdx + 1);
 	exceptWhen( // Second section empty - no event id
-		(dIdx2 == std::string::npos || (dIdx2 - dIdx) < 2),
+		(dIdx2 == std::string_view::npos || (dIdx2 - dIdx) < 2),
 		"SensorReadout file corrupted. Empty eventId section.");
 	exceptAssert(
 		std::from_chars(line.data() + dIdx + 1, line.data() + dIdx2, sensorEvent.eventId).ec == std::errc(),
 		"EventId parsing error");
 	sensorEvent.parameterString = line.substr(dIdx2 + 1);
+}
+
+VisitingParser::VisitingParser(std::istream& stream, FileVersion fileVersion) : stream(stream), fileVersion(fileVersion) {}
+
+bool VisitingParser::nextLine(RawSensorEvent& sensorEvent) {
+	if(!stream.good()) {
+		if(stream.fail()) { throw std::runtime_error("An error occured while reading the SensorReadout file."); }
+		return false;
+	}
+	RawSensorEventView eventView;
+	do {
+		if(!std::getline(stream, lineBuffer)) { return false; }
+		parseEventLine(lineBuffer, fileVersion, eventView);
+	} while(eventFilter && !eventFilter->accepts(eventView.eventId));
+	sensorEvent.timestamp = eventView.timestamp;
+	sensorEvent.eventId = eventView.eventId;
+	sensorEvent.parameterString.assign(eventView.parameterString);
 	return true;
 }
 
+bool VisitingParser::nextChunk(std::string& chunk, size_t chunkSize) {
+	chunk.clear();
+	if(stream.eof()) { return false; }
+	exceptWhen(stream.bad(), "An error occured while reading the SensorReadout file.");
+	chunk.resize(chunkSize);
+	stream.read(chunk.data(), chunkSize);
+	chunk.resize(stream.gcount());
+	if(!stream.eof() && !chunk.empty() && chunk.back() != '\n') { // complete the last line
+		std::string lineRemainder;
+		std::getline(stream, lineRemainder);
+		chunk.append(lineRemainder);
+	}
+	exceptWhen(stream.bad(), "An error occured while reading the SensorReadout file.");
+	return !chunk.empty();
+}
+
 
 
 // ###########
@@ -534,6 +544,65 @@ AggregatingParser::AggregatedParseResult AggregatingParser::parse() {
 	RawSensorEvent rawSensorEvent;
 	while(parser.nextLine(rawSensorEvent)) {
 		result.push_back(SensorEvent::parse(rawSensorEvent));
+		if(macDictionary) { macDictionary->assignIds(result.back()); }
+	}
+	return result;
+}
+AggregatingParser::AggregatedParseResult AggregatingParser::parseParallel(const ParallelParseOptions& options) {
+	size_t threadCnt = (options.threadCnt > 0) ? options.threadCnt : std::max(1u, std::thread::hardware_concurrency());
+	exceptWhen(options.chunkSize == 0, "Chunk size has to be larger than 0");
+
+	// Reading is serialized by the mutex, parsing of the chunks is done concurrently.
+	// A deque is used because growing it does not invalidate references to existing chunk results.
+	std::mutex readMutex;
+	std::deque<AggregatedParseResult> chunkResults;
+	std::exception_ptr error;
+	auto worker = [&]() {
+		std::string chunk;
+		while(true) {
+			AggregatedParseResult* chunkResult;
+			{
+				std::lock_guard<std::mutex> lock(readMutex);
+				if(error) { return; }
+				try {
+					if(!parser.nextChunk(chunk, options.chunkSize)) { return; }
+				} catch (...) {
+					error = std::current_exception();
+					return;
+				}
+				chunkResult = &chunkResults.emplace_back();
+			}
+			try {
+				chunkResult->reserve(std::count(chunk.begin(), chunk.end(), '\n') + 1);
+				auto chunkParser = MappedVisitingParser::fromBuffer(chunk, parser.getFileVersion());
+				chunkParser.setEventFilter(parser.getEventFilter());
+				RawSensorEventView rawSensorEvent;
+				while(chunkParser.nextLine(rawSensorEvent)) {
+					chunkResult->push_back(SensorEvent::parse(rawSensorEvent));
+				}
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(readMutex);
+				if(!error) { error = std::current_exception(); }
+				return;
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for(size_t i = 0; i < threadCnt; ++i) { workers.emplace_back(worker); }
+	for(auto& workerThread : workers) { workerThread.join(); }
+	if(error) { std::rethrow_exception(error); }
+
+	size_t eventCnt = 0;
+	for(const auto& chunkResult : chunkResults) { eventCnt += chunkResult.size(); }
+	AggregatedParseResult result;
+	result.reserve(eventCnt);
+	for(auto& chunkResult : chunkResults) {
+		std::move(chunkResult.begin(), chunkResult.end(), std::back_inserter(result));
+	}
+	// interned sequentially, such that the ids do not depend on the chunk scheduling
+	if(macDictionary) {
+		for(auto& evt : result) { macDictionary->assignIds(evt); }
 	}
 	return result;
 }
@@ -552,29 +621,53 @@ AggregatingParser::AggregatedRawParseResult AggregatingParser::parseRaw() {
 // # Serializer
 // ######################
 
-Serializer::Serializer(std::ostream& stream, FileVersion fileVersion) : stream(stream), fileVersion(fileVersion) {}
+Serializer::Serializer(std::ostream& stream, FileVersion fileVersion) : stream(stream), fileVersion(fileVersion) {
+	buffer.reserve(FLUSH_THRESHOLD + 4096);
+}
 
 Serializer::~Serializer() {
-	flush();
+	try { flush(); } catch (...) {}
 }
 
-void Serializer::write(const RawSensorEvent& sensorEvent) {
-	auto timestamp = (fileVersion == FileVersion::V0) ? (sensorEvent.timestamp / 1000000) : sensorEvent.timestamp;
-	stream << timestamp << ';';
-	stream << sensorEvent.eventId << ';';
-	stream << sensorEvent.parameterString << '\n';
+void Serializer::writeHeader(Timestamp timestamp, EventId eventId) {
+	if(fileVersion == FileVersion::V0) { timestamp /= 1000000; }
+	char numberBuffer[24];
+	buffer.append(numberBuffer, std::to_chars(numberBuffer, numberBuffer + sizeof(numberBuffer), timestamp).ptr);
+	buffer.push_back(';');
+	buffer.append(numberBuffer, std::to_chars(numberBuffer, numberBuffer + sizeof(numberBuffer), eventId).ptr);
+	buffer.push_back(';');
+}
+
+void Serializer::writeBuffer() {
+	stream.write(buffer.data(), buffer.size());
+	buffer.clear();
 	exceptAssert(stream.good(), "I/O error");
 }
 
+void Serializer::write(const RawSensorEvent& sensorEvent) {
+	write(RawSensorEventView(sensorEvent));
+}
+
+void Serializer::write(const RawSensorEventView& sensorEvent) {
+	writeHeader(sensorEvent.timestamp, sensorEvent.eventId);
+	buffer.append(sensorEvent.parameterString);
+	buffer.push_back('\n');
+	if(buffer.size() >= FLUSH_THRESHOLD) { writeBuffer(); }
+}
+
 void Serializer::write(const SensorEvent& sensorEvent) {
-	RawSensorEvent rawEvt;
-	sensorEvent.serializeInto(rawEvt);
-	write(rawEvt);
+	parameterAssembler.clear();
+	sensorEvent.serializeParametersInto(parameterAssembler);
+	writeHeader(sensorEvent.timestamp, static_cast<EventId>(sensorEvent.eventType));
+	buffer.append(parameterAssembler.view());
+	buffer.push_back('\n');
+	if(buffer.size() >= FLUSH_THRESHOLD) { writeBuffer(); }
 }
 
 void Serializer::flush() {
-	exceptAssert(stream.good(), "I/O error");
+	writeBuffer();
 	stream.flush();
+	exceptAssert(stream.good(), "I/O error");
 }
 
 }
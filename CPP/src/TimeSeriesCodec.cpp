@@ -0,0 +1,206 @@
+#include <sensorreadout/TimeSeriesCodec.h>
+
+namespace SensorReadoutParser {
+
+namespace _internal {
+
+	void writeVarint(std::string& output, uint64_t value) {
+		while(value >= 0x80) {
+			output.push_back(static_cast<char>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		output.push_back(static_cast<char>(value));
+	}
+
+	uint64_t readVarint(std::string_view input, size_t& ptr) {
+		uint64_t result = 0;
+		for(unsigned shift = 0; shift < 64; shift += 7) {
+			exceptAssert(ptr < input.size(), "Truncated time series block");
+			uint8_t byte = static_cast<uint8_t>(input[ptr++]);
+			result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if((byte & 0x80) == 0) { return result; }
+		}
+		throw std::runtime_error("Corrupted time series block");
+	}
+
+	template<typename TEvent>
+	void decodeBlock(std::string_view timestampData, std::string_view valueData, size_t sampleCnt, NumericChannel<TEvent>& channel) {
+		constexpr size_t VALUE_CNT = TEvent::VALUE_CNT;
+		size_t prevSize = channel.size();
+		try {
+			channel.timestamps.resize(prevSize + sampleCnt);
+			channel.values.resize((prevSize + sampleCnt) * VALUE_CNT);
+			Timestamp* timestamps = &channel.timestamps[prevSize];
+			size_t ptr = 0;
+			int64_t delta = 0;
+			for(size_t i = 0; i < sampleCnt; ++i) {
+				uint64_t encoded = readVarint(timestampData, ptr);
+				if(i == 0) {
+					timestamps[i] = encoded;
+					continue;
+				}
+				int64_t decoded = zigzagDecode(encoded);
+				delta = (i == 1) ? decoded : static_cast<int64_t>(static_cast<uint64_t>(delta) + static_cast<uint64_t>(decoded));
+				timestamps[i] = timestamps[i - 1] + static_cast<Timestamp>(delta);
+			}
+			exceptAssert(ptr == timestampData.size(), "Corrupted time series block");
+
+			BitReader reader(valueData);
+			for(size_t component = 0; component < VALUE_CNT; ++component) {
+				decodeXorSeries(reader, &channel.values[prevSize * VALUE_CNT + component], sampleCnt, VALUE_CNT);
+			}
+		} catch (...) {
+			channel.timestamps.resize(prevSize);
+			channel.values.resize(prevSize * VALUE_CNT);
+			throw;
+		}
+	}
+
+}
+
+
+// ###########
+// # TimeSeriesWriter
+// ######################
+
+TimeSeriesWriter::TimeSeriesWriter(std::ostream& stream, size_t blockSampleCnt) : stream(stream), blockSampleCnt(blockSampleCnt) {
+	exceptWhen(blockSampleCnt == 0, "Block sample count has to be larger than 0");
+	exceptWhen(blockSampleCnt > UINT32_MAX, "Block sample count too large");
+	char header[_internal::TIME_SERIES_FILE_HEADER_SIZE];
+	std::memcpy(header, _internal::TIME_SERIES_MAGIC.data(), 4);
+	std::memcpy(header + 4, &_internal::TIME_SERIES_FORMAT_VERSION, sizeof(uint16_t));
+	std::memcpy(header + 6, &_internal::TIME_SERIES_BYTE_ORDER_MARK, sizeof(uint16_t));
+	stream.write(header, sizeof(header));
+	exceptAssert(stream.good(), "I/O error");
+}
+
+TimeSeriesWriter::~TimeSeriesWriter() {
+	try { flush(); } catch (...) {}
+}
+
+template<typename TEvent>
+void TimeSeriesWriter::writeBlock(EventType eventType, const NumericChannel<TEvent>& channel, size_t begin, size_t end) {
+	constexpr size_t VALUE_CNT = TEvent::VALUE_CNT;
+	const size_t sampleCnt = end - begin;
+	blockBuffer.assign(_internal::TIME_SERIES_BLOCK_HEADER_SIZE, '\0');
+
+	// timestamps: first verbatim, then delta, then delta-of-delta
+	int64_t prevDelta = 0;
+	for(size_t i = begin; i < end; ++i) {
+		if(i == begin) {
+			_internal::writeVarint(blockBuffer, channel.timestamps[i]);
+			continue;
+		}
+		int64_t delta = static_cast<int64_t>(channel.timestamps[i] - channel.timestamps[i - 1]);
+		// wrapping arithmetic, such that arbitrary (also non-monotonic) timestamps roundtrip
+		int64_t deltaOfDelta = static_cast<int64_t>(static_cast<uint64_t>(delta) - static_cast<uint64_t>(prevDelta));
+		_internal::writeVarint(blockBuffer, _internal::zigzagEncode((i == begin + 1) ? delta : deltaOfDelta));
+		prevDelta = delta;
+	}
+	const size_t timestampByteCnt = blockBuffer.size() - _internal::TIME_SERIES_BLOCK_HEADER_SIZE;
+
+	_internal::BitWriter writer(blockBuffer);
+	for(size_t component = 0; component < VALUE_CNT; ++component) {
+		_internal::encodeXorSeries(writer, &channel.values[begin * VALUE_CNT + component], sampleCnt, VALUE_CNT);
+	}
+	writer.finish();
+	const size_t valueByteCnt = blockBuffer.size() - _internal::TIME_SERIES_BLOCK_HEADER_SIZE - timestampByteCnt;
+	exceptAssert(valueByteCnt <= UINT32_MAX, "Time series block too large");
+
+	EventId eventId = static_cast<EventId>(eventType);
+	uint32_t header[3] = { static_cast<uint32_t>(sampleCnt), static_cast<uint32_t>(timestampByteCnt), static_cast<uint32_t>(valueByteCnt) };
+	std::memcpy(blockBuffer.data(), &eventId, sizeof(EventId));
+	std::memcpy(blockBuffer.data() + sizeof(EventId), header, sizeof(header));
+	stream.write(blockBuffer.data(), blockBuffer.size());
+	exceptAssert(stream.good(), "I/O error");
+}
+
+bool TimeSeriesWriter::write(const SensorEvent& sensorEvent) {
+	#define TIME_SERIES_WRITER_EVENT_CASE(EvtType, EvtStruct) \
+		case EvtType: { \
+			NumericChannel<EvtStruct>& channel = std::get<NumericChannel<EvtStruct>>(pendingChannels); \
+			channel.push(sensorEvent.timestamp, std::get<EvtStruct>(sensorEvent.data)); \
+			if(channel.size() >= blockSampleCnt) { \
+				writeBlock(EvtType, channel, 0, channel.size()); \
+				channel.clear(); \
+			} \
+			return true; \
+		}
+
+	switch(sensorEvent.eventType) {
+		SENSORREADOUT_NUMERIC_EVENTS(TIME_SERIES_WRITER_EVENT_CASE)
+		default: return false;
+	}
+}
+
+void TimeSeriesWriter::write(const ColumnarRecording& recording) {
+	recording.forEachNumericChannel([&](EventType eventType, const auto& channel) {
+		for(size_t begin = 0; begin < channel.size(); begin += blockSampleCnt) {
+			writeBlock(eventType, channel, begin, std::min(begin + blockSampleCnt, channel.size()));
+		}
+	});
+}
+
+void TimeSeriesWriter::flush() {
+	#define TIME_SERIES_WRITER_FLUSH_CHANNEL(EvtType, EvtStruct) { \
+			NumericChannel<EvtStruct>& channel = std::get<NumericChannel<EvtStruct>>(pendingChannels); \
+			if(!channel.empty()) { \
+				writeBlock(EvtType, channel, 0, channel.size()); \
+				channel.clear(); \
+			} \
+		}
+
+	SENSORREADOUT_NUMERIC_EVENTS(TIME_SERIES_WRITER_FLUSH_CHANNEL)
+	stream.flush();
+}
+
+
+// ###########
+// # TimeSeriesReader
+// ######################
+
+TimeSeriesReader::TimeSeriesReader(std::istream& stream) : stream(stream) {
+	char header[_internal::TIME_SERIES_FILE_HEADER_SIZE];
+	stream.read(header, sizeof(header));
+	exceptAssert(stream.gcount() == sizeof(header), "Truncated time series file header");
+	uint16_t formatVersion, byteOrderMark;
+	std::memcpy(&formatVersion, header + 4, sizeof(formatVersion));
+	std::memcpy(&byteOrderMark, header + 6, sizeof(byteOrderMark));
+	exceptAssert(std::string_view(header, 4) == _internal::TIME_SERIES_MAGIC, "Not a SensorReadout time series file");
+	exceptAssert(byteOrderMark == _internal::TIME_SERIES_BYTE_ORDER_MARK, "Time series file was written with a different byte order");
+	exceptAssert(formatVersion == _internal::TIME_SERIES_FORMAT_VERSION, "Unsupported time series format version");
+}
+
+bool TimeSeriesReader::nextBlock(ColumnarRecording& recording) {
+	#define TIME_SERIES_READER_DECODE_CASE(EvtType, EvtStruct) \
+		case EvtType: _internal::decodeBlock(timestampData, valueData, header[0], recording.channel<EvtStruct>()); break;
+
+	char headerData[_internal::TIME_SERIES_BLOCK_HEADER_SIZE];
+	stream.read(headerData, sizeof(headerData));
+	if(stream.gcount() == 0) { return false; }
+	exceptAssert(stream.gcount() == sizeof(headerData), "Truncated time series block");
+	EventId eventId;
+	uint32_t header[3];
+	std::memcpy(&eventId, headerData, sizeof(EventId));
+	std::memcpy(header, headerData + sizeof(EventId), sizeof(header));
+
+	blockBuffer.resize(static_cast<size_t>(header[1]) + header[2]);
+	stream.read(blockBuffer.data(), blockBuffer.size());
+	exceptAssert(static_cast<size_t>(stream.gcount()) == blockBuffer.size(), "Truncated time series block");
+	std::string_view timestampData(blockBuffer.data(), header[1]);
+	std::string_view valueData(blockBuffer.data() + header[1], header[2]);
+
+	switch(static_cast<EventType>(eventId)) {
+		SENSORREADOUT_NUMERIC_EVENTS(TIME_SERIES_READER_DECODE_CASE)
+		default: throw std::runtime_error("Time series block of non-numeric event type: " + std::to_string(eventId));
+	}
+	return true;
+}
+
+ColumnarRecording TimeSeriesReader::readAll() {
+	ColumnarRecording result;
+	while(nextBlock(result)) {}
+	return result;
+}
+
+}
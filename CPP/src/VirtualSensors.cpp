@@ -0,0 +1,264 @@
+#include <sensorreadout/VirtualSensors.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace SensorReadoutParser {
+
+namespace _internal {
+
+	size_t numericValues(const SensorEvent& evt, std::array<float, DerivedEvent::MAX_VALUE_CNT>& values) {
+		#define VIRTUAL_SENSOR_VALUES_CASE(EvtType, EvtStruct) \
+			case EvtType: { \
+				const EvtStruct& numericEvt = std::get<EvtStruct>(evt.data); \
+				const auto* evtValues = &numericEvt.template getValue<0>(); \
+				for(size_t i = 0; i < EvtStruct::VALUE_CNT; ++i) { values[i] = static_cast<float>(evtValues[i]); } \
+				return EvtStruct::VALUE_CNT; \
+			}
+
+		switch(evt.eventType) {
+			SENSORREADOUT_NUMERIC_EVENTS(VIRTUAL_SENSOR_VALUES_CASE)
+			default: return 0;
+		}
+	}
+
+	size_t numericValueCnt(EventType eventType) {
+		#define VIRTUAL_SENSOR_VALUE_CNT_CASE(EvtType, EvtStruct) \
+			case EvtType: return EvtStruct::VALUE_CNT;
+
+		switch(eventType) {
+			SENSORREADOUT_NUMERIC_EVENTS(VIRTUAL_SENSOR_VALUE_CNT_CASE)
+			default: return 0;
+		}
+	}
+
+}
+
+
+// ###########
+// # Madgwick
+// ######################
+
+void MadgwickFilter::push(const float* accel, const float* gyro, float dtSec) {
+	const float q0 = quat[0], q1 = quat[1], q2 = quat[2], q3 = quat[3];
+
+	// rate of change of quaternion from gyroscope
+	float qDot0 = 0.5f * (-q1 * gyro[0] - q2 * gyro[1] - q3 * gyro[2]);
+	float qDot1 = 0.5f * (q0 * gyro[0] + q2 * gyro[2] - q3 * gyro[1]);
+	float qDot2 = 0.5f * (q0 * gyro[1] - q1 * gyro[2] + q3 * gyro[0]);
+	float qDot3 = 0.5f * (q0 * gyro[2] + q1 * gyro[1] - q2 * gyro[0]);
+
+	// compute feedback only if accelerometer measurement valid (avoids NaN in accelerometer normalisation)
+	float accelNorm = std::sqrt(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+	if(accelNorm > 0) {
+		const float ax = accel[0] / accelNorm, ay = accel[1] / accelNorm, az = accel[2] / accelNorm;
+		const float qq0 = q0 * q0, qq1 = q1 * q1, qq2 = q2 * q2, qq3 = q3 * q3;
+
+		// gradient decent algorithm corrective step
+		float s0 = 4.0f * q0 * qq2 + 2.0f * q2 * ax + 4.0f * q0 * qq1 - 2.0f * q1 * ay;
+		float s1 = 4.0f * q1 * qq3 - 2.0f * q3 * ax + 4.0f * qq0 * q1 - 2.0f * q0 * ay - 4.0f * q1 + 8.0f * q1 * qq1 + 8.0f * q1 * qq2 + 4.0f * q1 * az;
+		float s2 = 4.0f * qq0 * q2 + 2.0f * q0 * ax + 4.0f * q2 * qq3 - 2.0f * q3 * ay - 4.0f * q2 + 8.0f * q2 * qq1 + 8.0f * q2 * qq2 + 4.0f * q2 * az;
+		float s3 = 4.0f * qq1 * q3 - 2.0f * q1 * ax + 4.0f * qq2 * q3 - 2.0f * q2 * ay;
+		float sNorm = std::sqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+		if(sNorm > 0) {
+			// apply feedback step
+			qDot0 -= beta * s0 / sNorm;
+			qDot1 -= beta * s1 / sNorm;
+			qDot2 -= beta * s2 / sNorm;
+			qDot3 -= beta * s3 / sNorm;
+		}
+	}
+
+	// integrate rate of change of quaternion to yield quaternion, and normalise
+	float n0 = q0 + qDot0 * dtSec, n1 = q1 + qDot1 * dtSec, n2 = q2 + qDot2 * dtSec, n3 = q3 + qDot3 * dtSec;
+	float quatNorm = std::sqrt(n0 * n0 + n1 * n1 + n2 * n2 + n3 * n3);
+	quat = { n0 / quatNorm, n1 / quatNorm, n2 / quatNorm, n3 / quatNorm };
+}
+
+void MadgwickFilter::fastStart(const float* accel, const float* gyro, float dtSec) {
+	// weigh the accelerometer with 100%, by disabling the division through the sample frequency for the feedback step
+	float configuredBeta = beta;
+	beta = beta / dtSec;
+	push(accel, gyro, dtSec);
+	beta = configuredBeta;
+}
+
+void MadgwickFilter::rotatePoint(const float* point, float* result) const {
+	// v' = v + w * t + cross(q, t), with t = 2 * cross(q, v)
+	const float w = quat[0], x = quat[1], y = quat[2], z = quat[3];
+	const float tx = 2.0f * (y * point[2] - z * point[1]);
+	const float ty = 2.0f * (z * point[0] - x * point[2]);
+	const float tz = 2.0f * (x * point[1] - y * point[0]);
+	result[0] = point[0] + w * tx + (y * tz - z * ty);
+	result[1] = point[1] + w * ty + (z * tx - x * tz);
+	result[2] = point[2] + w * tz + (x * ty - y * tx);
+}
+
+bool MadgwickOrientation::update(const SensorEvent& evt) {
+	if(evt.eventType == EventType::Accelerometer) {
+		_internal::numericValues(evt, accel);
+		hasAccel = true;
+		return false;
+	}
+	if(evt.eventType != EventType::Gyroscope) { return false; }
+
+	float dtSec = (sampleFrequency > 0) ? (1.0f / sampleFrequency) : 0.0f;
+	if(sampleFrequency <= 0) {
+		if(hasGyroTimestamp && evt.timestamp > lastGyroTimestamp) {
+			dtSec = static_cast<float>(evt.timestamp - lastGyroTimestamp) * 1e-9f;
+		}
+		lastGyroTimestamp = evt.timestamp;
+		hasGyroTimestamp = true;
+	}
+	if(!hasAccel || dtSec <= 0) { return false; }
+
+	const GyroscopeEvent& gyroEvt = std::get<GyroscopeEvent>(evt.data);
+	if(!started) {
+		filter.fastStart(accel.data(), &gyroEvt.x, dtSec);
+		started = true;
+	} else {
+		filter.push(accel.data(), &gyroEvt.x, dtSec);
+	}
+	return true;
+}
+
+void MadgwickOrientation::push(const SensorEvent& evt, const Sink& sink) {
+	if(!update(evt)) { return; }
+	DerivedEvent derived;
+	derived.timestamp = evt.timestamp;
+	derived.valueCnt = 4;
+	std::copy(getFilter().getQuat().begin(), getFilter().getQuat().end(), derived.values.begin());
+	sink(derived);
+}
+
+MadgwickFiltered::MadgwickFiltered(EventType inputType, float beta, float sampleFrequency)
+		: MadgwickOrientation(3, beta, sampleFrequency), inputType(inputType) {
+	exceptWhen(_internal::numericValueCnt(inputType) < 3, "MadgwickFiltered requires a 3-dimensional input sensor");
+}
+
+void MadgwickFiltered::push(const SensorEvent& evt, const Sink& sink) {
+	// the input can itself be the accelerometer or gyroscope, so the orientation is updated first
+	hasOrientation |= update(evt);
+	if(evt.eventType != inputType || !hasOrientation) { return; }
+	std::array<float, DerivedEvent::MAX_VALUE_CNT> input;
+	_internal::numericValues(evt, input);
+	DerivedEvent derived;
+	derived.timestamp = evt.timestamp;
+	derived.valueCnt = 3;
+	getFilter().rotatePoint(input.data(), derived.values.data());
+	sink(derived);
+}
+
+
+// ###########
+// # Features
+// ######################
+
+Magnitude::Magnitude(EventType inputType) : VirtualSensor(1), inputType(inputType) {
+	exceptWhen(_internal::numericValueCnt(inputType) == 0, "Magnitude requires a numeric input sensor");
+}
+
+void Magnitude::push(const SensorEvent& evt, const Sink& sink) {
+	if(evt.eventType != inputType) { return; }
+	std::array<float, DerivedEvent::MAX_VALUE_CNT> input;
+	size_t valueCnt = _internal::numericValues(evt, input);
+	float sum = 0;
+	for(size_t i = 0; i < valueCnt; ++i) { sum += input[i] * input[i]; }
+	DerivedEvent derived;
+	derived.timestamp = evt.timestamp;
+	derived.valueCnt = 1;
+	derived.values[0] = std::sqrt(sum);
+	sink(derived);
+}
+
+NormalizedAccel::NormalizedAccel(size_t filterOrder) : VirtualSensor(2) {
+	if(filterOrder > 1) { filterWindow.resize(filterOrder); }
+}
+
+void NormalizedAccel::push(const SensorEvent& evt, const Sink& sink) {
+	if(evt.eventType == EventType::Gravity) {
+		_internal::numericValues(evt, gravity);
+		float norm = std::sqrt(gravity[0] * gravity[0] + gravity[1] * gravity[1] + gravity[2] * gravity[2]);
+		hasGravity = (norm > 0);
+		if(hasGravity) {
+			for(size_t i = 0; i < 3; ++i) { gravity[i] /= norm; }
+		}
+		return;
+	}
+	if(evt.eventType != EventType::LinearAcceleration) { return; }
+
+	const LinearAccelerationEvent& accelEvt = std::get<LinearAccelerationEvent>(evt.data);
+	std::array<float, 3> accel = { accelEvt.x, accelEvt.y, accelEvt.z };
+	if(!filterWindow.empty()) { // moving mean over a ring buffer
+		if(filterFill == filterWindow.size()) {
+			for(size_t i = 0; i < 3; ++i) { filterSum[i] -= filterWindow[filterPtr][i]; }
+		} else {
+			++filterFill;
+		}
+		filterWindow[filterPtr] = accel;
+		filterPtr = (filterPtr + 1) % filterWindow.size();
+		for(size_t i = 0; i < 3; ++i) {
+			filterSum[i] += accel[i];
+			accel[i] = static_cast<float>(filterSum[i] / filterFill);
+		}
+	}
+	if(!hasGravity) { return; }
+
+	// vertical: magnitude along the gravity axis, horizontal: magnitude of the remainder
+	float vertical = accel[0] * gravity[0] + accel[1] * gravity[1] + accel[2] * gravity[2];
+	float horizontalSq = 0;
+	for(size_t i = 0; i < 3; ++i) {
+		float horizontal = accel[i] - vertical * gravity[i];
+		horizontalSq += horizontal * horizontal;
+	}
+	DerivedEvent derived;
+	derived.timestamp = evt.timestamp;
+	derived.valueCnt = 2;
+	derived.values[0] = vertical;
+	derived.values[1] = std::sqrt(horizontalSq);
+	sink(derived);
+}
+
+
+// ###########
+// # VirtualSensorStage
+// ######################
+
+size_t VirtualSensorStage::add(std::unique_ptr<VirtualSensor> sensor) {
+	size_t sensorIdx = sensors.size();
+	sensors.push_back(std::move(sensor));
+	sensorSinks.push_back([this, sensorIdx](const DerivedEvent& derived) { sink(sensorIdx, derived); });
+	return sensorIdx;
+}
+
+void VirtualSensorStage::push(const SensorEvent& evt) {
+	for(size_t i = 0; i < sensors.size(); ++i) {
+		sensors[i]->push(evt, sensorSinks[i]);
+	}
+}
+
+size_t VirtualSensorStage::run(VisitingParser& parser) {
+	size_t eventCnt = 0;
+	RawSensorEvent rawEvent;
+	SensorEvent evt;
+	while(parser.nextLine(rawEvent)) {
+		evt = SensorEvent::parse(rawEvent);
+		push(evt);
+		++eventCnt;
+	}
+	return eventCnt;
+}
+
+size_t VirtualSensorStage::run(MappedVisitingParser& parser) {
+	size_t eventCnt = 0;
+	RawSensorEventView rawEvent;
+	SensorEvent evt;
+	while(parser.nextLine(rawEvent)) {
+		evt = SensorEvent::parse(rawEvent);
+		push(evt);
+		++eventCnt;
+	}
+	return eventCnt;
+}
+
+}
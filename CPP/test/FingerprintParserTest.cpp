@@ -1,12 +1,17 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <numeric>
+#include <random>
+#include <set>
 
 // use the Boost unit-testing framework with its own main
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 
 #include <sensorreadout/FingerprintParser.h>
+#include <sensorreadout/FingerprintMatcher.h>
 
 using namespace SensorReadoutParser;
 
@@ -21,8 +26,8 @@ BOOST_AUTO_TEST_CASE ( fingerprintParserTest ) {
 		BOOST_CHECK_EQUAL(fp053.has_value(), true);
 		BOOST_CHECK_EQUAL(fp053->get().name, "FP 053");
 		BOOST_CHECK(fp053->get().fpType == FingerprintType::Point);
-		BOOST_CHECK_EQUAL(fp053->get().parameters.size(), 4);
-		BOOST_CHECK_EQUAL(fp053->get().parameters.at("name"), "FP 053");
+		BOOST_CHECK_EQUAL(fp053->get().getParameters().size(), 4);
+		BOOST_CHECK_EQUAL(fp053->get().getParameters().at("name"), "FP 053");
 		BOOST_CHECK_EQUAL(fp053->get().getFloorIdx(), 0);
 		BOOST_CHECK_EQUAL(fp053->get().getFloorName(), "floor");
 		auto pos = fp053->get().getPosition();
@@ -36,9 +41,9 @@ BOOST_AUTO_TEST_CASE ( fingerprintParserTest ) {
 		BOOST_CHECK_EQUAL(fp1337.has_value(), true);
 		BOOST_CHECK_EQUAL(fp1337->get().name, "FP 1337");
 		BOOST_CHECK(fp1337->get().fpType == FingerprintType::Point);
-		BOOST_CHECK_EQUAL(fp1337->get().parameters.size(), 5);
-		BOOST_CHECK_EQUAL(fp1337->get().parameters.at("name"), "FP 1337");
-		BOOST_CHECK_EQUAL(fp1337->get().parameters.at("paramWithEqInName"), "key=value");
+		BOOST_CHECK_EQUAL(fp1337->get().getParameters().size(), 5);
+		BOOST_CHECK_EQUAL(fp1337->get().getParameters().at("name"), "FP 1337");
+		BOOST_CHECK_EQUAL(fp1337->get().getParameters().at("paramWithEqInName"), "key=value");
 		BOOST_CHECK_EQUAL(fp1337->get().getFloorIdx(), 1);
 		BOOST_CHECK_EQUAL(fp1337->get().getFloorName(), "floorTest");
 		auto pos = fp1337->get().getPosition();
@@ -52,9 +57,9 @@ BOOST_AUTO_TEST_CASE ( fingerprintParserTest ) {
 		BOOST_CHECK_EQUAL(fp099.has_value(), true);
 		BOOST_CHECK_EQUAL(fp099->get().name, "FP 099");
 		BOOST_CHECK(fp099->get().fpType == FingerprintType::Point);
-		BOOST_CHECK_EQUAL(fp099->get().parameters.size(), 5);
-		BOOST_CHECK_EQUAL(fp099->get().parameters.at("name"), "FP 099");
-		BOOST_CHECK_EQUAL(fp099->get().parameters.at("additionalParam1"), "testvalue");
+		BOOST_CHECK_EQUAL(fp099->get().getParameters().size(), 5);
+		BOOST_CHECK_EQUAL(fp099->get().getParameters().at("name"), "FP 099");
+		BOOST_CHECK_EQUAL(fp099->get().getParameters().at("additionalParam1"), "testvalue");
 		BOOST_CHECK_EQUAL(fp099->get().getFloorIdx(), 2);
 		BOOST_CHECK_EQUAL(fp099->get().getFloorName(), "floor1");
 		auto pos = fp099->get().getPosition();
@@ -68,7 +73,7 @@ BOOST_AUTO_TEST_CASE ( fingerprintParserTest ) {
 		BOOST_CHECK_EQUAL(fp02_07.has_value(), true);
 		BOOST_CHECK_EQUAL(fp02_07->get().name, "FP 02;FP 07");
 		BOOST_CHECK(fp02_07->get().fpType == FingerprintType::Path);
-		BOOST_CHECK_EQUAL(fp02_07->get().parameters.size(), 9);
+		BOOST_CHECK_EQUAL(fp02_07->get().getParameters().size(), 9);
 		BOOST_CHECK_EQUAL(fp02_07->get().getFloorIdx(), 1337);
 		BOOST_CHECK_EQUAL(fp02_07->get().getFloorName(), "floor42");
 		{
@@ -87,3 +92,316 @@ BOOST_AUTO_TEST_CASE ( fingerprintParserTest ) {
 		}
 	}
 }
+
+BOOST_AUTO_TEST_CASE ( fingerprintParserFilterTest ) {
+	std::ifstream fpFile("testFiles/fingerprints.dat");
+	BOOST_REQUIRE(fpFile.is_open());
+	FingerprintParser parser(fpFile);
+	Fingerprints allFps = parser.parse();
+	Fingerprints filteredFps = parser.parse(FingerprintParser::EventFilter{EventType::Accelerometer});
+	BOOST_REQUIRE_EQUAL(allFps.size(), filteredFps.size());
+
+	auto allIt = allFps.begin();
+	for(const auto& filteredFp : filteredFps) {
+		const auto& fp = *allIt++;
+		BOOST_CHECK_EQUAL(fp.name, filteredFp.name);
+		size_t accelerometerCnt = std::count_if(fp.evts.begin(), fp.evts.end(), [](const auto& evt) { return evt.eventType == EventType::Accelerometer; });
+		BOOST_CHECK_EQUAL(filteredFp.evts.size(), accelerometerCnt);
+		for(const auto& evt : filteredFp.evts) {
+			BOOST_CHECK(evt.eventType == EventType::Accelerometer);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( fingerprintParserIndexTest ) {
+	std::ifstream fpFile("testFiles/fingerprints.dat");
+	BOOST_REQUIRE(fpFile.is_open());
+	FingerprintParser parser(fpFile);
+	Fingerprints expectedFps = parser.parse();
+
+	auto checkEqual = [&](const Fingerprints& fps, size_t evtCntFactor) {
+		auto expectedIt = expectedFps.begin();
+		for(const auto& fp : fps) {
+			const auto& expectedFp = *expectedIt++;
+			BOOST_CHECK_EQUAL(fp.name, expectedFp.name);
+			BOOST_CHECK(fp.fpType == expectedFp.fpType);
+			BOOST_CHECK(fp.getParameters() == expectedFp.getParameters());
+			BOOST_CHECK(!fp.hasPendingEvents());
+			BOOST_REQUIRE_EQUAL(fp.evts.size(), expectedFp.evts.size() * evtCntFactor);
+			for(size_t i = 0; i < fp.evts.size(); ++i) {
+				BOOST_CHECK_EQUAL(fp.evts[i].timestamp, expectedFp.evts[i % expectedFp.evts.size()].timestamp);
+				BOOST_CHECK(fp.evts[i].eventType == expectedFp.evts[i % expectedFp.evts.size()].eventType);
+			}
+		}
+		BOOST_CHECK(expectedIt == expectedFps.end());
+	};
+
+	{ // lazy: only properties are parsed, events are decoded on request
+		Fingerprints fps = parser.index();
+		BOOST_REQUIRE_EQUAL(fps.size(), expectedFps.size());
+		auto fp1337 = fps.getFirstByName("FP 1337");
+		BOOST_REQUIRE(fp1337.has_value());
+		BOOST_CHECK(fp1337->get().hasPendingEvents());
+		BOOST_CHECK(fp1337->get().evts.empty());
+		BOOST_CHECK_CLOSE(fp1337->get().getPosition()[0], 13.37, 0.01);
+		fp1337->get().loadEvents();
+		BOOST_CHECK(!fp1337->get().hasPendingEvents());
+		BOOST_CHECK_EQUAL(fp1337->get().evts.size(), 13);
+		fp1337->get().loadEvents();
+		BOOST_CHECK_EQUAL(fp1337->get().evts.size(), 13);
+		fps.loadEvents(2);
+		checkEqual(fps, 1);
+	}
+	{ // parallel decoding, with and without filter
+		checkEqual(parser.parseParallel({}, 4), 1);
+		Fingerprints filteredFps = parser.parseParallel(FingerprintParser::EventFilter{EventType::Accelerometer}, 2);
+		Fingerprints expectedFilteredFps = parser.parse(FingerprintParser::EventFilter{EventType::Accelerometer});
+		auto expectedIt = expectedFilteredFps.begin();
+		for(const auto& fp : filteredFps) {
+			BOOST_CHECK_EQUAL(fp.evts.size(), (expectedIt++)->evts.size());
+		}
+	}
+	{ // pending events are serialized as they are, and an indexed database can be re-indexed
+		Fingerprints fps = parser.index();
+		std::stringstream serialized;
+		FingerprintSerializer serializer(serialized);
+		serializer.serialize(fps);
+		FingerprintParser reparser(serialized);
+		checkEqual(reparser.parseParallel(), 1);
+		Fingerprints doubled = reparser.index();
+		for(auto& fp : doubled) {
+			fp.loadEvents();
+			fp.pendingEvts = parser.index().getFirstByName(fp.name)->get().pendingEvts;
+		}
+		std::stringstream doubledSerialized;
+		FingerprintSerializer(doubledSerialized).serialize(doubled);
+		FingerprintParser doubledParser(doubledSerialized);
+		checkEqual(doubledParser.parseParallel(), 2);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( fingerprintTypedParametersTest ) {
+	std::ifstream fpFile("testFiles/fingerprints.dat");
+	BOOST_REQUIRE(fpFile.is_open());
+	FingerprintParser parser(fpFile);
+	Fingerprints fps = parser.index();
+
+	{ // decoded once, getters return views on the same storage
+		auto path = fps.getFirstByName("FP 02;FP 07");
+		BOOST_REQUIRE(path.has_value());
+		Fingerprint& fp = path->get();
+		BOOST_CHECK(fp.getPositions().data() == fp.getPositions().data());
+		BOOST_REQUIRE_EQUAL(fp.getPositions().size(), 2);
+		BOOST_REQUIRE_EQUAL(fp.getPointNames().size(), 2);
+		BOOST_CHECK_EQUAL(fp.getPointNames()[1], "FP 07");
+		BOOST_CHECK(fp.getFloorIdcs().empty());
+		BOOST_CHECK_EQUAL(fp.getFloorName(), "floor42");
+		BOOST_CHECK_THROW(fp.getPosition(), std::runtime_error);
+
+		// setters keep the typed values and the serialized parameters in sync
+		fp.setPositions({ {1, 2, 3} });
+		BOOST_REQUIRE_EQUAL(fp.getPositions().size(), 1);
+		BOOST_CHECK_EQUAL(fp.getPositions()[0][2], 3);
+		BOOST_CHECK_EQUAL(fp.getParameters().at("positions[]"), "1");
+		BOOST_CHECK(!fp.getParameters().contains("positions[1]"));
+		fp.setPosition({4, 5, 6});
+		BOOST_CHECK_EQUAL(fp.getPosition()[0], 4);
+		fp.setParameter("floorIdx", "7");
+		BOOST_CHECK_EQUAL(fp.getFloorIdx(), 7);
+		BOOST_CHECK_EQUAL(fp.getParameters().at("floorIdx"), "7");
+	}
+	{ // fingerprints that were not added to a Fingerprints container decode their parameters as well
+		Fingerprint fp;
+		fp.setParameter("position", "(1.5;2.5;3.5)");
+		BOOST_CHECK_EQUAL(fp.getPosition()[1], 2.5);
+		BOOST_CHECK(!fp.hasFloorIdx());
+	}
+	{ // typed values survive a serialization roundtrip
+		std::stringstream serialized;
+		FingerprintSerializer(serialized).serialize(fps);
+		FingerprintParser reparser(serialized);
+		Fingerprints reparsed = reparser.index();
+		const Fingerprint& fp = reparsed.getFirstByName("FP 02;FP 07")->get();
+		BOOST_REQUIRE_EQUAL(fp.getPositions().size(), 1);
+		BOOST_CHECK_CLOSE(fp.getPositions()[0][1], 2, 0.01);
+		BOOST_CHECK_CLOSE(fp.getPosition()[2], 6, 0.01);
+		BOOST_CHECK_EQUAL(fp.getFloorIdx(), 7);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( fingerprintSpatialIndexTest ) {
+	{ // file: path positions are indexed individually, but the path is reported once
+		std::ifstream fpFile("testFiles/fingerprints.dat");
+		BOOST_REQUIRE(fpFile.is_open());
+		FingerprintParser parser(fpFile);
+		Fingerprints fps = parser.index();
+		auto within = fps.findWithinRadius(1337, {10, 4, 1.3}, 2);
+		BOOST_REQUIRE_EQUAL(within.size(), 1);
+		BOOST_CHECK_EQUAL(fps.at(within[0].fpIdx).name, "FP 02;FP 07");
+		BOOST_CHECK_EQUAL(within[0].positionIdx, 1);
+		BOOST_CHECK_CLOSE(within[0].distance, 1.2, 0.01);
+		BOOST_CHECK(fps.findWithinRadius(1, {10, 4, 1.3}, 2).empty());
+		auto nearest = fps.findNearest(1, {0, 0, 0}, 5);
+		BOOST_REQUIRE_EQUAL(nearest.size(), 1);
+		BOOST_CHECK_EQUAL(fps.at(nearest[0].fpIdx).name, "FP 1337");
+		BOOST_CHECK(fps.findNearest(42, {0, 0, 0}, 5).empty());
+	}
+
+	// random fingerprints, added incrementally and compared against a linear scan
+	std::mt19937 rng(1337);
+	std::uniform_real_distribution<double> posDist(-50, 50);
+	Fingerprints fps(3.0);
+	std::vector<std::pair<size_t, std::array<double, 3>>> points;
+	auto bruteForce = [&](size_t floorIdx, const std::array<double, 3>& pos) {
+		std::vector<std::pair<double, size_t>> result;
+		for(size_t i = 0; i < points.size(); ++i) {
+			if(points[i].first != floorIdx) { continue; }
+			const auto& p = points[i].second;
+			result.push_back({std::sqrt(std::pow(p[0] - pos[0], 2) + std::pow(p[1] - pos[1], 2) + std::pow(p[2] - pos[2], 2)), i});
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	};
+	for(size_t round = 0; round < 4; ++round) {
+		for(size_t i = 0; i < 250; ++i) {
+			Fingerprint fp;
+			fp.fpType = FingerprintType::Point;
+			fp.name = "FP " + std::to_string(points.size());
+			fp.setParameter("floorIdx", std::to_string(points.size() % 2));
+			fp.setPosition({posDist(rng), posDist(rng), 1.3});
+			points.push_back({points.size() % 2, fp.getPosition()});
+			fps.add(std::move(fp));
+		}
+		for(size_t query = 0; query < 20; ++query) {
+			const std::array<double, 3> pos = {posDist(rng) * 1.5, posDist(rng) * 1.5, 0};
+			const size_t floorIdx = query % 2;
+			const auto expected = bruteForce(floorIdx, pos);
+
+			const auto nearest = fps.findNearest(floorIdx, pos, 7);
+			BOOST_REQUIRE_EQUAL(nearest.size(), 7);
+			for(size_t i = 0; i < nearest.size(); ++i) {
+				BOOST_CHECK_EQUAL(nearest[i].fpIdx, expected[i].second);
+				BOOST_CHECK_CLOSE(nearest[i].distance, expected[i].first, 0.0001);
+			}
+
+			const double radius = 10;
+			const auto within = fps.findWithinRadius(floorIdx, pos, radius);
+			size_t expectedCnt = std::count_if(expected.begin(), expected.end(), [&](const auto& e) { return e.first <= radius; });
+			BOOST_REQUIRE_EQUAL(within.size(), expectedCnt);
+			for(size_t i = 0; i < within.size(); ++i) { BOOST_CHECK_EQUAL(within[i].fpIdx, expected[i].second); }
+		}
+	}
+	BOOST_CHECK_EQUAL(fps.findNearest(0, {0, 0, 0}, 10000).size(), 500);
+	BOOST_CHECK_EQUAL(fps.findWithinRadius(1, {0, 0, 0}, 1e6).size(), 500);
+}
+
+BOOST_AUTO_TEST_CASE ( fingerprintMatcherTest ) {
+	std::mt19937 rng(42);
+	std::vector<MacAddress> macs;
+	for(size_t i = 0; i < 40; ++i) {
+		MacAddress mac;
+		for(size_t b = 0; b < MacAddress::MAC_LENGTH; ++b) { mac[b] = static_cast<uint8_t>(rng()); }
+		macs.push_back(mac);
+	}
+	auto randomScan = [&](size_t apCnt) {
+		WifiEvent scan;
+		std::vector<size_t> macIdcs(macs.size());
+		std::iota(macIdcs.begin(), macIdcs.end(), 0);
+		std::shuffle(macIdcs.begin(), macIdcs.end(), rng);
+		for(size_t i = 0; i < apCnt; ++i) {
+			scan.advertisements.push_back({macs[macIdcs[i]], std::uniform_int_distribution<Rssi>(-95, -35)(rng), 2412});
+		}
+		return scan;
+	};
+
+	Fingerprints fps;
+	{ // fingerprint without radio data is not part of the matrix
+		Fingerprint fp;
+		fp.fpType = FingerprintType::Point;
+		fp.name = "empty";
+		fps.add(std::move(fp));
+	}
+	for(size_t i = 0; i < 37; ++i) {
+		Fingerprint fp;
+		fp.fpType = FingerprintType::Point;
+		fp.name = "FP " + std::to_string(i);
+		for(size_t scan = 0; scan < 3; ++scan) { fp.evts.push_back({scan, EventType::Wifi, randomScan(12)}); }
+		fp.evts.push_back({3, EventType::BLE, BLEEvent { macs[i], -60, 0, {} }});
+		fps.add(std::move(fp));
+	}
+
+	// reference: mean RSSI per MAC, missing values assumed as missingRssi
+	auto meanRssis = [&](const std::vector<SensorEvent>& evts, bool withBle) {
+		std::map<std::string, std::pair<double, size_t>> sums;
+		for(const auto& evt : evts) {
+			if(evt.eventType == EventType::Wifi) {
+				for(const auto& adv : std::get<WifiEvent>(evt.data).advertisements) { sums[adv.mac.toString()].first += adv.rssi; sums[adv.mac.toString()].second++; }
+			} else if(evt.eventType == EventType::BLE && withBle) {
+				const auto& ble = std::get<BLEEvent>(evt.data);
+				sums[ble.mac.toString()].first += ble.rssi; sums[ble.mac.toString()].second++;
+			}
+		}
+		std::map<std::string, double> result;
+		for(const auto& [mac, sumCnt] : sums) { result[mac] = sumCnt.first / sumCnt.second; }
+		return result;
+	};
+	auto referenceDistance = [&](const std::map<std::string, double>& fp, const std::map<std::string, double>& query, RssiDistanceMetric metric) {
+		std::set<std::string> allMacs;
+		for(const auto& [mac, rssi] : fp) { allMacs.insert(mac); }
+		for(const auto& [mac, rssi] : query) { allMacs.insert(mac); }
+		double result = 0;
+		for(const auto& mac : allMacs) {
+			double a = fp.contains(mac) ? fp.at(mac) : -100, b = query.contains(mac) ? query.at(mac) : -100;
+			result += (metric == RssiDistanceMetric::Euclidean) ? ((a - b) * (a - b)) : std::abs(a - b);
+		}
+		return (metric == RssiDistanceMetric::Euclidean) ? std::sqrt(result) : result;
+	};
+
+	for(RssiDistanceMetric metric : {RssiDistanceMetric::Euclidean, RssiDistanceMetric::Manhattan}) {
+		FingerprintMatcherOptions options;
+		options.metric = metric;
+		FingerprintMatcher matcher(fps, options);
+		BOOST_CHECK_EQUAL(matcher.fingerprintCnt(), 37);
+		BOOST_CHECK_EQUAL(matcher.macCnt(), 40);
+
+		std::vector<WifiEvent> queries;
+		for(size_t i = 0; i < 20; ++i) { queries.push_back(randomScan(5 + i)); }
+		// a MAC that no fingerprint saw
+		queries.back().advertisements.push_back({MacAddress::fromString("0123456789AB"), -50, 2412});
+		const auto allMatches = matcher.matchAll(queries, 5, 4);
+		for(size_t q = 0; q < queries.size(); ++q) {
+			const auto queryRssis = meanRssis({ SensorEvent { 0, EventType::Wifi, queries[q] } }, false);
+			std::vector<std::pair<double, size_t>> expected;
+			for(size_t fpIdx = 1; fpIdx < fps.size(); ++fpIdx) {
+				expected.push_back({referenceDistance(meanRssis(fps.at(fpIdx).evts, true), queryRssis, metric), fpIdx});
+			}
+			std::sort(expected.begin(), expected.end());
+
+			const auto matches = matcher.match(queries[q], 5);
+			BOOST_REQUIRE_EQUAL(matches.size(), 5);
+			BOOST_REQUIRE_EQUAL(allMatches[q].size(), 5);
+			for(size_t i = 0; i < matches.size(); ++i) {
+				BOOST_CHECK_CLOSE(matches[i].distance, expected[i].first, 0.01);
+				BOOST_CHECK_EQUAL(matches[i].fpIdx, expected[i].second);
+				BOOST_CHECK_EQUAL(allMatches[q][i].fpIdx, matches[i].fpIdx);
+			}
+		}
+	}
+
+	{ // exact match, and k larger than the amount of fingerprints
+		FingerprintMatcherOptions options;
+		options.sources = {EventType::Wifi};
+		FingerprintMatcher matcher(fps, options);
+		const WifiEvent& scan = std::get<WifiEvent>(fps.at(5).evts[0].data);
+		Fingerprints single;
+		Fingerprint fp;
+		fp.fpType = FingerprintType::Point;
+		fp.evts.push_back({0, EventType::Wifi, scan});
+		single.add(std::move(fp));
+		FingerprintMatcher singleMatcher(single, options);
+		auto matches = singleMatcher.match(scan, 10);
+		BOOST_REQUIRE_EQUAL(matches.size(), 1);
+		BOOST_CHECK_SMALL(matches[0].distance, 0.01f);
+		BOOST_CHECK(matcher.match(std::span<const RssiMeasurement>(), 3).size() == 3);
+	}
+}
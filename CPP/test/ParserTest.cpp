@@ -1,15 +1,40 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <sstream>
+#include <cmath>
+#include <cstring>
 
 // use the Boost unit-testing framework with its own main
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 
 #include <sensorreadout/SensorReadoutParser.h>
+#include <sensorreadout/MappedVisitingParser.h>
+#include <sensorreadout/ColumnarRecording.h>
+#include <sensorreadout/BinaryFormat.h>
+#include <sensorreadout/RecordingIndex.h>
+#include <sensorreadout/GzipInputStream.h>
+#include <sensorreadout/Pipeline.h>
+#include <sensorreadout/LiveSimulator.h>
+#include <sensorreadout/Resampler.h>
+#include <sensorreadout/VirtualSensors.h>
+#include <sensorreadout/RecordingStatistics.h>
+#include <sensorreadout/MacDictionary.h>
+
+#ifdef SENSORREADOUT_WITH_ZLIB
+	#include <zlib.h>
+#endif
+#include <sensorreadout/HexCodec.h>
 
 using namespace SensorReadoutParser;
-using namespace _internal;
+using namespace SensorReadoutParser::_internal;
 
 // ###########
 // # Helpers
@@ -53,6 +78,76 @@ BOOST_AUTO_TEST_CASE ( tokenizerTest ) {
 		Tokenizer<';'> tokenizer("c976c52c-0e9c-4dfe-9b4-4dfe46b1a8bb;1.0");
 		BOOST_CHECK_THROW(tokenizer.nextAs<UUID>(), std::runtime_error);
 	}
+	{ // tokens spanning multiple scan windows
+		std::string longToken(150, 'x');
+		std::string input = "a;" + longToken + ";;" + std::string(63, 'y') + ";b";
+		Tokenizer<';'> tokenizer(input);
+		BOOST_CHECK_EQUAL(tokenizer.next(), "a");
+		BOOST_CHECK_EQUAL(tokenizer.peekNext().value(), longToken);
+		BOOST_CHECK_EQUAL(tokenizer.next(), longToken);
+		BOOST_CHECK_EQUAL(tokenizer.next(), "");
+		BOOST_CHECK_EQUAL(tokenizer.next(), std::string(63, 'y'));
+		BOOST_CHECK_EQUAL(tokenizer.next(), "b");
+		BOOST_CHECK(tokenizer.isEOS());
+	}
+	{ // peeking across scan windows does not affect the following tokens
+		std::vector<std::string> tokens;
+		std::string input;
+		for(size_t i = 0; i < 200; ++i) {
+			tokens.push_back(std::string(1 + (i * 7) % 13, 'a' + (i % 26)));
+			input += (i == 0 ? "" : ";") + tokens.back();
+		}
+		Tokenizer<';'> tokenizer(input);
+		for(const auto& token : tokens) {
+			BOOST_CHECK_EQUAL(tokenizer.peekNext().value(), token);
+			BOOST_CHECK_EQUAL(tokenizer.next(), token);
+		}
+		BOOST_CHECK(tokenizer.isEOS());
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( hexCodecTest ) {
+	BOOST_CHECK_EQUAL(HexCodec::decodeNibble('0'), 0);
+	BOOST_CHECK_EQUAL(HexCodec::decodeNibble('f'), 15);
+	BOOST_CHECK_EQUAL(HexCodec::decodeNibble('F'), 15);
+	BOOST_CHECK_THROW(HexCodec::decodeNibble('g'), std::runtime_error);
+	BOOST_CHECK_THROW(HexCodec::decodeNibble(':'), std::runtime_error);
+	{ // MAC
+		BOOST_CHECK_EQUAL(MacAddress::fromString("4c11aeefe8be").toString(), "4C11AEEFE8BE");
+		BOOST_CHECK_EQUAL(MacAddress::fromColonDelimitedString("4C:11:AE:EF:E8:BE").toString(), "4C11AEEFE8BE");
+		BOOST_CHECK_THROW(MacAddress::fromString("4C11AEEFE8BX"), std::runtime_error);
+		BOOST_CHECK_THROW(MacAddress::fromColonDelimitedString("4C:11:AE-EF:E8:BE"), std::runtime_error);
+	}
+	{ // long payloads take the vectorized path, and the scalar path for the tail
+		std::vector<uint8_t> bytes;
+		for(size_t i = 0; i < 79; ++i) { bytes.push_back(static_cast<uint8_t>(i * 37 + 11)); }
+		for(bool uppercase : {true, false}) {
+			std::string encoded = HexCodec::encode(bytes.data(), bytes.size(), uppercase);
+			BOOST_CHECK(HexCodec::decode(encoded) == bytes);
+			BOOST_CHECK(fromStringView<HexString>(encoded).data == bytes);
+			for(size_t invalidPos : {0, 17, 31, 63, 157}) {
+				std::string invalid = encoded;
+				invalid[invalidPos] = 'x';
+				BOOST_CHECK_THROW(HexCodec::decode(invalid), std::runtime_error);
+			}
+		}
+		BOOST_CHECK_THROW(HexCodec::decode("ABC"), std::runtime_error);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( separatorIndexTest ) {
+	std::string block;
+	for(size_t i = 0; i < 1000; ++i) {
+		block += std::to_string(i * 7919 % 1013);
+		block += (i % 5 == 0) ? '\n' : ';';
+	}
+	SeparatorIndex index(block);
+	for(size_t pos = 0; pos <= block.size(); ++pos) {
+		BOOST_REQUIRE_EQUAL(index.nextFieldSeparator(pos), block.find(';', pos));
+		BOOST_REQUIRE_EQUAL(index.nextLineSeparator(pos), block.find('\n', pos));
+	}
+	SeparatorIndex emptyIndex((std::string_view()));
+	BOOST_CHECK_EQUAL(emptyIndex.nextFieldSeparator(0), std::string_view::npos);
 }
 
 
@@ -153,6 +248,478 @@ BOOST_AUTO_TEST_CASE ( parsersOnTestFiles ) {
 	}
 }
 
+static void testMappedParserOnTestFile(const std::string& filePath) {
+	std::fstream recordFile(filePath);
+	BOOST_REQUIRE(recordFile.is_open());
+	VisitingParser visitParser(recordFile);
+	MappedVisitingParser mappedParser(filePath);
+
+	RawSensorEvent rawSensorEvent;
+	RawSensorEventView rawSensorEventView;
+	while(visitParser.nextLine(rawSensorEvent)) {
+		BOOST_REQUIRE(mappedParser.nextLine(rawSensorEventView));
+		BOOST_CHECK_EQUAL(rawSensorEventView.timestamp, rawSensorEvent.timestamp);
+		BOOST_CHECK_EQUAL(rawSensorEventView.eventId, rawSensorEvent.eventId);
+		BOOST_CHECK_EQUAL(rawSensorEventView.parameterString, rawSensorEvent.parameterString);
+		SensorEvent parsedEvent = SensorEvent::parse(rawSensorEventView);
+		BOOST_CHECK_EQUAL(parsedEvent.timestamp, rawSensorEvent.timestamp);
+		BOOST_CHECK(parsedEvent.eventType == static_cast<EventType>(rawSensorEvent.eventId));
+	}
+	BOOST_CHECK(!mappedParser.nextLine(rawSensorEventView));
+}
+
+BOOST_AUTO_TEST_CASE ( mappedParserOnTestFiles ) {
+	testMappedParserOnTestFile("testFiles/radioData.csv");
+	testMappedParserOnTestFile("testFiles/sensorData.csv");
+	testMappedParserOnTestFile("testFiles/customActivity.csv");
+	{ // parsing from an arbitrary buffer, without trailing newline
+		auto parser = MappedVisitingParser::fromBuffer(("0;-3;fafca664-c9be-4adb-a8d8-8e8c57b71e43\n21221425;0;1.4317327;5.0996494;7.9870567"));
+		RawSensorEventView evt;
+		BOOST_CHECK(parser.nextLine(evt));
+		BOOST_CHECK_EQUAL(evt.eventId, EVENTID_RECORDING_ID);
+		BOOST_CHECK(parser.nextLine(evt));
+		BOOST_CHECK_EQUAL(evt.timestamp, 21221425);
+		BOOST_CHECK_EQUAL(evt.parameterString, "1.4317327;5.0996494;7.9870567");
+		BOOST_CHECK(!parser.nextLine(evt));
+	}
+	BOOST_CHECK_THROW(MappedVisitingParser("testFiles/doesNotExist.csv"), std::runtime_error);
+}
+static void testParallelParserOnTestFile(const std::string& filePath, size_t threadCnt, size_t chunkSize) {
+	std::fstream recordFileS(filePath);
+	BOOST_REQUIRE(recordFileS.is_open());
+	std::fstream recordFileP(filePath);
+	BOOST_REQUIRE(recordFileP.is_open());
+	auto sequentialResult = AggregatingParser(recordFileS).parse();
+	auto parallelResult = AggregatingParser(recordFileP).parseParallel({threadCnt, chunkSize});
+	BOOST_REQUIRE_EQUAL(sequentialResult.size(), parallelResult.size());
+	RawSensorEvent sequentialRaw, parallelRaw;
+	for(size_t i = 0; i < sequentialResult.size(); ++i) {
+		sequentialResult[i].serializeInto(sequentialRaw);
+		parallelResult[i].serializeInto(parallelRaw);
+		BOOST_CHECK_EQUAL(sequentialRaw.timestamp, parallelRaw.timestamp);
+		BOOST_CHECK_EQUAL(sequentialRaw.eventId, parallelRaw.eventId);
+		BOOST_CHECK_EQUAL(sequentialRaw.parameterString, parallelRaw.parameterString);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( parallelParserOnTestFiles ) {
+	testParallelParserOnTestFile("testFiles/radioData.csv", 4, 64);
+	testParallelParserOnTestFile("testFiles/sensorData.csv", 4, 4096);
+	testParallelParserOnTestFile("testFiles/sensorData.csv", 1, 1);
+	testParallelParserOnTestFile("testFiles/sensorData.csv", 0, 1024 * 1024);
+	testParallelParserOnTestFile("testFiles/customActivity.csv", 3, 100);
+	{ // errors in worker threads are propagated
+		std::stringstream brokenStream("0;-3;fafca664-c9be-4adb-a8d8-8e8c57b71e43\n21221425;0;1.4317327;5.0996494\n");
+		BOOST_CHECK_THROW(AggregatingParser(brokenStream).parseParallel({2, 8}), std::runtime_error);
+	}
+}
+void testPipelineOnTestFile(const std::string& filePath, size_t parserCnt, size_t chunkSize, size_t queueDepth) {
+	std::fstream recordFileS(filePath);
+	BOOST_REQUIRE(recordFileS.is_open());
+	std::fstream recordFileP(filePath);
+	BOOST_REQUIRE(recordFileP.is_open());
+	auto sequentialResult = AggregatingParser(recordFileS).parse();
+	VisitingParser parser(recordFileP);
+	std::vector<RawSensorEvent> pipelineResult;
+	size_t eventCnt = ParsePipeline(parser, {parserCnt, chunkSize, queueDepth}).run([&](const SensorEvent& evt) {
+		evt.serializeInto(pipelineResult.emplace_back());
+	});
+	BOOST_REQUIRE_EQUAL(eventCnt, sequentialResult.size());
+	BOOST_REQUIRE_EQUAL(pipelineResult.size(), sequentialResult.size());
+	RawSensorEvent sequentialRaw;
+	for(size_t i = 0; i < sequentialResult.size(); ++i) {
+		sequentialResult[i].serializeInto(sequentialRaw);
+		BOOST_CHECK_EQUAL(sequentialRaw.timestamp, pipelineResult[i].timestamp);
+		BOOST_CHECK_EQUAL(sequentialRaw.eventId, pipelineResult[i].eventId);
+		BOOST_CHECK_EQUAL(sequentialRaw.parameterString, pipelineResult[i].parameterString);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( pipelineOnTestFiles ) {
+	testPipelineOnTestFile("testFiles/radioData.csv", 3, 64, 1);
+	testPipelineOnTestFile("testFiles/sensorData.csv", 4, 4096, 2);
+	testPipelineOnTestFile("testFiles/sensorData.csv", 1, 1, 1);
+	testPipelineOnTestFile("testFiles/sensorData.csv", 0, 1024 * 1024, 4);
+	testPipelineOnTestFile("testFiles/customActivity.csv", 2, 100, 3);
+	{ // errors in parse stages are propagated
+		std::stringstream brokenStream("0;-3;fafca664-c9be-4adb-a8d8-8e8c57b71e43\n21221425;0;1.4317327;5.0996494\n");
+		VisitingParser parser(brokenStream);
+		BOOST_CHECK_THROW(ParsePipeline(parser, {2, 8}).run([](const SensorEvent&) {}), std::runtime_error);
+	}
+	{ // errors in the consumer stop the pipeline and are propagated
+		std::fstream recordFile("testFiles/sensorData.csv");
+		VisitingParser parser(recordFile);
+		size_t consumedCnt = 0;
+		BOOST_CHECK_THROW(ParsePipeline(parser, {2, 256, 1}).run([&](const SensorEvent&) {
+			if(++consumedCnt == 10) { throw std::runtime_error("Consumer failed"); }
+		}), std::runtime_error);
+		BOOST_CHECK_EQUAL(consumedCnt, 10);
+	}
+	{ // the event filter of the parser is applied
+		std::fstream recordFile("testFiles/sensorData.csv");
+		VisitingParser parser(recordFile);
+		parser.setEventFilter(EventTypeFilter{EventType::Accelerometer});
+		size_t eventCnt = ParsePipeline(parser, {2, 512}).run([](const SensorEvent& evt) {
+			BOOST_CHECK(evt.eventType == EventType::Accelerometer);
+		});
+		BOOST_CHECK(eventCnt > 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( spscQueue ) {
+	SPSCQueue<size_t> queue(5);
+	BOOST_CHECK_EQUAL(queue.capacity(), 8);
+	const size_t valueCnt = 100000;
+	std::thread producer([&]() {
+		for(size_t i = 0; i < valueCnt; ++i) {
+			while(!queue.tryPush(i)) { std::this_thread::yield(); }
+		}
+		queue.close();
+	});
+	size_t expected = 0, value;
+	while(!queue.isDrained()) {
+		if(!queue.tryPop(value)) {
+			std::this_thread::yield();
+			continue;
+		}
+		BOOST_REQUIRE_EQUAL(value, expected);
+		++expected;
+	}
+	producer.join();
+	BOOST_CHECK_EQUAL(expected, valueCnt);
+	BOOST_CHECK(!queue.tryPop(value));
+}
+
+BOOST_AUTO_TEST_CASE ( eventFilterOnTestFiles ) {
+	EventTypeFilter filter{EventType::Accelerometer, EventType::Gyroscope, EventType::FileMetadata};
+	BOOST_CHECK(filter.accepts(EventType::Gyroscope));
+	BOOST_CHECK(filter.accepts(EVENTID_FILE_METADATA));
+	BOOST_CHECK(!filter.accepts(EventType::Wifi));
+	BOOST_CHECK(!filter.accepts(1337));
+	BOOST_CHECK(!filter.accepts(-1337));
+
+	std::fstream recordFile("testFiles/sensorData.csv");
+	BOOST_REQUIRE(recordFile.is_open());
+	AggregatingParser::AggregatedParseResult expectedResult;
+	for(auto& evt : AggregatingParser(recordFile).parse()) {
+		if(filter.accepts(evt.eventType)) { expectedResult.push_back(evt); }
+	}
+	BOOST_REQUIRE(expectedResult.size() > 0);
+
+	auto checkFilteredResult = [&](const AggregatingParser::AggregatedParseResult& result) {
+		BOOST_REQUIRE_EQUAL(result.size(), expectedResult.size());
+		for(size_t i = 0; i < result.size(); ++i) {
+			BOOST_CHECK_EQUAL(result[i].timestamp, expectedResult[i].timestamp);
+			BOOST_CHECK(result[i].eventType == expectedResult[i].eventType);
+		}
+	};
+	{
+		std::fstream filteredFile("testFiles/sensorData.csv");
+		AggregatingParser parser(filteredFile);
+		parser.setEventFilter(filter);
+		checkFilteredResult(parser.parse());
+	}
+	{
+		std::fstream filteredFile("testFiles/sensorData.csv");
+		AggregatingParser parser(filteredFile);
+		parser.setEventFilter(filter);
+		checkFilteredResult(parser.parseParallel({4, 8192}));
+	}
+	{
+		MappedVisitingParser parser("testFiles/sensorData.csv");
+		parser.setEventFilter(filter);
+		AggregatingParser::AggregatedParseResult result;
+		RawSensorEventView rawEvt;
+		while(parser.nextLine(rawEvt)) { result.push_back(SensorEvent::parse(rawEvt)); }
+		checkFilteredResult(result);
+	}
+	{ // rejected lines are not decoded, thus broken parameters of rejected events do not throw
+		std::stringstream stream("0;8;broken\n1;0;1.0;2.0;3.0\n2;9;broken\n");
+		VisitingParser parser(stream);
+		parser.setEventFilter(EventTypeFilter{EventType::Accelerometer});
+		RawSensorEvent rawEvt;
+		BOOST_CHECK(parser.nextLine(rawEvt));
+		BOOST_CHECK_EQUAL(rawEvt.timestamp, 1);
+		BOOST_CHECK_NO_THROW(SensorEvent::parse(rawEvt));
+		BOOST_CHECK(!parser.nextLine(rawEvt));
+	}
+}
+static void testColumnarRecordingOnTestFile(const std::string& filePath) {
+	std::fstream recordFile(filePath);
+	BOOST_REQUIRE(recordFile.is_open());
+	auto events = AggregatingParser(recordFile).parse();
+
+	MappedVisitingParser mappedParser(filePath);
+	ColumnarRecording parsedRecording = ColumnarRecording::parse(mappedParser);
+	ColumnarRecording addedRecording;
+	for(const auto& evt : events) { addedRecording.add(evt); }
+	BOOST_CHECK_EQUAL(parsedRecording.size(), events.size());
+	BOOST_CHECK_EQUAL(addedRecording.size(), events.size());
+
+	// walk through the events in order, and compare them with the next entry of the respective store
+	std::map<EventType, size_t> storeIndices;
+	size_t otherIdx = 0;
+	RawSensorEvent expectedRaw, actualRaw;
+	for(const auto& evt : events) {
+		size_t idx = storeIndices[evt.eventType]++;
+		SensorEvent reconstructed;
+		reconstructed.eventType = evt.eventType;
+		#define COLUMNAR_TEST_CASE(EvtType, EvtStruct) \
+			case EvtType: \
+				BOOST_CHECK_EQUAL(parsedRecording.channel<EvtStruct>().timestamps[idx], evt.timestamp); \
+				reconstructed.timestamp = parsedRecording.channel<EvtStruct>().timestamps[idx]; \
+				reconstructed.data = parsedRecording.channel<EvtStruct>().at(idx); \
+				break;
+		switch(evt.eventType) {
+			SENSORREADOUT_NUMERIC_EVENTS(COLUMNAR_TEST_CASE)
+			case EventType::Wifi:
+				reconstructed.timestamp = parsedRecording.wifi().timestamps[idx];
+				reconstructed.data = parsedRecording.wifi().at(idx);
+				break;
+			case EventType::BLE:
+				reconstructed.timestamp = parsedRecording.ble().timestamps[idx];
+				reconstructed.data = parsedRecording.ble().at(idx);
+				break;
+			case EventType::DecawaveUWB:
+				reconstructed.timestamp = parsedRecording.decawaveUWB().timestamps[idx];
+				reconstructed.data = parsedRecording.decawaveUWB().at(idx);
+				break;
+			default:
+				reconstructed = parsedRecording.others()[otherIdx++];
+				break;
+		}
+		evt.serializeInto(expectedRaw);
+		reconstructed.serializeInto(actualRaw);
+		BOOST_CHECK_EQUAL(expectedRaw.timestamp, actualRaw.timestamp);
+		BOOST_CHECK_EQUAL(expectedRaw.parameterString, actualRaw.parameterString);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( columnarRecordingOnTestFiles ) {
+	testColumnarRecordingOnTestFile("testFiles/radioData.csv");
+	testColumnarRecordingOnTestFile("testFiles/customActivity.csv");
+
+	MappedVisitingParser mappedParser("testFiles/sensorData.csv");
+	ColumnarRecording recording = ColumnarRecording::parse(mappedParser);
+	const auto& accel = recording.channel<AccelerometerEvent>();
+	BOOST_REQUIRE(accel.size() > 2);
+	BOOST_CHECK_EQUAL(accel.values.size(), accel.size() * 3);
+	BOOST_CHECK_EQUAL(accel.timestamps[0], 21221425);
+	BOOST_CHECK_CLOSE(accel.value(0, 0), 1.4317327, 0.0001);
+	BOOST_CHECK_CLOSE(accel.value(1, 2), 7.9822683, 0.0001);
+	BOOST_CHECK_CLOSE(accel.at(1).y, 5.2480903, 0.0001);
+	BOOST_CHECK_CLOSE(recording.channel<HeadingChangeEvent>().value(0, 0), 1.5707963, 0.0001);
+
+	{ // loading the binary representation yields the identical recording
+		std::stringstream binary;
+		{
+			std::ifstream inputFile("testFiles/sensorData.csv");
+			VisitingParser parser(inputFile);
+			BinaryWriter writer(binary);
+			convertToBinary(parser, writer);
+		}
+		BinaryReader reader(binary);
+		ColumnarRecording binaryRecording = ColumnarRecording::parse(reader);
+		BOOST_CHECK_EQUAL(binaryRecording.size(), recording.size());
+		BOOST_CHECK(binaryRecording.channel<AccelerometerEvent>().timestamps == accel.timestamps);
+		BOOST_CHECK(binaryRecording.channel<AccelerometerEvent>().values == accel.values);
+		BOOST_CHECK(binaryRecording.channel<GroundTruthEvent>().values == recording.channel<GroundTruthEvent>().values);
+	}
+	recording.clear();
+	BOOST_CHECK_EQUAL(recording.size(), 0);
+}
+
+
+BOOST_AUTO_TEST_CASE ( recordingIndexOnTestFiles ) {
+	const std::string recordingPath = "testFiles/sensorData.csv";
+	std::ifstream inputFile(recordingPath);
+	BOOST_REQUIRE(inputFile.is_open());
+	auto rawEvents = AggregatingParser(inputFile).parseRaw();
+
+	RecordingIndexOptions options;
+	options.blockLineCnt = 64;
+	options.indexedEventTypes = EventTypeFilter { EventType::GroundTruth, EventType::Pressure };
+	RecordingIndex index = RecordingIndex::build(recordingPath, FileVersion::V1, options);
+	BOOST_CHECK_EQUAL(index.getLineCnt(), rawEvents.size());
+	BOOST_CHECK_EQUAL(index.getBlocks().size(), (rawEvents.size() + 63) / 64);
+	BOOST_CHECK_EQUAL(index.events(EventType::GroundTruth).size(), 2);
+	BOOST_CHECK(index.events(EventType::Accelerometer).empty());
+
+	{ // sidecar roundtrip
+		std::filesystem::remove(RecordingIndex::sidecarPath(recordingPath));
+		RecordingIndex built = RecordingIndex::loadOrBuild(recordingPath, FileVersion::V1, options);
+		BOOST_REQUIRE(std::filesystem::exists(RecordingIndex::sidecarPath(recordingPath)));
+		RecordingIndex loaded = RecordingIndex::loadOrBuild(recordingPath, FileVersion::V1, options);
+		BOOST_CHECK(loaded.getOptions() == options);
+		BOOST_CHECK_EQUAL(loaded.getLineCnt(), index.getLineCnt());
+		BOOST_REQUIRE_EQUAL(loaded.getBlocks().size(), index.getBlocks().size());
+		for(size_t i = 0; i < index.getBlocks().size(); ++i) {
+			BOOST_CHECK_EQUAL(loaded.getBlocks()[i].offset, index.getBlocks()[i].offset);
+			BOOST_CHECK_EQUAL(loaded.getBlocks()[i].maxTimestampUpTo, index.getBlocks()[i].maxTimestampUpTo);
+			BOOST_CHECK_EQUAL(loaded.getBlocks()[i].minTimestampFrom, index.getBlocks()[i].minTimestampFrom);
+		}
+		BOOST_CHECK_EQUAL(loaded.events(EventType::Pressure).size(), index.events(EventType::Pressure).size());
+
+		// a sidecar built with different options is rebuilt
+		RecordingIndex rebuilt = RecordingIndex::loadOrBuild(recordingPath);
+		BOOST_CHECK(rebuilt.getOptions() == RecordingIndexOptions());
+		BOOST_CHECK_EQUAL(rebuilt.getBlocks().size(), (rawEvents.size() + 1023) / 1024);
+		BOOST_CHECK(!rebuilt.events(EventType::Accelerometer).empty());
+		std::filesystem::remove(RecordingIndex::sidecarPath(recordingPath));
+	}
+	{ // a sidecar is rebuilt when the recording was modified without changing its size or modification time
+		const std::string copyPath = (std::filesystem::temp_directory_path() / "recordingIndexModified.csv").string();
+		std::filesystem::copy_file(recordingPath, copyPath, std::filesystem::copy_options::overwrite_existing);
+		RecordingIndex original = RecordingIndex::loadOrBuild(copyPath, FileVersion::V1, options);
+		const auto originalMTime = std::filesystem::last_write_time(copyPath);
+		{ // drop the first line, and pad the last one to keep the size
+			std::ifstream copyIn(copyPath);
+			std::string content((std::istreambuf_iterator<char>(copyIn)), std::istreambuf_iterator<char>());
+			const size_t firstLineLength = content.find('\n') + 1;
+			content.erase(0, firstLineLength);
+			content.insert(content.size() - 1, std::string(firstLineLength, ' '));
+			std::ofstream copyOut(copyPath, std::ios::trunc);
+			copyOut << content;
+		}
+		std::filesystem::last_write_time(copyPath, originalMTime);
+		RecordingIndex modified = RecordingIndex::loadOrBuild(copyPath, FileVersion::V1, options);
+		BOOST_CHECK_EQUAL(modified.getRecordingSize(), original.getRecordingSize());
+		BOOST_CHECK_EQUAL(modified.getLineCnt(), original.getLineCnt() - 1);
+		std::filesystem::remove(RecordingIndex::sidecarPath(copyPath));
+		std::filesystem::remove(copyPath);
+	}
+	{ // corrupted sidecars are rejected by load(), and rebuilt by loadOrBuild()
+		const std::string indexPath = RecordingIndex::sidecarPath(recordingPath);
+		RecordingIndex::build(recordingPath, FileVersion::V1, options).save(indexPath);
+		std::ifstream indexIn(indexPath, std::ios::binary);
+		const std::string intact((std::istreambuf_iterator<char>(indexIn)), std::istreambuf_iterator<char>());
+		// header (4 + 2 + 2), recording size, mtime and hash (3 * 8), fileVersion (1), blockLineCnt (8) and the filter flag (1)
+		const size_t filterCntOffset = 8 + 3 * 8 + 1 + 8 + 1;
+		auto corrupt = [&](size_t offset, auto value) {
+			std::string corrupted = intact;
+			std::memcpy(&corrupted[offset], &value, sizeof(value));
+			return corrupted;
+		};
+		for(const std::string& corrupted : {
+				corrupt(filterCntOffset, UINT64_MAX), // garbage array length
+				corrupt(filterCntOffset + 8, EventId(5000)), // event id outside of the known range
+				intact.substr(0, intact.size() / 2) }) {
+			{
+				std::ofstream indexOut(indexPath, std::ios::binary | std::ios::trunc);
+				indexOut << corrupted;
+			}
+			BOOST_CHECK_THROW(RecordingIndex::load(indexPath), std::runtime_error);
+			RecordingIndex rebuilt = RecordingIndex::loadOrBuild(recordingPath, FileVersion::V1, options);
+			BOOST_CHECK(rebuilt.getOptions() == options);
+			BOOST_CHECK_EQUAL(rebuilt.getLineCnt(), index.getLineCnt());
+		}
+		std::filesystem::remove(indexPath);
+	}
+
+	inputFile.clear();
+	SeekableReader reader(inputFile, index);
+	{ // seeking to indexed events
+		for(const auto& entry : index.events(EventType::GroundTruth)) {
+			VisitingParser parser = reader.parserAtOffset(entry.offset);
+			RawSensorEvent rawEvt;
+			BOOST_REQUIRE(parser.nextLine(rawEvt));
+			BOOST_CHECK_EQUAL(rawEvt.eventId, EVENTID_GROUND_TRUTH);
+			BOOST_CHECK_EQUAL(rawEvt.timestamp, entry.timestamp);
+		}
+		VisitingParser parser = reader.parserAtTime(0);
+		RawSensorEvent rawEvt;
+		BOOST_REQUIRE(parser.nextLine(rawEvt));
+		BOOST_CHECK_EQUAL(rawEvt.timestamp, rawEvents.front().timestamp);
+	}
+	{ // time-range queries match a full scan
+		EventTypeFilter queryFilter { EventType::Gyroscope, EventType::Pressure, EventType::GroundTruth };
+		Timestamp firstTimestamp = rawEvents.front().timestamp;
+		Timestamp lastTimestamp = rawEvents.back().timestamp;
+		Timestamp step = (lastTimestamp - firstTimestamp) / 7;
+		for(Timestamp begin = firstTimestamp - step; begin < lastTimestamp + step; begin += step) {
+			for(Timestamp length : {Timestamp(0), Timestamp(1), step / 13, step, 3 * step}) {
+				std::vector<RawSensorEvent> expected;
+				std::copy_if(rawEvents.begin(), rawEvents.end(), std::back_inserter(expected), [&](const RawSensorEvent& rawEvt) {
+					return rawEvt.timestamp >= begin && rawEvt.timestamp < begin + length && queryFilter.accepts(rawEvt.eventId);
+				});
+				auto result = reader.query(begin, begin + length, queryFilter);
+				BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+				for(size_t i = 0; i < result.size(); ++i) {
+					BOOST_CHECK_EQUAL(result[i].timestamp, expected[i].timestamp);
+					BOOST_CHECK_EQUAL(result[i].parameterString, expected[i].parameterString);
+				}
+			}
+		}
+	}
+}
+
+
+#ifdef SENSORREADOUT_WITH_ZLIB
+static std::string gzipCompress(const std::string& input) {
+	z_stream zStream = {};
+	BOOST_REQUIRE(deflateInit2(&zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+	std::string result(deflateBound(&zStream, input.size()), '\0');
+	zStream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+	zStream.avail_in = input.size();
+	zStream.next_out = reinterpret_cast<Bytef*>(result.data());
+	zStream.avail_out = result.size();
+	BOOST_REQUIRE(deflate(&zStream, Z_FINISH) == Z_STREAM_END);
+	result.resize(zStream.total_out);
+	deflateEnd(&zStream);
+	return result;
+}
+
+BOOST_AUTO_TEST_CASE ( gzipInputOnTestFiles ) {
+	std::ifstream inputFile("testFiles/sensorData.csv");
+	BOOST_REQUIRE(inputFile.is_open());
+	const std::string content((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+	std::istringstream plainInput(content);
+	auto expected = AggregatingParser(plainInput).parseRaw();
+
+	auto checkEqual = [&](const std::vector<RawSensorEvent>& result) {
+		BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+		for(size_t i = 0; i < result.size(); ++i) {
+			BOOST_CHECK_EQUAL(result[i].timestamp, expected[i].timestamp);
+			BOOST_CHECK_EQUAL(result[i].eventId, expected[i].eventId);
+			BOOST_CHECK_EQUAL(result[i].parameterString, expected[i].parameterString);
+		}
+	};
+
+	const std::string compressed = gzipCompress(content);
+	{ // small blocks, such that lines cross block borders
+		std::istringstream compressedInput(compressed);
+		BOOST_CHECK(GzipInputStream::isGzip(compressedInput));
+		GzipInputStream input(compressedInput, 4096);
+		checkEqual(AggregatingParser(input).parseRaw());
+	}
+	{ // concatenated gzip members
+		size_t split = content.find('\n', content.size() / 2) + 1;
+		std::istringstream compressedInput(gzipCompress(content.substr(0, split)) + gzipCompress(content.substr(split)));
+		GzipInputStream input(compressedInput);
+		checkEqual(AggregatingParser(input).parseRaw());
+	}
+	{ // stopping early does not block
+		std::istringstream compressedInput(compressed);
+		GzipInputStream input(compressedInput, 1024);
+		VisitingParser parser(input);
+		RawSensorEvent rawEvt;
+		BOOST_CHECK(parser.nextLine(rawEvt));
+	}
+	{ // corrupted and truncated input
+		std::string corrupted = compressed;
+		for(size_t i = corrupted.size() / 2; i < corrupted.size() / 2 + 64; ++i) { corrupted[i] = ~corrupted[i]; }
+		std::istringstream corruptedInput(corrupted);
+		GzipInputStream input(corruptedInput);
+		BOOST_CHECK_THROW(AggregatingParser(input).parseRaw(), std::runtime_error);
+
+		std::istringstream truncatedInput(compressed.substr(0, compressed.size() / 2));
+		GzipInputStream truncated(truncatedInput);
+		BOOST_CHECK_THROW(AggregatingParser(truncated).parseRaw(), std::runtime_error);
+		std::istringstream plain(content);
+		BOOST_CHECK(!GzipInputStream::isGzip(plain));
+	}
+}
+#endif
 
 
 // ###########
@@ -287,10 +854,10 @@ BOOST_AUTO_TEST_CASE ( GroundTruthPathEventParserTest ) {
 	BOOST_CHECK_THROW(gtpEvt.parse("0;"), std::runtime_error);
 
 	BOOST_CHECK_NO_THROW(gtpEvt.parse("0;0"));
-	BOOST_CHECK_EQUAL(gtpEvt.pathId, 0);
+	BOOST_CHECK_EQUAL(gtpEvt.pathId, "0");
 	BOOST_CHECK_EQUAL(gtpEvt.groundTruthPointCnt, 0);
 	BOOST_CHECK_NO_THROW(gtpEvt.parse("1337;42"));
-	BOOST_CHECK_EQUAL(gtpEvt.pathId, 1337);
+	BOOST_CHECK_EQUAL(gtpEvt.pathId, "1337");
 	BOOST_CHECK_EQUAL(gtpEvt.groundTruthPointCnt, 42);
 }
 
@@ -310,3 +877,528 @@ BOOST_AUTO_TEST_CASE ( CustomActivityType ) {
 		BOOST_CHECK_EQUAL(actEvt.rawActivityName, "CUSTOM_5");
 	}
 }
+
+BOOST_AUTO_TEST_CASE ( liveSimulatorStreaming ) {
+	std::fstream recordFile("testFiles/sensorData.csv");
+	BOOST_REQUIRE(recordFile.is_open());
+	auto expectedResult = AggregatingParser(recordFile).parse();
+
+	recordFile.clear();
+	recordFile.seekg(0);
+	VisitingParser parser(recordFile);
+	std::vector<Timestamp> replayedTimestamps;
+	bool ended = false;
+	LiveSimulator simulator(0);
+	simulator.setEventSource(parser, 16);
+	simulator.setSensorEventCallback([&](const SensorEvent& evt) { replayedTimestamps.push_back(evt.timestamp); });
+	simulator.setRecordingEndedCallback([&]() { ended = true; });
+	simulator.start();
+	simulator.wait();
+	BOOST_CHECK(ended);
+	BOOST_REQUIRE_EQUAL(replayedTimestamps.size(), expectedResult.size());
+	for(size_t i = 0; i < expectedResult.size(); ++i) {
+		BOOST_CHECK_EQUAL(replayedTimestamps[i], expectedResult[i].timestamp);
+	}
+
+	{ // errors of the event source end the replay, and are rethrown by wait()
+		std::stringstream brokenStream("0;0;1.0;2.0;3.0\n1;0;broken\n2;0;1.0;2.0;3.0\n");
+		VisitingParser brokenParser(brokenStream);
+		LiveSimulator brokenSimulator(0);
+		size_t replayedCnt = 0;
+		ended = false;
+		brokenSimulator.setEventSource(brokenParser, 1);
+		brokenSimulator.setSensorEventCallback([&](const SensorEvent&) { ++replayedCnt; });
+		brokenSimulator.setRecordingEndedCallback([&]() { ended = true; });
+		brokenSimulator.start();
+		BOOST_CHECK_THROW(brokenSimulator.wait(), std::runtime_error);
+		BOOST_CHECK_EQUAL(replayedCnt, 1);
+		BOOST_CHECK(!ended);
+	}
+	{ // stopping while the read-ahead buffer is full
+		std::fstream longFile("testFiles/sensorData.csv");
+		VisitingParser longParser(longFile);
+		LiveSimulator slowSimulator(1.0);
+		slowSimulator.setEventSource(longParser, 2);
+		slowSimulator.start();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		slowSimulator.stop();
+	}
+	{ // stopping while waiting for a slow source does not report the end of the recording
+		LiveSimulator stoppedSimulator(0);
+		size_t replayedCnt = 0;
+		ended = false;
+		stoppedSimulator.setEventSource([ts = Timestamp(0)](SensorEvent& evt) mutable {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			evt = SensorEvent { ts++, EventType::Accelerometer, AccelerometerEvent {} };
+			return true;
+		}, 1);
+		stoppedSimulator.setSensorEventCallback([&](const SensorEvent&) { ++replayedCnt; });
+		stoppedSimulator.setRecordingEndedCallback([&]() { ended = true; });
+		stoppedSimulator.start();
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		stoppedSimulator.stop();
+		BOOST_CHECK_GT(replayedCnt, 0);
+		BOOST_CHECK(!ended);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( liveSimulatorSchedule ) {
+	// 2s of 400Hz accelerometer with a burst of 20 wifi scans every 500ms, replayed at 20x
+	std::vector<SensorEvent> evts;
+	for(Timestamp ts = 0; ts < 2000000000; ts += 2500000) {
+		evts.push_back(SensorEvent { ts, EventType::Accelerometer, AccelerometerEvent {} });
+		if(ts % 500000000 == 0) {
+			for(size_t i = 0; i < 20; ++i) { evts.push_back(SensorEvent { ts + i * 1000, EventType::Wifi, WifiEvent {} }); }
+		}
+	}
+	LiveSimulator simulator(20.0);
+	LiveSimulator::ScheduleOptions scheduleOptions;
+	scheduleOptions.quantum = std::chrono::microseconds(200);
+	scheduleOptions.spinThreshold = std::chrono::microseconds(100);
+	simulator.setScheduleOptions(scheduleOptions);
+	simulator.setEvents(evts);
+	std::vector<std::chrono::steady_clock::time_point> dispatchTimes;
+	dispatchTimes.reserve(evts.size());
+	simulator.setSensorEventCallback([&](const SensorEvent&) { dispatchTimes.push_back(std::chrono::steady_clock::now()); });
+	auto startTime = std::chrono::steady_clock::now();
+	simulator.start();
+	simulator.wait();
+	auto durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+	BOOST_CHECK_GE(durationMs, 99);
+	BOOST_CHECK_LE(durationMs, 2000); // only guards against hangs, loaded machines can delay single wakeups arbitrarily
+	// absolute deadlines: lateness does not accumulate over the wakeups. Medians are robust against single preemptions,
+	// while relative sleeps would add their overshoot (usually >= 50us timer slack) for each of the ~800 wakeups.
+	BOOST_REQUIRE_EQUAL(dispatchTimes.size(), evts.size());
+	auto medianLatenessUs = [&](size_t begin, size_t end) {
+		std::vector<int64_t> lateness;
+		for(size_t i = begin; i < end; ++i) {
+			auto deadline = startTime + std::chrono::nanoseconds(static_cast<int64_t>(evts[i].timestamp / 20));
+			lateness.push_back(std::chrono::duration_cast<std::chrono::microseconds>(dispatchTimes[i] - deadline).count());
+		}
+		std::nth_element(lateness.begin(), lateness.begin() + lateness.size() / 2, lateness.end());
+		return lateness[lateness.size() / 2];
+	};
+	const size_t tenthCnt = evts.size() / 10;
+	BOOST_CHECK_LE(medianLatenessUs(evts.size() - tenthCnt, evts.size()), medianLatenessUs(0, tenthCnt) + 20000);
+	LiveSimulator::ReplayMetrics metrics = simulator.getMetrics();
+	BOOST_CHECK_EQUAL(metrics.eventCnt, evts.size());
+	// each burst is dispatched within a single wakeup
+	BOOST_CHECK_LE(metrics.wakeupCnt, 800);
+	BOOST_CHECK_GT(metrics.eventsPerWakeup(), 1.0);
+	BOOST_CHECK_EQUAL(simulator.runningTimeNs(), evts.back().timestamp);
+
+	{ // stop() interrupts waiting for a distant deadline
+		LiveSimulator slowSimulator(1.0);
+		slowSimulator.setEvents({ SensorEvent { 0, EventType::Accelerometer, AccelerometerEvent {} }, SensorEvent { 3600000000000, EventType::Accelerometer, AccelerometerEvent {} } });
+		slowSimulator.start();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		auto stopTime = std::chrono::steady_clock::now();
+		slowSimulator.stop();
+		BOOST_CHECK_LE(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - stopTime).count(), 100);
+		BOOST_CHECK_EQUAL(slowSimulator.getMetrics().eventCnt, 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( mergedReplay ) {
+	auto vectorSource = [](std::vector<SensorEvent> evts) {
+		return [evts = std::move(evts), idx = size_t(0)](SensorEvent& evt) mutable {
+			if(idx == evts.size()) { return false; }
+			evt = evts[idx++];
+			return true;
+		};
+	};
+	auto accel = [](Timestamp ts) { return SensorEvent { ts, EventType::Accelerometer, AccelerometerEvent {} }; };
+	{ // merge order, offsets and ties
+		MergedEventSource merged({ vectorSource({accel(0), accel(10), accel(20)}), vectorSource({}), vectorSource({accel(5), accel(10), accel(30)}) }, {0, 0, -5});
+		std::vector<std::pair<size_t, Timestamp>> result;
+		SensorEvent evt;
+		size_t sourceIdx;
+		while(merged.next(evt, sourceIdx)) { result.emplace_back(sourceIdx, evt.timestamp); }
+		std::vector<std::pair<size_t, Timestamp>> expected = { {0, 0}, {2, 0}, {2, 5}, {0, 10}, {0, 20}, {2, 25} };
+		BOOST_CHECK(result == expected);
+		BOOST_CHECK_THROW(MergedEventSource({ vectorSource({}) }, {1, 2}), std::runtime_error);
+	}
+	{ // synchronized replay of multiple recordings
+		std::fstream sensorFile("testFiles/sensorData.csv");
+		std::fstream radioFile("testFiles/radioData.csv");
+		std::fstream sensorFileRef("testFiles/sensorData.csv");
+		std::fstream radioFileRef("testFiles/radioData.csv");
+		BOOST_REQUIRE(sensorFile.is_open() && radioFile.is_open());
+		const size_t sensorCnt = AggregatingParser(sensorFileRef).parse().size();
+		const size_t radioCnt = AggregatingParser(radioFileRef).parse().size();
+		VisitingParser sensorParser(sensorFile);
+		VisitingParser radioParser(radioFile);
+		auto parserSource = [](VisitingParser& parser) {
+			return [&parser, rawEvent = RawSensorEvent()](SensorEvent& evt) mutable {
+				if(!parser.nextLine(rawEvent)) { return false; }
+				evt = SensorEvent::parse(rawEvent);
+				return true;
+			};
+		};
+
+		LiveSimulator simulator(0);
+		simulator.setEventSources({ parserSource(sensorParser), parserSource(radioParser) }, {0, 1000000}, 8);
+		std::vector<size_t> sourceCnts(2, 0);
+		Timestamp prevTimestamp = 0;
+		bool ordered = true;
+		simulator.setMergedSensorEventCallback([&](size_t sourceIdx, const SensorEvent& evt) {
+			++sourceCnts.at(sourceIdx);
+			ordered = ordered && (evt.timestamp >= prevTimestamp);
+			prevTimestamp = evt.timestamp;
+		});
+		simulator.start();
+		simulator.wait();
+		BOOST_CHECK(ordered);
+		BOOST_CHECK_EQUAL(sourceCnts[0], sensorCnt);
+		BOOST_CHECK_EQUAL(sourceCnts[1], radioCnt);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( resampling ) {
+	{ // linear and cubic interpolation of a quadratic function, on XYZ and 9-dimensional channels
+		NumericChannel<AccelerometerEvent> accel;
+		NumericChannel<RotationMatrixEvent> rotation;
+		auto f = [](double t, size_t c) { return 0.5 * t * t - (c + 1.0) * t + c; };
+		for(Timestamp ts = 1000; ts <= 11000; ts += 1000) {
+			AccelerometerEvent accelEvt;
+			RotationMatrixEvent rotationEvt;
+			for(size_t c = 0; c < 3; ++c) { (&accelEvt.x)[c] = static_cast<float>(f(ts / 1000.0, c)); }
+			for(size_t c = 0; c < 9; ++c) { (&rotationEvt.template getValue<0>())[c] = static_cast<float>(f(ts / 1000.0, c)); }
+			accel.push(ts, accelEvt);
+			rotation.push(ts, rotationEvt);
+		}
+		auto linear = resample(accel, 1000, 300);
+		BOOST_REQUIRE_EQUAL(linear.size(), 34);
+		BOOST_CHECK_EQUAL(linear.timestamp(33), 10900);
+		BOOST_CHECK_CLOSE(linear.value(0, 1), f(1.0, 1), 1e-4);
+		BOOST_CHECK_CLOSE(linear.value(1, 2), 0.7 * f(1.0, 2) + 0.3 * f(2.0, 2), 1e-4);
+		auto cubic = resample(rotation, 1500, 250, { Interpolation::Cubic });
+		BOOST_REQUIRE_EQUAL(cubic.size(), 39);
+		// central difference tangents reproduce quadratics exactly on a uniform grid (except at the borders)
+		for(size_t i = 2; i < 35; ++i) {
+			for(size_t c = 0; c < 9; ++c) { BOOST_CHECK_SMALL(cubic.value(i, c) - f(cubic.timestamp(i) / 1000.0, c), 1e-4); }
+		}
+		BOOST_CHECK_THROW(resample(accel, 999, 300), std::runtime_error);
+		BOOST_CHECK_THROW(resample(accel, 1000, 0), std::runtime_error);
+		BOOST_CHECK(resample(accel, 11001, 300).empty());
+		BOOST_CHECK_EQUAL(resample(accel, 11000, 300).size(), 1);
+	}
+
+	MappedVisitingParser parser("testFiles/sensorData.csv");
+	ColumnarRecording recording = ColumnarRecording::parse(parser);
+	const auto& accel = recording.channel<AccelerometerEvent>();
+	const Timestamp startTs = accel.timestamps[10] + 1234567;
+	const Timestamp interval = 5000000;
+	{ // identical to the sample-by-sample linear interpolation of timedResample.m
+		auto resampled = resample(accel, startTs, interval, { Interpolation::Linear, 4, 100 });
+		size_t jB = 0;
+		for(size_t i = 0; i < resampled.size(); ++i) {
+			Timestamp ts = startTs + i * interval;
+			while(accel.timestamps[jB + 1] < ts) { ++jB; }
+			for(size_t c = 0; c < 3; ++c) {
+				double expected = accel.value(jB, c);
+				if(accel.timestamps[jB] != ts) {
+					double alpha = static_cast<double>(ts - accel.timestamps[jB]) / static_cast<double>(accel.timestamps[jB + 1] - accel.timestamps[jB]);
+					expected = (1.0 - alpha) * accel.value(jB, c) + alpha * accel.value(jB + 1, c);
+				}
+				BOOST_CHECK_SMALL(resampled.value(i, c) - expected, 1e-4);
+			}
+		}
+		// blocks and threads do not change the result
+		auto sequential = resample(accel, startTs, interval, { Interpolation::Linear, 1, 1024 * 1024 });
+		BOOST_CHECK(sequential.values == resampled.values);
+	}
+	{ // all channels on a common grid
+		ColumnarRecording imuRecording;
+		imuRecording.channel<AccelerometerEvent>() = accel;
+		imuRecording.channel<GyroscopeEvent>() = recording.channel<GyroscopeEvent>();
+		imuRecording.channel<MagneticFieldEvent>() = recording.channel<MagneticFieldEvent>();
+		imuRecording.channel<GroundTruthEvent>().push(0, GroundTruthEvent { {}, 1 });
+		ResampledRecording resampled = ResampledRecording::resample(imuRecording, interval, { Interpolation::Cubic });
+		const Timestamp expectedStartTs = std::max({ accel.timestamps.front(), recording.channel<GyroscopeEvent>().timestamps.front(),
+				recording.channel<MagneticFieldEvent>().timestamps.front() });
+		BOOST_CHECK_EQUAL(resampled.getStartTimestamp(), expectedStartTs);
+		BOOST_REQUIRE(resampled.size() > 0);
+		BOOST_CHECK_EQUAL(resampled.channel<AccelerometerEvent>().size(), resampled.size());
+		BOOST_CHECK_EQUAL(resampled.channel<GyroscopeEvent>().size(), resampled.size());
+		BOOST_CHECK(resampled.channel<GroundTruthEvent>().empty());
+		auto single = resample(accel, expectedStartTs, interval, { Interpolation::Cubic });
+		BOOST_CHECK(std::equal(resampled.channel<AccelerometerEvent>().values.begin(), resampled.channel<AccelerometerEvent>().values.end(), single.values.begin()));
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( virtualSensors ) {
+	{ // Madgwick converges to a constant tilt, and rotates the accelerometer onto the world's z-axis
+		const float tilt = 0.5f;
+		const AccelerometerEvent accelEvt = { { {}, 0.0f, 9.81f * std::sin(tilt), 9.81f * std::cos(tilt) } };
+		const GyroscopeEvent gyroEvt = { { {}, 0.0f, 0.0f, 0.0f } };
+		MadgwickOrientation orientation(0.1f);
+		MadgwickFiltered filtered(EventType::Accelerometer, 0.1f);
+		DerivedEvent lastOrientation, lastFiltered;
+		size_t orientationCnt = 0;
+		for(Timestamp ts = 0; ts < 20000000000; ts += 10000000) {
+			for(const auto& evt : { SensorEvent { ts, EventType::Accelerometer, accelEvt }, SensorEvent { ts + 1, EventType::Gyroscope, gyroEvt } }) {
+				orientation.push(evt, [&](const DerivedEvent& derived) { lastOrientation = derived; ++orientationCnt; });
+				filtered.push(evt, [&](const DerivedEvent& derived) { lastFiltered = derived; });
+			}
+		}
+		// the first gyroscope event only provides the step size
+		BOOST_CHECK_EQUAL(orientationCnt, 1999);
+		BOOST_REQUIRE_EQUAL(lastOrientation.valueCnt, 4);
+		const auto& q = lastOrientation.values;
+		BOOST_CHECK_CLOSE(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3], 1.0f, 1e-3);
+		// gravity direction estimated in the device's coordinate system
+		BOOST_CHECK_SMALL(2 * (q[1] * q[3] - q[0] * q[2]), 1e-3f);
+		BOOST_CHECK_CLOSE(2 * (q[0] * q[1] + q[2] * q[3]), std::sin(tilt), 0.5);
+		BOOST_CHECK_CLOSE(q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3], std::cos(tilt), 0.5);
+		BOOST_REQUIRE_EQUAL(lastFiltered.valueCnt, 3);
+		BOOST_CHECK_SMALL(lastFiltered.values[0], 1e-2f);
+		BOOST_CHECK_SMALL(lastFiltered.values[1], 1e-2f);
+		BOOST_CHECK_CLOSE(lastFiltered.values[2], 9.81f, 0.1);
+	}
+	{ // acceleration split along / perpendicular to gravity, with a moving mean
+		const auto gravity = [](Timestamp ts) { return SensorEvent { ts, EventType::Gravity, GravityEvent { { {}, 0.0f, 0.0f, 9.81f } } }; };
+		const auto linear = [](Timestamp ts, float x, float z) { return SensorEvent { ts, EventType::LinearAcceleration, LinearAccelerationEvent { { {}, x, 0.0f, z } } }; };
+		std::vector<DerivedEvent> results;
+		auto sink = [&](const DerivedEvent& derived) { results.push_back(derived); };
+		NormalizedAccel normalized;
+		normalized.push(linear(0, 1, 1), sink);
+		normalized.push(gravity(1), sink);
+		normalized.push(linear(2, 3, -4), sink);
+		BOOST_REQUIRE_EQUAL(results.size(), 1);
+		BOOST_CHECK_EQUAL(results[0].timestamp, 2);
+		BOOST_CHECK_CLOSE(results[0].values[0], -4.0f, 1e-4);
+		BOOST_CHECK_CLOSE(results[0].values[1], 3.0f, 1e-4);
+		results.clear();
+		NormalizedAccel filtered(2);
+		filtered.push(gravity(0), sink);
+		filtered.push(linear(1, 2, 2), sink);
+		filtered.push(linear(2, 4, 4), sink);
+		filtered.push(linear(3, 6, 8), sink);
+		BOOST_REQUIRE_EQUAL(results.size(), 3);
+		BOOST_CHECK_CLOSE(results[1].values[0], 3.0f, 1e-4);
+		BOOST_CHECK_CLOSE(results[2].values[0], 6.0f, 1e-4);
+		BOOST_CHECK_CLOSE(results[2].values[1], 5.0f, 1e-4);
+	}
+	{ // unsupported input sensors are rejected on construction
+		BOOST_CHECK_THROW(Magnitude(EventType::Wifi), std::runtime_error);
+		BOOST_CHECK_THROW(MadgwickFiltered(EventType::Pressure), std::runtime_error);
+		BOOST_CHECK_THROW(MadgwickFiltered(EventType::BLE), std::runtime_error);
+		BOOST_CHECK_NO_THROW(Magnitude(EventType::Pressure));
+	}
+
+	// all sensors in one pass over a recording
+	MappedVisitingParser parser("testFiles/sensorData.csv");
+	std::vector<std::vector<DerivedEvent>> results(3);
+	static_assert(!std::is_move_constructible_v<VirtualSensorStage>, "the sensor sinks capture the stage");
+	VirtualSensorStage stage([&](size_t sensorIdx, const DerivedEvent& derived) { results[sensorIdx].push_back(derived); });
+	stage.add(std::make_unique<Magnitude>(EventType::Accelerometer));
+	stage.add(std::make_unique<MadgwickOrientation>());
+	stage.add(std::make_unique<MadgwickFiltered>(EventType::MagneticField));
+	BOOST_CHECK_EQUAL(stage.get(1).getChannelCnt(), 4);
+	stage.run(parser);
+
+	MappedVisitingParser recordingParser("testFiles/sensorData.csv");
+	ColumnarRecording recording = ColumnarRecording::parse(recordingParser);
+	const auto& accel = recording.channel<AccelerometerEvent>();
+	BOOST_REQUIRE_EQUAL(results[0].size(), accel.size());
+	for(size_t i = 0; i < accel.size(); ++i) {
+		BOOST_CHECK_EQUAL(results[0][i].timestamp, accel.timestamps[i]);
+		float expected = std::sqrt(accel.value(i, 0) * accel.value(i, 0) + accel.value(i, 1) * accel.value(i, 1) + accel.value(i, 2) * accel.value(i, 2));
+		BOOST_CHECK_CLOSE(results[0][i].values[0], expected, 1e-4);
+	}
+	BOOST_CHECK(!results[1].empty());
+	BOOST_CHECK(results[1].size() < recording.channel<GyroscopeEvent>().size());
+	for(const auto& derived : results[1]) {
+		const auto& q = derived.values;
+		BOOST_CHECK_CLOSE(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3], 1.0f, 1e-3);
+	}
+	BOOST_CHECK(!results[2].empty());
+}
+
+BOOST_AUTO_TEST_CASE ( recordingStatistics ) {
+	MappedVisitingParser parser("testFiles/sensorData.csv");
+	RecordingStatistics stats = RecordingStatistics::compute(parser);
+	MappedVisitingParser recordingParser("testFiles/sensorData.csv");
+	ColumnarRecording recording = ColumnarRecording::parse(recordingParser);
+	BOOST_CHECK_EQUAL(stats.getEventCnt(), recording.size());
+
+	{ // against a direct calculation on the accelerometer channel
+		const auto& accel = recording.channel<AccelerometerEvent>();
+		const EventTypeStatistics* accelStats = stats.get(EventType::Accelerometer);
+		BOOST_REQUIRE(accelStats != nullptr);
+		BOOST_CHECK_EQUAL(accelStats->eventCnt, accel.size());
+		BOOST_CHECK_EQUAL(accelStats->firstTimestamp, accel.timestamps.front());
+		BOOST_CHECK_EQUAL(accelStats->lastTimestamp, accel.timestamps.back());
+		BOOST_REQUIRE_EQUAL(accelStats->values.size(), 3);
+		for(size_t c = 0; c < 3; ++c) {
+			double sum = 0, sqSum = 0, min = accel.value(0, c), max = accel.value(0, c);
+			for(size_t i = 0; i < accel.size(); ++i) {
+				sum += accel.value(i, c);
+				min = std::min<double>(min, accel.value(i, c));
+				max = std::max<double>(max, accel.value(i, c));
+			}
+			double mean = sum / accel.size();
+			for(size_t i = 0; i < accel.size(); ++i) { sqSum += (accel.value(i, c) - mean) * (accel.value(i, c) - mean); }
+			BOOST_CHECK_CLOSE(accelStats->values[c].mean, mean, 1e-6);
+			BOOST_CHECK_CLOSE(accelStats->values[c].variance(), sqSum / accel.size(), 1e-6);
+			BOOST_CHECK_EQUAL(accelStats->values[c].min, min);
+			BOOST_CHECK_EQUAL(accelStats->values[c].max, max);
+		}
+		Timestamp largestGap = 0;
+		size_t intervalCnt = 0;
+		for(size_t i = 1; i < accel.size(); ++i) {
+			if(accel.timestamps[i] >= accel.timestamps[i - 1]) {
+				largestGap = std::max(largestGap, accel.timestamps[i] - accel.timestamps[i - 1]);
+				++intervalCnt;
+			}
+		}
+		BOOST_CHECK_EQUAL(accelStats->intervals.count, intervalCnt);
+		BOOST_CHECK_EQUAL(accelStats->intervals.count + accelStats->outOfOrderCnt + 1, accel.size());
+		BOOST_REQUIRE(!accelStats->largestGaps.empty());
+		BOOST_CHECK_EQUAL(accelStats->largestGaps.front().duration, largestGap);
+		size_t histogramCnt = 0;
+		for(size_t bucketCnt : accelStats->intervalHistogram) { histogramCnt += bucketCnt; }
+		BOOST_CHECK_EQUAL(histogramCnt, intervalCnt);
+		BOOST_CHECK_CLOSE(accelStats->meanRate(), 1e9 / accelStats->intervals.mean, 1e-6);
+		// events of unknown types only contribute their timestamps
+		BOOST_REQUIRE(stats.get(static_cast<EventType>(99)) != nullptr);
+		BOOST_CHECK_EQUAL(stats.get(static_cast<EventType>(99))->eventCnt, 2);
+	}
+
+	{ // merging the statistics of consecutive chunks equals one pass over the whole recording
+		std::ifstream eventStream("testFiles/sensorData.csv");
+		VisitingParser eventParser(eventStream);
+		std::vector<SensorEvent> events;
+		RawSensorEvent rawEvent;
+		while(eventParser.nextLine(rawEvent)) { events.push_back(SensorEvent::parse(rawEvent)); }
+		RecordingStatistics merged;
+		for(size_t chunkStart = 0; chunkStart < events.size(); chunkStart += 1000) {
+			RecordingStatistics chunk;
+			for(size_t i = chunkStart; i < std::min(events.size(), chunkStart + 1000); ++i) { chunk.add(events[i]); }
+			merged.merge(chunk);
+		}
+		BOOST_CHECK_EQUAL(merged.getEventCnt(), stats.getEventCnt());
+		BOOST_CHECK_EQUAL(merged.getDuration(), stats.getDuration());
+		BOOST_REQUIRE_EQUAL(merged.getEventTypes().size(), stats.getEventTypes().size());
+		for(const auto& [eventType, expected] : stats.getEventTypes()) {
+			const EventTypeStatistics& actual = *merged.get(eventType);
+			BOOST_CHECK_EQUAL(actual.eventCnt, expected.eventCnt);
+			BOOST_CHECK_EQUAL(actual.outOfOrderCnt, expected.outOfOrderCnt);
+			BOOST_CHECK(actual.intervalHistogram == expected.intervalHistogram);
+			BOOST_CHECK_EQUAL(actual.intervals.count, expected.intervals.count);
+			BOOST_CHECK_CLOSE(actual.intervals.mean + 1, expected.intervals.mean + 1, 1e-6);
+			BOOST_CHECK_CLOSE(actual.intervals.stddev() + 1, expected.intervals.stddev() + 1, 1e-6);
+			BOOST_REQUIRE_EQUAL(actual.largestGaps.size(), expected.largestGaps.size());
+			for(size_t i = 0; i < actual.largestGaps.size(); ++i) {
+				BOOST_CHECK_EQUAL(actual.largestGaps[i].duration, expected.largestGaps[i].duration);
+			}
+			BOOST_REQUIRE_EQUAL(actual.values.size(), expected.values.size());
+			for(size_t c = 0; c < actual.values.size(); ++c) {
+				BOOST_CHECK_CLOSE(actual.values[c].mean + 1, expected.values[c].mean + 1, 1e-6);
+				BOOST_CHECK_CLOSE(actual.values[c].variance() + 1, expected.values[c].variance() + 1, 1e-6);
+			}
+		}
+	}
+
+	{ // unique MACs per radio type
+		MappedVisitingParser radioParser("testFiles/radioData.csv");
+		RecordingStatistics radioStats = RecordingStatistics::compute(radioParser);
+		MappedVisitingParser radioRecordingParser("testFiles/radioData.csv");
+		ColumnarRecording radioRecording = ColumnarRecording::parse(radioRecordingParser);
+		std::set<std::string> wifiMacs, bleMacs;
+		for(const auto& advertisement : radioRecording.wifi().advertisements) { wifiMacs.insert(advertisement.mac.toString()); }
+		for(const auto& mac : radioRecording.ble().macs) { bleMacs.insert(mac.toString()); }
+		BOOST_REQUIRE(radioStats.get(EventType::Wifi) != nullptr);
+		BOOST_CHECK_EQUAL(radioStats.get(EventType::Wifi)->uniqueMacCnt(), wifiMacs.size());
+		BOOST_REQUIRE(radioStats.get(EventType::BLE) != nullptr);
+		BOOST_CHECK_EQUAL(radioStats.get(EventType::BLE)->uniqueMacCnt(), bleMacs.size());
+		BOOST_CHECK(radioStats.get(EventType::WifiRTT)->uniqueMacCnt() > 0);
+		BOOST_CHECK(radioStats.get(EventType::Accelerometer) == nullptr);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( macDictionary ) {
+	{ // MacAddress as hash key
+		std::unordered_map<MacAddress, int> counts;
+		counts[MacAddress::fromString("4C11AEEFE8BE")] += 1;
+		counts[MacAddress::fromColonDelimitedString("4C:11:AE:EF:E8:BE")] += 1;
+		counts[MacAddress::fromString("4C11AEEFE8BF")] += 1;
+		BOOST_CHECK_EQUAL(counts.size(), 2);
+		BOOST_CHECK_EQUAL(counts.at(MacAddress::fromString("4C11AEEFE8BE")), 2);
+		BOOST_CHECK_EQUAL(MacAddress::fromString("4C11AEEFE8BE").toUInt64(), 0x4C11AEEFE8BEull);
+	}
+	{ // dense ids in order of first occurrence, also across rehashes
+		MacDictionary dictionary;
+		std::vector<MacAddress> macs;
+		for(uint64_t i = 0; i < 5000; ++i) {
+			MacAddress mac;
+			for(size_t b = 0; b < MacAddress::MAC_LENGTH; ++b) { mac[b] = static_cast<uint8_t>((i * 0x10001ull) >> (8 * b)); }
+			macs.push_back(mac);
+			BOOST_REQUIRE_EQUAL(dictionary.intern(mac), i);
+		}
+		BOOST_CHECK_EQUAL(dictionary.size(), macs.size());
+		for(size_t i = 0; i < macs.size(); ++i) {
+			BOOST_CHECK_EQUAL(dictionary.intern(macs[i]), i);
+			BOOST_CHECK_EQUAL(dictionary.find(macs[i]), i);
+			BOOST_CHECK(dictionary.mac(static_cast<MacId>(i)) == macs[i]);
+		}
+		BOOST_CHECK_EQUAL(dictionary.find(MacAddress::fromString("FFFFFFFFFFFF")), INVALID_MAC_ID);
+		dictionary.clear();
+		BOOST_CHECK(dictionary.empty());
+		BOOST_CHECK_EQUAL(dictionary.find(macs[0]), INVALID_MAC_ID);
+		BOOST_CHECK_EQUAL(dictionary.intern(macs[42]), 0);
+	}
+	{ // parsers assign ids to all radio events
+		MacDictionary sequentialDictionary, parallelDictionary;
+		std::fstream recordFileS("testFiles/radioData.csv");
+		BOOST_REQUIRE(recordFileS.is_open());
+		AggregatingParser sequentialParser(recordFileS);
+		sequentialParser.setMacDictionary(&sequentialDictionary);
+		auto sequentialResult = sequentialParser.parse();
+		std::fstream recordFileP("testFiles/radioData.csv");
+		BOOST_REQUIRE(recordFileP.is_open());
+		AggregatingParser parallelParser(recordFileP);
+		parallelParser.setMacDictionary(&parallelDictionary);
+		auto parallelResult = parallelParser.parseParallel({4, 64});
+
+		BOOST_CHECK_EQUAL(sequentialDictionary.size(), 9);
+		BOOST_CHECK(sequentialDictionary.getMacs() == parallelDictionary.getMacs());
+		BOOST_CHECK_EQUAL(sequentialDictionary.find(MacAddress::fromString("DEADBEEF1337")), 2);
+		std::vector<size_t> advertisementsPerMac(sequentialDictionary.size(), 0);
+		for(const auto& evt : sequentialResult) {
+			switch(evt.eventType) {
+				case EventType::Wifi:
+					for(const auto& advertisement : std::get<WifiEvent>(evt.data).advertisements) {
+						BOOST_CHECK(sequentialDictionary.mac(advertisement.macId) == advertisement.mac);
+						++advertisementsPerMac[advertisement.macId];
+					}
+					break;
+				case EventType::BLE: ++advertisementsPerMac[std::get<BLEEvent>(evt.data).macId]; break;
+				case EventType::WifiRTT: BOOST_CHECK_EQUAL(std::get<WifiRTTEvent>(evt.data).macId, 8); break;
+				case EventType::EddystoneUID: BOOST_CHECK_EQUAL(std::get<EddystoneUIDEvent>(evt.data).macId, 7); break;
+				default: break;
+			}
+		}
+		BOOST_CHECK_EQUAL(advertisementsPerMac[2], 2);
+		BOOST_CHECK_EQUAL(advertisementsPerMac[3], 2);
+		std::fstream recordFileN("testFiles/radioData.csv");
+		for(const auto& evt : AggregatingParser(recordFileN).parse()) { // without a dictionary, no ids are assigned
+			if(evt.eventType == EventType::BLE) { BOOST_CHECK_EQUAL(std::get<BLEEvent>(evt.data).macId, INVALID_MAC_ID); }
+		}
+	}
+	{ // columnar stores are filled with ids as well
+		MacDictionary dictionary;
+		MappedVisitingParser parser("testFiles/radioData.csv");
+		ColumnarRecording recording = ColumnarRecording::parse(parser, &dictionary);
+		BOOST_CHECK(!dictionary.empty());
+		for(const auto& advertisement : recording.wifi().advertisements) {
+			BOOST_CHECK(dictionary.mac(advertisement.macId) == advertisement.mac);
+		}
+		BOOST_REQUIRE_EQUAL(recording.ble().macIds.size(), recording.ble().size());
+		for(size_t i = 0; i < recording.ble().size(); ++i) {
+			BOOST_CHECK(dictionary.mac(recording.ble().macIds[i]) == recording.ble().macs[i]);
+			BOOST_CHECK_EQUAL(recording.ble().at(i).macId, recording.ble().macIds[i]);
+		}
+	}
+}
@@ -2,15 +2,37 @@
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <sstream>
+#include <cstring>
+#include <limits>
+#include <csignal>
+
+#include <sys/resource.h>
 
 // use the Boost unit-testing framework with its own main
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 
 #include <sensorreadout/SensorReadoutParser.h>
+#include <sensorreadout/BinaryFormat.h>
+#include <sensorreadout/TimeSeriesCodec.h>
+#include <sensorreadout/ExternalSort.h>
 
 using namespace SensorReadoutParser;
-using namespace _internal;
+using namespace SensorReadoutParser::_internal;
+
+/** Stream buffer that fails every write after capacity bytes, like a full disk */
+struct FailingStreamBuffer : public std::streambuf {
+	size_t capacity;
+	FailingStreamBuffer(size_t capacity = 0) : capacity(capacity) {}
+
+	int_type overflow(int_type ch) override { return (xsputn(nullptr, 1) == 1) ? ch : traits_type::eof(); }
+	std::streamsize xsputn(const char*, std::streamsize cnt) override {
+		if(static_cast<size_t>(cnt) > capacity) { return 0; }
+		capacity -= cnt;
+		return cnt;
+	}
+};
 
 // ###########
 // # Serializer
@@ -103,3 +125,417 @@ BOOST_AUTO_TEST_CASE ( parseSerializeEquality ) {
 	parseSerializeEqualityFile("testFiles/sensorData.csv");
 	parseSerializeEqualityFile("testFiles/customActivity.csv");
 }
+
+BOOST_AUTO_TEST_CASE ( parameterFormatting ) {
+	RawSensorEvent rawEvt;
+	{ // floats are written in their shortest round-trip representation
+		rawEvt.eventId = EVENTID_ACCELEROMETER;
+		rawEvt.parameterString = "1.4317327;5.0996494;-7.9870567";
+		SensorEvent::parse(rawEvt).serializeInto(rawEvt);
+		BOOST_CHECK_EQUAL(rawEvt.parameterString, "1.4317327;5.0996494;-7.9870567");
+	}
+	{ // leading empty fields are kept
+		rawEvt.eventId = EVENTID_PEDESTRIAN_ACTIVITY;
+		rawEvt.parameterString = ";1";
+		SensorEvent::parse(rawEvt).serializeInto(rawEvt);
+		BOOST_CHECK_EQUAL(rawEvt.parameterString, ";1");
+	}
+	{ // bytes are written as numbers, not characters
+		rawEvt.eventId = EVENTID_FUTURESHAPE_SENSFLOOR;
+		rawEvt.parameterString = "1337;5;5;127;127;127;127;255;127;200;100";
+		SensorEvent::parse(rawEvt).serializeInto(rawEvt);
+		BOOST_CHECK_EQUAL(rawEvt.parameterString, "1337;5;5;127;127;127;127;255;127;200;100");
+	}
+	{ // raw BLE data is written as uppercase hex
+		rawEvt.eventId = EVENTID_IBEACON;
+		rawEvt.parameterString = "DEADBEEF1337;-94;-2147483648;0303aafe1516";
+		SensorEvent::parse(rawEvt).serializeInto(rawEvt);
+		BOOST_CHECK_EQUAL(rawEvt.parameterString, "DEADBEEF1337;-94;-2147483648;0303AAFE1516");
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( serializerBuffering ) {
+	std::ostringstream output;
+	{
+		Serializer serializer(output, FileVersion::V0);
+		RawSensorEvent rawEvt { 21000000, EVENTID_GROUND_TRUTH, "42" };
+		for(size_t i = 0; i < 200000; ++i) { serializer.write(rawEvt); }
+		serializer.flush();
+		BOOST_CHECK_EQUAL(output.str().size(), 200000 * std::string("21;99;42\n").size());
+		serializer.write(rawEvt);
+	}
+	BOOST_CHECK_EQUAL(output.str().size(), 200001 * std::string("21;99;42\n").size());
+	BOOST_CHECK_EQUAL(output.str().substr(0, 9), "21;99;42\n");
+}
+
+BOOST_AUTO_TEST_CASE ( serializerWriteFailure ) {
+	FailingStreamBuffer failingBuffer;
+	RawSensorEvent rawEvt { 21000000, EVENTID_GROUND_TRUTH, "42" };
+	{ // explicit flush reports the error
+		std::ostream output(&failingBuffer);
+		Serializer serializer(output);
+		serializer.write(rawEvt);
+		BOOST_CHECK_THROW(serializer.flush(), std::runtime_error);
+	}
+	{ // the destructor swallows it, instead of terminating
+		std::ostream output(&failingBuffer);
+		BOOST_CHECK_NO_THROW({
+			Serializer serializer(output);
+			for(size_t i = 0; i < 1000; ++i) { serializer.write(rawEvt); }
+		});
+	}
+}
+
+
+// ###########
+// # BinaryFormat
+// ######################
+
+std::string serializeParameters(const SensorEvent& sensorEvent) {
+	RawSensorEvent rawEvt;
+	sensorEvent.serializeInto(rawEvt);
+	return rawEvt.parameterString;
+}
+
+void binaryRoundtripFile(const std::string& filePath) {
+	std::ifstream inputFile(filePath);
+	BOOST_REQUIRE(inputFile.is_open());
+	auto rawEvents = AggregatingParser(inputFile).parseRaw();
+
+	std::stringstream binary;
+	{ // text -> binary
+		BinaryWriter writer(binary);
+		for(const auto& rawEvt : rawEvents) { writer.write(rawEvt); }
+	}
+	{ // binary -> typed events
+		BinaryReader reader(binary);
+		SensorEvent sensorEvent;
+		for(const auto& rawEvt : rawEvents) {
+			BOOST_REQUIRE(reader.nextEvent(sensorEvent));
+			BOOST_CHECK_EQUAL(sensorEvent.timestamp, rawEvt.timestamp);
+			BOOST_CHECK_EQUAL(static_cast<EventId>(sensorEvent.eventType), rawEvt.eventId);
+			BOOST_CHECK_EQUAL(serializeParameters(sensorEvent), serializeParameters(SensorEvent::parse(rawEvt)));
+		}
+		BOOST_CHECK(!reader.nextEvent(sensorEvent));
+	}
+	{ // all known events are stored in their packed binary layout, not as text
+		binary.clear();
+		binary.seekg(0);
+		BinaryReader reader(binary);
+		BinaryRecordView record;
+		for(const auto& rawEvt : rawEvents) {
+			BOOST_REQUIRE(reader.nextRecord(record));
+			SensorEvent sensorEvent = SensorEvent::parse(rawEvt);
+			BOOST_CHECK(record.payload != rawEvt.parameterString);
+			if(sensorEvent.eventType == EventType::Wifi) {
+				BOOST_CHECK_EQUAL(record.payload.size(), 4 + std::get<WifiEvent>(sensorEvent.data).advertisements.size() * (6 + 4 + 4));
+			} else if(sensorEvent.eventType == EventType::BLE) {
+				BOOST_CHECK_EQUAL(record.payload.size(), 6 + 4 + 4 + 4 + std::get<BLEEvent>(sensorEvent.data).rawData.size());
+			}
+		}
+	}
+	{ // binary -> text -> typed events
+		binary.clear();
+		binary.seekg(0);
+		std::stringstream text;
+		BinaryReader reader(binary);
+		{
+			Serializer serializer(text);
+			BOOST_CHECK_EQUAL(convertToText(reader, serializer), rawEvents.size());
+		}
+		auto convertedEvents = AggregatingParser(text).parseRaw();
+		BOOST_REQUIRE_EQUAL(convertedEvents.size(), rawEvents.size());
+		for(size_t i = 0; i < rawEvents.size(); ++i) {
+			BOOST_CHECK_EQUAL(convertedEvents[i].timestamp, rawEvents[i].timestamp);
+			BOOST_CHECK_EQUAL(convertedEvents[i].eventId, rawEvents[i].eventId);
+			BOOST_CHECK_EQUAL(serializeParameters(SensorEvent::parse(convertedEvents[i])), serializeParameters(SensorEvent::parse(rawEvents[i])));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( binaryFormatRoundtrip ) {
+	binaryRoundtripFile("testFiles/radioData.csv");
+	binaryRoundtripFile("testFiles/sensorData.csv");
+	binaryRoundtripFile("testFiles/customActivity.csv");
+}
+
+BOOST_AUTO_TEST_CASE ( binaryWriterWriteFailure ) {
+	FailingStreamBuffer failingBuffer;
+	RawSensorEvent rawEvt { 21000000, EVENTID_GROUND_TRUTH, "42" };
+	{
+		std::ostream output(&failingBuffer);
+		BinaryWriter writer(output);
+		writer.write(rawEvt);
+		BOOST_CHECK_THROW(writer.flush(), std::runtime_error);
+	}
+	{
+		std::ostream output(&failingBuffer);
+		BOOST_CHECK_NO_THROW({
+			BinaryWriter writer(output);
+			for(size_t i = 0; i < 1000; ++i) { writer.write(rawEvt); }
+		});
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( binaryFormatReader ) {
+	std::stringstream binary;
+	{
+		BinaryWriter writer(binary);
+		writer.write(RawSensorEvent { 1, EVENTID_ACCELEROMETER, "1.5;2.5;-3.5" });
+		writer.write(RawSensorEvent { 2, EVENTID_WIFI, "DEADBEEF1337;2412;-42" });
+		writer.write(RawSensorEvent { 3, EVENTID_HEADING_CHANGE, "0.125" });
+	}
+	const std::string content = binary.str();
+	BOOST_CHECK_EQUAL(content.size(), 8 + (16 + 12) + (16 + 18) + (16 + 8));
+
+	{ // filtered records are skipped
+		std::istringstream input(content);
+		BinaryReader reader(input);
+		reader.setEventFilter(EventTypeFilter { EventType::Wifi, EventType::HeadingChange });
+		RawSensorEvent rawEvt;
+		BOOST_REQUIRE(reader.nextLine(rawEvt));
+		BOOST_CHECK_EQUAL(rawEvt.timestamp, 2);
+		BOOST_CHECK_EQUAL(rawEvt.parameterString, "DEADBEEF1337;2412;-42");
+		BOOST_REQUIRE(reader.nextLine(rawEvt));
+		BOOST_CHECK_EQUAL(rawEvt.timestamp, 3);
+		BOOST_CHECK_EQUAL(rawEvt.parameterString, "0.125");
+		BOOST_CHECK(!reader.nextLine(rawEvt));
+	}
+	{ // packed payloads are decoded field by field, a textual payload is rejected
+		auto appendRecord = [](std::string& binary, EventId eventId, const std::string& payload) {
+			Timestamp timestamp = 4;
+			uint32_t payloadSize = payload.size();
+			binary.append(reinterpret_cast<const char*>(&timestamp), sizeof(timestamp));
+			binary.append(reinterpret_cast<const char*>(&eventId), sizeof(eventId));
+			binary.append(reinterpret_cast<const char*>(&payloadSize), sizeof(payloadSize));
+			binary.append(payload);
+		};
+		std::string wifiPayload;
+		uint32_t advertisementCnt = 1;
+		Rssi rssi = -42;
+		WifiFrequency channelFreq = 2412;
+		wifiPayload.append(reinterpret_cast<const char*>(&advertisementCnt), sizeof(advertisementCnt));
+		wifiPayload.append("\xDE\xAD\xBE\xEF\x13\x37");
+		wifiPayload.append(reinterpret_cast<const char*>(&rssi), sizeof(rssi));
+		wifiPayload.append(reinterpret_cast<const char*>(&channelFreq), sizeof(channelFreq));
+
+		std::string handcrafted = content.substr(0, 8);
+		appendRecord(handcrafted, EVENTID_WIFI, wifiPayload);
+		appendRecord(handcrafted, EVENTID_WIFI, wifiPayload.substr(0, wifiPayload.size() - 1));
+		appendRecord(handcrafted, EVENTID_WIFI, "DEADBEEF1337;2412;-42");
+		std::istringstream input(handcrafted);
+		BinaryReader reader(input);
+		SensorEvent sensorEvent;
+		BOOST_REQUIRE(reader.nextEvent(sensorEvent));
+		const WifiEvent& wifiEvent = std::get<WifiEvent>(sensorEvent.data);
+		BOOST_REQUIRE_EQUAL(wifiEvent.advertisements.size(), 1);
+		BOOST_CHECK_EQUAL(wifiEvent.advertisements[0].mac.toString(), "DEADBEEF1337");
+		BOOST_CHECK_EQUAL(wifiEvent.advertisements[0].rssi, -42);
+		BOOST_CHECK_EQUAL(wifiEvent.advertisements[0].channelFreq, 2412);
+		BOOST_CHECK_THROW(reader.nextEvent(sensorEvent), std::runtime_error);
+		BOOST_CHECK_THROW(reader.nextEvent(sensorEvent), std::runtime_error);
+	}
+	{ // invalid file header
+		std::istringstream input("SRTX\x01\x00\x02\x01");
+		BOOST_CHECK_THROW(BinaryReader reader(input), std::runtime_error);
+	}
+	{ // truncated record
+		std::istringstream input(content.substr(0, content.size() - 3));
+		BinaryReader reader(input);
+		RawSensorEvent rawEvt;
+		BOOST_CHECK(reader.nextLine(rawEvt));
+		BOOST_CHECK(reader.nextLine(rawEvt));
+		BOOST_CHECK_THROW(reader.nextLine(rawEvt), std::runtime_error);
+	}
+}
+
+
+// ###########
+// # TimeSeriesCodec
+// ######################
+
+template<typename TEvent>
+void checkChannelEquality(const NumericChannel<TEvent>& expected, const NumericChannel<TEvent>& actual) {
+	BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+	BOOST_CHECK(expected.timestamps == actual.timestamps);
+	// bitwise comparison, the codec has to be lossless also for NaN and -0
+	BOOST_CHECK(std::memcmp(expected.values.data(), actual.values.data(), expected.values.size() * sizeof(typename TEvent::NumericValue)) == 0);
+}
+
+void timeSeriesRoundtripFile(const std::string& filePath) {
+	MappedVisitingParser parser(filePath);
+	ColumnarRecording recording = ColumnarRecording::parse(parser);
+
+	std::stringstream compressed;
+	{ // whole channels, with small blocks to test block boundaries
+		TimeSeriesWriter writer(compressed, 100);
+		writer.write(recording);
+	}
+	ColumnarRecording decoded = TimeSeriesReader(compressed).readAll();
+	recording.forEachNumericChannel([&](EventType, const auto& channel) {
+		using Channel = std::remove_cvref_t<decltype(channel)>;
+		checkChannelEquality(channel, decoded.channel<typename Channel::Event>());
+	});
+
+	std::stringstream streamed;
+	{ // event by event
+		TimeSeriesWriter writer(streamed, 64);
+		std::ifstream inputFile(filePath);
+		VisitingParser visitingParser(inputFile);
+		RawSensorEvent rawEvent;
+		while(visitingParser.nextLine(rawEvent)) { writer.write(SensorEvent::parse(rawEvent)); }
+	}
+	decoded = TimeSeriesReader(streamed).readAll();
+	recording.forEachNumericChannel([&](EventType, const auto& channel) {
+		using Channel = std::remove_cvref_t<decltype(channel)>;
+		checkChannelEquality(channel, decoded.channel<typename Channel::Event>());
+	});
+}
+
+BOOST_AUTO_TEST_CASE ( timeSeriesCodecRoundtrip ) {
+	timeSeriesRoundtripFile("testFiles/sensorData.csv");
+	timeSeriesRoundtripFile("testFiles/radioData.csv");
+}
+
+BOOST_AUTO_TEST_CASE ( timeSeriesWriterWriteFailure ) {
+	// only the file header fits
+	FailingStreamBuffer failingBuffer(TIME_SERIES_FILE_HEADER_SIZE);
+	SensorEvent evt { 1000, EventType::Accelerometer, AccelerometerEvent() };
+	{
+		std::ostream output(&failingBuffer);
+		TimeSeriesWriter writer(output);
+		writer.write(evt);
+		BOOST_CHECK_THROW(writer.flush(), std::runtime_error);
+	}
+	{
+		failingBuffer.capacity = TIME_SERIES_FILE_HEADER_SIZE;
+		std::ostream output(&failingBuffer);
+		BOOST_CHECK_NO_THROW({
+			TimeSeriesWriter writer(output);
+			for(size_t i = 0; i < 1000; ++i) { writer.write(evt); }
+		});
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( timeSeriesCodecEdgeCases ) {
+	ColumnarRecording recording;
+	auto& accelerometer = recording.channel<AccelerometerEvent>();
+	const float specialValues[] = { 0.0f, -0.0f, std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+			-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::max(), 1.0f, 1.0f, 1.0f };
+	const Timestamp timestamps[] = { 0, 5000000, 10000000, 15000000, 14000000, UINT64_MAX, 3, 3, 1000000000000, 1000000005000 };
+	for(size_t i = 0; i < 10; ++i) {
+		AccelerometerEvent evt;
+		evt.x = specialValues[i];
+		evt.y = specialValues[9 - i];
+		evt.z = static_cast<float>(i) * 0.1f;
+		accelerometer.push(timestamps[i], evt);
+	}
+	auto& groundTruth = recording.channel<GroundTruthEvent>();
+	groundTruth.push(42, GroundTruthEvent { {}, 0 });
+	groundTruth.push(43, GroundTruthEvent { {}, SIZE_MAX });
+	groundTruth.push(44, GroundTruthEvent { {}, 1 });
+	recording.channel<HeadingChangeEvent>().push(7, HeadingChangeEvent { {}, -1.25 });
+
+	std::stringstream compressed;
+	{
+		TimeSeriesWriter writer(compressed, 4);
+		writer.write(recording);
+	}
+	const std::string content = compressed.str();
+	ColumnarRecording decoded = TimeSeriesReader(compressed).readAll();
+	checkChannelEquality(accelerometer, decoded.channel<AccelerometerEvent>());
+	checkChannelEquality(groundTruth, decoded.channel<GroundTruthEvent>());
+	checkChannelEquality(recording.channel<HeadingChangeEvent>(), decoded.channel<HeadingChangeEvent>());
+	BOOST_CHECK_EQUAL(decoded.size(), 14);
+
+	{ // constant rate and constant values compress to a bit per value, and a byte per timestamp
+		ColumnarRecording constant;
+		for(size_t i = 0; i < 1000; ++i) { constant.channel<PressureEvent>().push(i * 10000000, PressureEvent { {}, 1013.25f }); }
+		std::stringstream output;
+		TimeSeriesWriter(output, 1000).write(constant);
+		BOOST_CHECK_EQUAL(output.str().size(), 8 + 16 + (1 + 4 + 998) + (32 + 999 + 7) / 8);
+	}
+	{ // truncated block
+		std::istringstream input(content.substr(0, content.size() - 1));
+		BOOST_CHECK_THROW(TimeSeriesReader(input).readAll(), std::runtime_error);
+	}
+	{ // invalid file header
+		std::istringstream input("SRBF\x01\x00\x02\x01");
+		BOOST_CHECK_THROW(TimeSeriesReader reader(input), std::runtime_error);
+	}
+}
+
+
+// ###########
+// # ExternalSort
+// ######################
+
+void externalSortFile(const std::string& filePath, const ExternalSortOptions& options) {
+	std::ifstream inputFile(filePath);
+	BOOST_REQUIRE(inputFile.is_open());
+	auto expectedEvents = AggregatingParser(inputFile).parseRaw();
+	// move every third event back in time, to simulate late radio events
+	for(size_t i = 0; i < expectedEvents.size(); i += 3) {
+		expectedEvents[i].timestamp = (expectedEvents[i].timestamp > 50000000) ? (expectedEvents[i].timestamp - 50000000) : 0;
+	}
+	std::stringstream unsorted;
+	{
+		Serializer serializer(unsorted);
+		for(const auto& rawEvt : expectedEvents) { serializer.write(rawEvt); }
+	}
+	std::stable_sort(expectedEvents.begin(), expectedEvents.end(), [](const auto& a, const auto& b) { return a.timestamp < b.timestamp; });
+
+	std::stringstream sorted;
+	{
+		VisitingParser parser(unsorted);
+		Serializer serializer(sorted);
+		BOOST_CHECK_EQUAL(sortRecording(parser, serializer, options), expectedEvents.size());
+	}
+	auto sortedEvents = AggregatingParser(sorted).parseRaw();
+	BOOST_REQUIRE_EQUAL(sortedEvents.size(), expectedEvents.size());
+	for(size_t i = 0; i < sortedEvents.size(); ++i) {
+		BOOST_CHECK_EQUAL(sortedEvents[i].timestamp, expectedEvents[i].timestamp);
+		BOOST_CHECK_EQUAL(sortedEvents[i].eventId, expectedEvents[i].eventId);
+		BOOST_CHECK_EQUAL(sortedEvents[i].parameterString, expectedEvents[i].parameterString);
+	}
+}
+
+BOOST_AUTO_TEST_CASE ( externalSort ) {
+	const std::filesystem::path tempDirectory = std::filesystem::temp_directory_path() / "sensorreadout_sort_test";
+	std::filesystem::remove_all(tempDirectory);
+	std::filesystem::create_directories(tempDirectory);
+	// in memory
+	externalSortFile("testFiles/sensorData.csv", ExternalSortOptions { 256 * 1024 * 1024, 2, tempDirectory });
+	// many small runs
+	externalSortFile("testFiles/sensorData.csv", ExternalSortOptions { 64 * 1024, 3, tempDirectory });
+	externalSortFile("testFiles/radioData.csv", ExternalSortOptions { 4 * 1024, 1, tempDirectory });
+	// multiple merge passes over intermediate runs
+	externalSortFile("testFiles/sensorData.csv", ExternalSortOptions { 16 * 1024, 3, tempDirectory, 2 });
+	externalSortFile("testFiles/sensorData.csv", ExternalSortOptions { 32 * 1024, 1, tempDirectory, 5 });
+	// temporary run files are removed
+	BOOST_CHECK(std::filesystem::is_empty(tempDirectory));
+	{ // errors while writing runs are propagated
+		std::ifstream inputFile("testFiles/sensorData.csv");
+		VisitingParser parser(inputFile);
+		std::stringstream sorted;
+		Serializer serializer(sorted);
+		BOOST_CHECK_THROW(sortRecording(parser, serializer, ExternalSortOptions { 64 * 1024, 2, tempDirectory / "missing" }), std::runtime_error);
+	}
+	{ // errors while writing runs are propagated: simulate a full disk by limiting the file size
+		std::ifstream inputFile("testFiles/sensorData.csv");
+		VisitingParser parser(inputFile);
+		std::stringstream sorted;
+		Serializer serializer(sorted);
+		struct rlimit prevLimit;
+		BOOST_REQUIRE(getrlimit(RLIMIT_FSIZE, &prevLimit) == 0);
+		struct rlimit limit = prevLimit;
+		limit.rlim_cur = 0; // runs stay empty, instead of truncated lines that would fail the merge
+		auto prevHandler = std::signal(SIGXFSZ, SIG_IGN); // fail with EFBIG instead of terminating
+		BOOST_REQUIRE(setrlimit(RLIMIT_FSIZE, &limit) == 0);
+		BOOST_CHECK_THROW(sortRecording(parser, serializer, ExternalSortOptions { 64 * 1024, 2, tempDirectory }), std::runtime_error);
+		setrlimit(RLIMIT_FSIZE, &prevLimit);
+		std::signal(SIGXFSZ, prevHandler);
+	}
+	BOOST_CHECK(std::filesystem::is_empty(tempDirectory));
+	std::filesystem::remove_all(tempDirectory);
+}